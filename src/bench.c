@@ -0,0 +1,378 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+//OS Specific Libraries
+#ifdef _WIN32
+// Windows-specific code
+#include <windows.h>
+#elif __linux__
+// Linux-specific code
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#elif __APPLE__
+// MacOS-specific code
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "lib/headers/io.h"
+#include "lib/headers/output.h"
+#include "lib/headers/trace.h"
+//
+// Benchmark harness for the cache simulator. Runs repeated timed trials over a matrix of configs and
+// traces and reports every phase separately
+//
+
+//Defining the phases timed for every trial
+#define BENCH_PARSE 0
+#define BENCH_SIMULATE 1
+#define BENCH_FLUSH 2
+#define BENCH_OUTPUT 3
+#define BENCH_PHASES 4
+
+//Defining the limits of the config matrix
+#define BENCH_MAX_VALUES 16
+
+//Defining the hardware counters read with perf_event_open
+#define BENCH_COUNTERS 4
+
+static const char* PHASE_NAMES[BENCH_PHASES] = {"parse", "simulate", "flush", "output"};
+
+//Data structure to house the benchmark settings
+struct bench_config {
+    int trials;
+    bool perf;
+
+    int capacities[BENCH_MAX_VALUES];
+    int total_capacities;
+    int block_sizes[BENCH_MAX_VALUES];
+    int total_block_sizes;
+    int associativities[BENCH_MAX_VALUES];
+    int total_associativities;
+};
+
+//Data structure to house the hardware counters of the simulate phase
+struct perf_counters {
+    int fds[BENCH_COUNTERS];
+    bool available;
+    double totals[BENCH_COUNTERS];
+};
+
+//Function to read a monotonic clock in milliseconds
+static double now_msec() {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart * 1000.0 / (double) frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+#endif
+}
+
+//Function to open the hardware counters, leaves them unavailable if the kernel does not allow it
+static void open_perf_counters(struct perf_counters* counters) {
+    memset(counters, 0, sizeof(struct perf_counters));
+    for(int i = 0; i < BENCH_COUNTERS; i++) {
+        counters->fds[i] = -1;
+    }
+#ifdef __linux__
+    unsigned long long configs[BENCH_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                  PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for(int i = 0; i < BENCH_COUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(struct perf_event_attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(struct perf_event_attr);
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        counters->fds[i] = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if(counters->fds[i] < 0) {
+            for(int j = 0; j < i; j++) {
+                close(counters->fds[j]);
+                counters->fds[j] = -1;
+            }
+            return;
+        }
+    }
+    counters->available = 1;
+#endif
+}
+
+//Function to reset and start the hardware counters
+static void start_perf_counters(struct perf_counters* counters) {
+#ifdef __linux__
+    for(int i = 0; counters->available && i < BENCH_COUNTERS; i++) {
+        ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+//Function to stop the hardware counters and add their values to the totals
+static void stop_perf_counters(struct perf_counters* counters) {
+#ifdef __linux__
+    for(int i = 0; counters->available && i < BENCH_COUNTERS; i++) {
+        unsigned long long value = 0;
+        ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if(read(counters->fds[i], &value, sizeof(value)) == sizeof(value)) {
+            counters->totals[i] += (double) value;
+        }
+    }
+#endif
+}
+
+//Function to close the hardware counters
+static void close_perf_counters(struct perf_counters* counters) {
+#ifdef __linux__
+    for(int i = 0; counters->available && i < BENCH_COUNTERS; i++) {
+        close(counters->fds[i]);
+    }
+#endif
+    counters->available = 0;
+}
+
+//Function to order timings from the fastest up
+static int compare_times(const void* a, const void* b) {
+    double left = *(const double*) a;
+    double right = *(const double*) b;
+    return (left > right) - (left < right);
+}
+
+//Function to get a percentile of a sorted timing array using the nearest rank method
+static double percentile(double* sorted, int count, double fraction) {
+    int rank = (int) ceil(fraction * count);
+    if(rank < 1) {
+        rank = 1;
+    }
+    return sorted[rank - 1];
+}
+
+//Function to parse a comma separated list of power of two values between a minimum and a maximum, returns
+//non-zero if it is malformed
+static int parse_value_list(char* list, int* values, int* count, int min_value, int max_value) {
+    *count = 0;
+    char* cursor = list;
+
+    while(*cursor != '\0') {
+        char* end;
+        long value = strtol(cursor, &end, 10);
+        if(end == cursor || value < min_value || value > max_value || (value & (value - 1)) != 0
+                || *count == BENCH_MAX_VALUES) {
+            return 1;
+        }
+        values[(*count)++] = (int) value;
+        if(*end == ',') {
+            end++;
+        } else if(*end != '\0') {
+            return 1;
+        }
+        cursor = end;
+    }
+
+    return *count == 0;
+}
+
+//Function to run every trial of one trace and config and print its row
+static int bench_config_row(char* input_file, struct bench_config* config, int capacity, int block_size,
+                            int associativity) {
+    double* times[BENCH_PHASES];
+    for(int p = 0; p < BENCH_PHASES; p++) {
+        times[p] = calloc(config->trials, sizeof(double));
+    }
+    struct perf_counters counters;
+    memset(&counters, 0, sizeof(struct perf_counters));
+    if(config->perf) {
+        open_perf_counters(&counters);
+    }
+
+    long accesses = 0;
+    int status = 0;
+    for(int trial = 0; trial < config->trials && status == 0; trial++) {
+        //Parse
+        struct trace trace;
+        double t0 = now_msec();
+        status = load_trace(input_file, &trace);
+        double t1 = now_msec();
+        if(status != 0) {
+            break;
+        }
+        times[BENCH_PARSE][trial] = t1 - t0;
+        accesses = trace.length;
+
+        //Set up a fresh cache and main memory, which is not part of any phase
+        struct cache cache_mem = zero_cache();
+        cache_mem.size = capacity * 1024;
+        cache_mem.line_size = block_size;
+        cache_mem.associativity = associativity;
+        cache_mem.total_lines = cache_mem.size / cache_mem.line_size;
+        cache_mem.words_per_line = cache_mem.line_size / WORD_SIZE;
+        cache_mem = init_cache_mem(cache_mem);
+        struct main_mem_block* main_mem = init_main_mem();
+        struct cache_stats stats = zero_stats();
+
+        //Simulate
+        start_perf_counters(&counters);
+        t0 = now_msec();
+        simulate_trace_records(&cache_mem, &stats, main_mem, trace.records, trace.length);
+        t1 = now_msec();
+        stop_perf_counters(&counters);
+        times[BENCH_SIMULATE][trial] = t1 - t0;
+
+        //Flush
+        t0 = now_msec();
+        write_cache_to_memory(&cache_mem, main_mem);
+        t1 = now_msec();
+        times[BENCH_FLUSH][trial] = t1 - t0;
+
+        //Output, formatted the same way the simulator formats its results
+        size_t length;
+        t0 = now_msec();
+        char* results = format_results(cache_mem, stats, main_mem, zero_output_config(), &length);
+        t1 = now_msec();
+        times[BENCH_OUTPUT][trial] = t1 - t0;
+
+        free(results);
+        free_io(cache_mem, main_mem);
+        free_trace(&trace);
+    }
+
+    if(status == 0) {
+        printf("%-24s %-4d %-4d %-4d", input_file, capacity, block_size, associativity);
+        double median_simulate = 0.0;
+        for(int p = 0; p < BENCH_PHASES; p++) {
+            qsort(times[p], config->trials, sizeof(double), compare_times);
+            double median = percentile(times[p], config->trials, 0.5);
+            printf(" %10.3f %10.3f", median, percentile(times[p], config->trials, 0.99));
+            if(p == BENCH_SIMULATE) {
+                median_simulate = median;
+            }
+        }
+        printf(" %14.0f\n", median_simulate > 0.0 ? (double) accesses / (median_simulate / 1000.0) : 0.0);
+
+        if(config->perf && counters.available) {
+            double total_accesses = (double) accesses * config->trials;
+            printf("%-38s cycles/access %.2f instructions/access %.2f IPC %.2f cache-misses/access %.4f "
+                   "branch-misses/access %.4f\n", "", counters.totals[0] / total_accesses,
+                   counters.totals[1] / total_accesses,
+                   counters.totals[0] > 0.0 ? counters.totals[1] / counters.totals[0] : 0.0,
+                   counters.totals[2] / total_accesses, counters.totals[3] / total_accesses);
+        } else if(config->perf) {
+            printf("%-38s hardware counters unavailable (perf_event_open failed)\n", "");
+        }
+    }
+
+    close_perf_counters(&counters);
+    for(int p = 0; p < BENCH_PHASES; p++) {
+        free(times[p]);
+    }
+    return status;
+}
+
+//Benchmark entry point
+int main(int argc, char *argv[]) {
+    struct bench_config config;
+    memset(&config, 0, sizeof(struct bench_config));
+    config.trials = 5;
+    config.capacities[config.total_capacities++] = 8;
+    config.block_sizes[config.total_block_sizes++] = 16;
+    config.associativities[config.total_associativities++] = 4;
+
+    char* traces[argc];
+    int total_traces = 0;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-h") == 0) {
+            printf("Usage information:\ncache_sim_bench [options] <trace> [<trace> ...]\n\n");
+            printf("-n <trials> number of timed trials per trace and config (default: 5)\n"
+                   "-c <list> comma separated capacities in KB (default: 8)\n"
+                   "-b <list> comma separated block sizes in bytes (default: 16)\n"
+                   "-a <list> comma separated associativities (default: 4)\n"
+                   "--perf read hardware counters for the simulate phase with perf_event_open\n\n");
+            printf("Example: ./cache_sim_bench -n 10 -c 4,8,64 -b 16,64 -a 1,4 mem.trace\n");
+            return 0;
+        } else if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            i++;
+            config.trials = (int) strtol(argv[i], NULL, 10);
+            if(config.trials <= 0) {
+                printf("trials must be a positive integer\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            i++;
+            if(parse_value_list(argv[i], config.capacities, &config.total_capacities, 4, 64)) {
+                printf("capacities must be a list of 4, 8, 16, 32, or 64\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            i++;
+            if(parse_value_list(argv[i], config.block_sizes, &config.total_block_sizes, 4, 512)) {
+                printf("block sizes must be a list of 4, 8, 16, 32, 64, 128, 256, or 512\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            i++;
+            if(parse_value_list(argv[i], config.associativities, &config.total_associativities, 1, 16)) {
+                printf("associativities must be a list of 1, 2, 4, 8, or 16\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--perf") == 0) {
+            config.perf = 1;
+        } else {
+            traces[total_traces++] = argv[i];
+        }
+    }
+
+    if(total_traces == 0) {
+        printf("Improper command line usage. Use the -h flag to see usage instructions.\n");
+        return 1;
+    }
+
+    //Every config needs at least one set, so no associativity may exceed the lines of a capacity and block size
+    for(int c = 0; c < config.total_capacities; c++) {
+        for(int b = 0; b < config.total_block_sizes; b++) {
+            int total_lines = config.capacities[c] * 1024 / config.block_sizes[b];
+            for(int a = 0; a < config.total_associativities; a++) {
+                if(config.associativities[a] > total_lines) {
+                    printf("associativity %d is more than the %d blocks of a %d KB cache with %d byte blocks\n",
+                           config.associativities[a], total_lines, config.capacities[c], config.block_sizes[b]);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    printf("%-24s %-4s %-4s %-4s", "Trace", "C", "B", "A");
+    for(int p = 0; p < BENCH_PHASES; p++) {
+        char median[32], tail[32];
+        snprintf(median, sizeof(median), "%s_med", PHASE_NAMES[p]);
+        snprintf(tail, sizeof(tail), "%s_p99", PHASE_NAMES[p]);
+        printf(" %10s %10s", median, tail);
+    }
+    printf(" %14s\n", "accesses/s");
+
+    for(int t = 0; t < total_traces; t++) {
+        for(int c = 0; c < config.total_capacities; c++) {
+            for(int b = 0; b < config.total_block_sizes; b++) {
+                for(int a = 0; a < config.total_associativities; a++) {
+                    int status = bench_config_row(traces[t], &config, config.capacities[c],
+                                                  config.block_sizes[b], config.associativities[a]);
+                    if(status != 0) {
+                        return status;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
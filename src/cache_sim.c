@@ -21,6 +21,27 @@
 #endif
 
 #include "lib/headers/io.h"
+#include "lib/headers/batch.h"
+#include "lib/headers/checkpoint.h"
+#include "lib/headers/coherence.h"
+#include "lib/headers/dram.h"
+#include "lib/headers/mshr.h"
+#include "lib/headers/gen.h"
+#include "lib/headers/interval.h"
+#include "lib/headers/mem_image.h"
+#include "lib/headers/multiprog.h"
+#include "lib/headers/occupancy.h"
+#include "lib/headers/output.h"
+#include "lib/headers/partition.h"
+#include "lib/headers/sampling.h"
+#include "lib/headers/server.h"
+#include "lib/headers/shards.h"
+#include "lib/headers/tlb.h"
+#include "lib/headers/trace.h"
+#ifdef CACHE_SIM_INSTRUMENT
+#include "lib/headers/hot.h"
+#include "lib/headers/instrument.h"
+#endif
 //
 // Created by Phillip Driscoll on 9/18/24.
 //
@@ -64,189 +85,569 @@ int gettimeofday(struct timeval *tv, struct timezone *tz) {
 
     return 0;
 }
+#endif // _WIN32
+
+
+//Function to calculate time difference for benchmarking
+float time_difference_msec(struct timeval t0, struct timeval t1) {
+    return (float) (t1.tv_sec - t0.tv_sec) * 1000.0f + (float) (t1.tv_usec - t0.tv_usec) / 1000.0f;
+}
+
+//Data structure to house the optional analysis modes attached to a trace run
+struct trace_options {
+    struct sampler* sampler;
+    struct shards* shards;
+    struct interval_stream* intervals;
+
+    //Snapshot the simulator every checkpoint_every records, 0 to never checkpoint
+    long checkpoint_every;
+    char* checkpoint_file;
+};
+
+//Data structure to house the workloads sharing one cache and how the cache is divided between them
+struct workload_options {
+    char* traces[MAX_WORKLOADS];
+    int total_workloads;
+    //Ways given to every workload, total_ways is 0 without a partition
+    int ways[MAX_WORKLOADS];
+    int total_ways;
+    bool qos;
+    bool solo;
+};
+
+//Function to open the trace input, either the input file or the generator if one is configured
+int open_trace_input(char* input_file, struct generator* gen, struct trace_reader* reader) {
+    if(gen) {
+        open_generator_reader(reader, gen);
+        printf("Generating %s trace of %ld accesses with seed %llu\n", gen_pattern_name(gen->config.pattern),
+               gen->config.length, gen->config.seed);
+        return 0;
+    }
+
+    //Verify validity of file
+    if(access(input_file, F_OK) != 0) {
+        // File doesn't exist
+        printf("Error: Input file could not be found!\n");
+        return 2;
+    }
+
+    // File exists
+    printf("Input file found!\n");
+    return open_trace_reader(reader, input_file);
+}
 
-size_t getline(char **lineptr, size_t *n, FILE *stream) {
-    char *bufptr = NULL;
-    char *p = bufptr;
-    size_t size;
-    int c;
+//Function to read input file and process traces
+int process_trace(struct trace_reader* reader, struct cache* cache_mem, struct cache_stats* stats,
+                    struct main_mem_block* main_mem, struct trace_options* options) {
+    bool failure = 0;
+    int result;
+    struct trace_record record;
+
+    printf("Running cache simulation...\n");
+
+    struct timeval t0;
+    struct timeval t1;
+    float elapsed;
+
+    //Start benchmark
+    gettimeofday(&t0, 0);
+
+    //Get each record from the trace, the reader reports what is wrong with a malformed record
+    while((result = read_trace_record(reader, &record)) > 0) {
+        int read_write = record.op;
+        INT_TYPE addr = record.addr;
+
+        //The miss ratio curve is built from every access of the trace, sampled or not
+        if(options->shards) {
+            shards_access(options->shards, addr);
+        }
 
-    if (lineptr == NULL) {
-        return -1;
+        //Check whether the sampler wants this access measured, only used to warm the cache, or skipped
+        int sample_action = SAMPLE_MEASURE;
+        struct cache_stats* target_stats = stats;
+        //Only a sampler compares the statistics before and after an access
+        struct cache_stats before;
+        if(options->sampler) {
+            before = *stats;
+            sample_action = sampler_classify(options->sampler, read_write, addr);
+            if(sample_action == SAMPLE_WARM) {
+                target_stats = &options->sampler->warm_stats;
+            }
+        }
+
+        if(sample_action != SAMPLE_SKIP) {
+            //Read from or write to the cache, stopping at an address the translation stage cannot map
+            if(simulate_record(cache_mem, target_stats, main_mem, record) == 5) {
+                result = -1;
+                break;
+            }
+
+            if(options->sampler && sample_action == SAMPLE_MEASURE) {
+                sampler_record(options->sampler, before, *stats);
+            }
+            if(options->intervals && sample_action == SAMPLE_MEASURE) {
+                interval_tick(options->intervals, *stats);
+            }
+        }
+
+        //Snapshot the simulator, a failed checkpoint is reported but does not stop the simulation
+        if(options->checkpoint_every > 0 && reader->record_num % options->checkpoint_every == 0) {
+            write_checkpoint(options->checkpoint_file, cache_mem, *stats, main_mem, reader);
+        }
+    }
+    failure = result < 0;
+
+    //Verify that no failure occurred
+    if(!failure) {
+        //If not a failure, write the contents of the cache to the memory
+        write_cache_to_memory(cache_mem, main_mem);
+    }
+
+    //Stop benchmark
+    gettimeofday(&t1, 0);
+    //Calculate time difference
+    elapsed = time_difference_msec(t0, t1);
+
+    if(failure) {
+        return 4;
+    }
+
+    printf("Finished cache simulation!\nProcessed %ld instructions in %f ms\n\n", stats->total_actions, elapsed);
+
+    return 0;
+}
+
+//Function to print the reports of the optional analysis modes
+void print_reports(FILE* out, struct trace_options* options, struct cache cache_mem) {
+    if(options->sampler) {
+        fprintf(out, "\n");
+        print_sample_report(out, options->sampler);
+    }
+    if(options->shards) {
+        fprintf(out, "\n");
+        print_shards_report(out, options->shards, cache_mem.size);
+    }
+    if(cache_mem.occupancy) {
+        fprintf(out, "\n");
+        print_set_occupancy(out, cache_mem.occupancy, cache_mem);
+    }
+    if(cache_mem.translation) {
+        fprintf(out, "\n");
+        print_translation_report(out, cache_mem.translation);
+    }
+    if(cache_mem.icache) {
+        struct cache icache = cache_mem.icache->cache_mem;
+        struct cache_stats stats = cache_mem.icache->stats;
+        fprintf(out, "\nINSTRUCTION CACHE:\nSize: %d Block size: %d Associativity: %d\n", icache.size,
+                icache.line_size, icache.associativity);
+        fprintf(out, "Fetches: %ld Misses: %ld Miss rate: %.6f Evictions: %ld\n", stats.total_fetches,
+                stats.fetch_misses,
+                stats.total_fetches == 0 ? 0.0 : (double) stats.fetch_misses / (double) stats.total_fetches,
+                stats.total_evictions);
+    }
+    if(cache_mem.dram) {
+        fprintf(out, "\n");
+        print_dram_report(out, cache_mem.dram);
     }
-    if (stream == NULL) {
-        return -1;
+    if(cache_mem.mshrs) {
+        fprintf(out, "\n");
+        print_mshr_report(out, cache_mem.mshrs);
     }
-    if (n == NULL) {
-        return -1;
+#ifdef CACHE_SIM_INSTRUMENT
+    if(cache_mem.instr) {
+        fprintf(out, "\n");
+        print_instr_summary(out, cache_mem.instr);
     }
-    bufptr = *lineptr;
-    size = *n;
+    if(cache_mem.hot) {
+        fprintf(out, "\n");
+        print_hot_report(out, cache_mem.hot);
+    }
+#endif
+}
 
-    c = fgetc(stream);
-    if (c == EOF) {
-        return -1;
+//Function to read a positive integer flag value, returns non-zero if the value is not a positive integer
+int parse_positive_flag(char* value, long* result) {
+    if(value == NULL || value[0] == '\0') {
+        return 1;
     }
-    if (bufptr == NULL) {
-        bufptr = malloc(128);
-        if (bufptr == NULL) {
-            return -1;
+    for(int j = 0; j < (int)strlen(value); j++) {
+        if(!isdigit(value[j])) {
+            return 1;
         }
-        size = 128;
     }
-    p = bufptr;
-    while (c != EOF) {
-        if ((p - bufptr) > (size - 1)) {
-            size = size + 128;
-            bufptr = realloc(bufptr, size);
-            if (bufptr == NULL) {
-                return -1;
-            }
-            p = bufptr + (size - 128);
+    *result = strtol(value, NULL, 10);
+
+    return *result <= 0;
+}
+
+//Function to read a generator flag, returns non-zero after printing the reason if the flag or its value is invalid
+int parse_gen_flag(char* flag, char* value, struct gen_config* config) {
+    if(value == NULL) {
+        printf("%s needs a value\n", flag);
+        return 1;
+    }
+
+    if(strcmp(flag, "--gen-length") == 0) {
+        if(parse_positive_flag(value, &config->length)) {
+            printf("generator length must be a positive integer\n");
+            return 1;
+        }
+    } else if(strcmp(flag, "--gen-seed") == 0) {
+        char* end;
+        config->seed = strtoull(value, &end, 10);
+        if(end == value || *end != '\0') {
+            printf("generator seed must be a non-negative integer\n");
+            return 1;
+        }
+    } else if(strcmp(flag, "--gen-writes") == 0) {
+        long percent;
+        if(strcmp(value, "0") == 0) {
+            config->write_percent = 0;
+        } else if(parse_positive_flag(value, &percent) || percent > 100) {
+            printf("generator write percentage must be between 0 and 100\n");
+            return 1;
+        } else {
+            config->write_percent = (int) percent;
         }
-        *p++ = c;
-        if (c == '\n') {
-            break;
+    } else if(strcmp(flag, "--gen-base") == 0) {
+        char* end;
+        unsigned long long base = strtoull(value, &end, 16);
+        if(end == value || *end != '\0') {
+            printf("generator base must be a hex word address\n");
+            return 1;
         }
-        c = fgetc(stream);
+        config->base = (INT_TYPE) base;
+    } else if(strcmp(flag, "--gen-footprint") == 0) {
+        if(parse_positive_flag(value, &config->footprint)) {
+            printf("generator footprint must be a positive integer\n");
+            return 1;
+        }
+    } else if(strcmp(flag, "--gen-stride") == 0) {
+        if(parse_positive_flag(value, &config->stride)) {
+            printf("generator stride must be a positive integer\n");
+            return 1;
+        }
+    } else if(strcmp(flag, "--gen-zipf") == 0) {
+        config->zipf_exponent = strtod(value, NULL);
+        if(config->zipf_exponent <= 0.0 || config->zipf_exponent >= 1.0) {
+            printf("zipf exponent must be between 0 and 1\n");
+            return 1;
+        }
+    } else if(strcmp(flag, "--gen-lines") == 0) {
+        if(parse_positive_flag(value, &config->conflict_lines)) {
+            printf("generator conflict lines must be a positive integer\n");
+            return 1;
+        }
+    } else {
+        printf("unknown generator flag %s\n", flag);
+        return 1;
     }
 
-    *p++ = '\0';
-    *lineptr = bufptr;
-    *n = size;
+    return 0;
+}
 
-    return p - bufptr - 1;
+//Function to print the generator flags shared by the gen subcommand and the simulator
+void print_gen_usage() {
+    printf("Generator options:\n"
+           "[--gen-length] <count> number of accesses to generate (default: 1000000)\n"
+           "[--gen-seed] <seed> random seed, the same seed always gives the same trace (default: 1)\n"
+           "[--gen-writes] <percent> percentage of the accesses that are writes (default: 30)\n"
+           "[--gen-base] <address> first word address in hex (default: 0)\n"
+           "[--gen-footprint] <words> number of words addressed, clamped to main memory (default: 1048576)\n"
+           "[--gen-stride] <words> distance of strided accesses and pointer chasing nodes (default: 16)\n"
+           "[--gen-zipf] <exponent> exponent of the zipf hot-set pattern between 0 and 1 (default: 0.99)\n"
+           "[--gen-lines] <count> lines cycled through by the conflict pattern (default: associativity + 1)\n\n");
+    printf("Patterns: seq, stride, uniform, zipf (hot set), chase (pointer chasing over one random cycle),\n"
+           "conflict (lines one cache way apart that all map to the same set, needs -c, -b, and -a)\n\n");
 }
-#endif // _WIN32
 
+//Function to write a generated trace to a file, the entry point of the gen subcommand
+int generate_trace(int argc, char* argv[]) {
+    if(argc < 2 || strcmp(argv[1], "-h") == 0) {
+        printf("Usage information:\ncache_sim gen <pattern> -o <output_file> [options]\n\n");
+        printf("[--gen-format] <format> trace file format, text or bin (default: text)\n"
+               "[-c] [-b] [-a] cache geometry the conflict pattern is aimed at\n\n");
+        print_gen_usage();
+        printf("Example: ./cache_sim gen zipf -o zipf.trace --gen-length 100000000 --gen-format bin\n");
+        return argc < 2;
+    }
 
-//Function to calculate time difference for benchmarking
-float time_difference_msec(struct timeval t0, struct timeval t1) {
-    return (float) (t1.tv_sec - t0.tv_sec) * 1000.0f + (float) (t1.tv_usec - t0.tv_usec) / 1000.0f;
-}
+    struct gen_config config = zero_gen_config();
+    struct cache geometry = zero_cache();
+    int format = TRACE_FORMAT_TEXT;
+    char* output = NULL;
 
-//Function to read input file and process traces
-int process_trace(char* input_file, struct cache* cache_mem, struct cache_stats* stats,
-                    struct main_mem_block* main_mem) {
+    config.pattern = gen_pattern_from_name(argv[1]);
+    if(config.pattern < 0) {
+        printf("pattern must be seq, stride, uniform, zipf, chase, or conflict\n");
+        return 1;
+    }
 
-    //Verify validity of file
-    if(access(input_file, F_OK) == 0) {
-        // File exists
-        printf("Input file found!\n");
-
-        //Open the file
-        FILE* trace_file = fopen(input_file, "r");
-        char* line = NULL;
-        size_t len = 0;
-        ssize_t read;
-        int line_num = 1;
-        bool failure = 0;
-
-        //If trace_file still NULL, failed to open and need to exit
-        if(!trace_file) {
-            printf("Error: Input file could not be read!\n");
-            fclose(trace_file);
-            return 3;
-        }
-
-        printf("Running cache simulation...\n");
-
-        struct timeval t0;
-        struct timeval t1;
-        float elapsed;
-
-        //Start benchmark
-        gettimeofday(&t0, 0);
-
-        //Get each line from file
-        while((read = getline(&line, &len, trace_file)) != -1) {
-            int read_write = -1;
-            //Longs so that we can verify that a 32-bit address was actually pulled from the file
-            unsigned long long addr = -1;
-            unsigned long long val = -1;
-
-            //Verify that the line only contains hex characters, spaces, and new lines
-            for(int i = 0; i < read; i++) {
-                if(!isxdigit(line[i]) && line[i] != ' ' && line[i] != '\n') {
-                    printf("Error: Malformed input file: Unrecognizable instruction on line %d position %d\n", line_num, i + 1);
-                    failure = 1;
-                    break;
-                }
+    for(int i = 2; i < argc; i++) {
+        char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if(strcmp(argv[i], "-o") == 0 && value) {
+            output = value;
+        } else if(strcmp(argv[i], "--gen-format") == 0 && value) {
+            if(strcmp(value, "text") == 0) {
+                format = TRACE_FORMAT_TEXT;
+            } else if(strcmp(value, "bin") == 0) {
+                format = TRACE_FORMAT_BINARY;
+            } else {
+                printf("trace format must be text or bin\n");
+                return 1;
             }
+        } else if(strcmp(argv[i], "-c") == 0 && value) {
+            geometry.size = (int) strtol(value, NULL, 10) * 1024;
+        } else if(strcmp(argv[i], "-b") == 0 && value) {
+            geometry.line_size = (int) strtol(value, NULL, 10);
+        } else if(strcmp(argv[i], "-a") == 0 && value) {
+            geometry.associativity = (int) strtol(value, NULL, 10);
+        } else if(parse_gen_flag(argv[i], value, &config)) {
+            return 1;
+        }
+        i++;
+    }
 
-            if(failure) {
-                break;
+    if(!output) {
+        printf("The gen subcommand needs an output file set with -o\n");
+        return 1;
+    }
+    if(geometry.line_size != 0 && geometry.line_size < WORD_SIZE) {
+        printf("block size must hold at least one word\n");
+        return 1;
+    }
+
+    struct generator gen;
+    if(init_generator(&gen, config, geometry)) {
+        return 1;
+    }
+
+    FILE* output_file = fopen(output, format == TRACE_FORMAT_BINARY ? "wb" : "w");
+    if(!output_file) {
+        printf("Error: Output file could not be created / opened!\n");
+        free_generator(&gen);
+        return 1;
+    }
+
+    int status = write_trace_header(output_file, format);
+    struct trace_record record;
+    while(status == 0 && gen_next(&gen, &record)) {
+        status = write_trace_record(output_file, format, record);
+    }
+    if(fclose(output_file) != 0 || status != 0) {
+        printf("Error: Could not write the generated trace to %s\n", output);
+        status = 5;
+    } else {
+        printf("Generated %s trace of %ld accesses with seed %llu to %s\n", gen_pattern_name(config.pattern),
+               gen.produced, config.seed, output);
+    }
+
+    free_generator(&gen);
+    return status;
+}
+
+//Function to run the jobs of a job file, the entry point of the batch subcommand
+int run_batch_command(int argc, char* argv[]) {
+    if(argc < 2 || strcmp(argv[1], "-h") == 0) {
+        printf("Usage information:\ncache_sim batch <job_file> [options]\n\n");
+        printf("Every line of the job file is a trace followed by the options of one job:\n"
+               "<trace> -c <capacity> -b <blocksize> -a <associativity> [--index <function>] [--sector <bytes>]\n"
+               "        [--format text|csv|json] [--no-dump] [--mem-window <start>:<size>] [-o <output_file>]\n"
+               "Blank lines and lines starting with # are skipped, jobs without -o are printed in job order\n\n");
+        printf("[--threads] <count> host threads running the jobs, at most %d (default: 1)\n"
+               "[--cache-dir] <dir> directory of the result cache, keyed by the trace contents and the config\n"
+               "            (default: %s)\n"
+               "[--no-cache] run every job without looking up or storing cached results\n\n",
+               BATCH_MAX_THREADS, BATCH_CACHE_DIR);
+        printf("Example: ./cache_sim batch sweep.jobs --threads 8\n");
+        return argc < 2;
+    }
+
+    long threads = 1;
+    char* cache_dir = BATCH_CACHE_DIR;
+    for(int i = 2; i < argc; i++) {
+        char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if(strcmp(argv[i], "--no-cache") == 0) {
+            cache_dir = NULL;
+        } else if(strcmp(argv[i], "--threads") == 0 && value) {
+            i++;
+            if(parse_positive_flag(value, &threads) || threads > BATCH_MAX_THREADS) {
+                printf("threads must be a positive integer of at most %d\n", BATCH_MAX_THREADS);
+                return 1;
             }
+        } else if(strcmp(argv[i], "--cache-dir") == 0 && value) {
+            i++;
+            cache_dir = value;
+        } else {
+            printf("Improper command line usage. Use cache_sim batch -h to see usage instructions.\n");
+            return 1;
+        }
+    }
 
-            //Read instruction type
-            sscanf(line, "%x", &read_write);
+    return run_batch(argv[1], (int) threads, cache_dir);
+}
 
-            if(read_write == CACHE_READ) {
-                //Line is a read, get the address
-                sscanf(line, "%*x %llx", &addr);
+//Function to run one trace per core on private caches kept coherent with MESI, and report every core
+int simulate_cores(struct cache geometry, char** traces, int total_cores, long quantum, long epoch_length,
+                   int threads, char* output, char* mem_image, char* mem_dump) {
+    struct main_mem_block* main_memory = init_main_mem();
+    if(mem_image[0] != '\0' && load_mem_image(main_memory, mem_image)) {
+        free_io(zero_cache(), main_memory);
+        return 1;
+    }
 
-                //Verify address was retrieved
-                if(addr == -1) {
-                    printf("Error: Malformed address: Could not read address on line %d\n", line_num);
-                    failure = 1;
-                    break;
-                }
+    struct multicore mc;
+    if(init_multicore(&mc, geometry, traces, total_cores, main_memory, quantum, epoch_length, threads)) {
+        free_io(zero_cache(), main_memory);
+        return 1;
+    }
 
-                //Read from the cache
-                read_from_cache(cache_mem, stats, main_mem, addr);
-            } else if(read_write == CACHE_WRITE) {
-                //Line is a write, get the address and new value
-                sscanf(line, "%*x %llx %llx", &addr, &val);
+    printf("Running %d core simulation...\n", total_cores);
+    struct timeval t0;
+    struct timeval t1;
+    gettimeofday(&t0, 0);
+    int status = run_multicore(&mc);
+    gettimeofday(&t1, 0);
 
-                //Verify the address and value retrieved from the line
-                if(addr == -1 || val == -1) {
-                    printf("Error: Malformed address or value: Could not read address or value on line %d, %llu %llu\n", line_num, addr, val);
-                    failure = 1;
-                    break;
-                }
+    if(status == 0) {
+        long total_actions = 0;
+        for(int i = 0; i < total_cores; i++) {
+            total_actions += mc.cores[i].stats.total_actions;
+        }
+        printf("Finished cache simulation!\nProcessed %ld instructions in %f ms\n\n", total_actions,
+               time_difference_msec(t0, t1));
 
-                //Write to the cache
-                write_to_cache(cache_mem, stats, main_mem, addr, val);
+        //Dump the whole of main memory, which now holds the written back contents of every cache
+        if(mem_dump[0] != '\0' && dump_mem_image(main_memory, mem_dump)) {
+            status = 5;
+        }
+    }
+
+    if(status == 0) {
+        if(output[0] == '\0') {
+            printf("No output file: Just printing to screen\n\n");
+        } else {
+            FILE* output_file = fopen(output, "w");
+            if(!output_file) {
+                printf("Error: Output file could not be created / opened!\n");
             } else {
-                //Not a read or write instruction
-                printf("Error: Unrecognized instruction: Invalid instruction on line %d\n", line_num);
-                failure = 1;
-                break;
+                print_multicore_report(output_file, &mc);
+                fclose(output_file);
             }
-
-            line_num++;
         }
+        print_multicore_report(stdout, &mc);
+    }
+
+    free_multicore(&mc);
+    free_io(zero_cache(), main_memory);
+    return status;
+}
+
+//Function to run several workloads on one shared cache, optionally way partitioned, and report the shared
+//cache followed by every workload
+int simulate_workloads(struct cache cache_memory, struct workload_options* workloads, long quantum, bool set_stats,
+                       char* output, struct output_config output_config, char* mem_image, char* mem_dump) {
+    struct main_mem_block* main_memory = init_main_mem();
+    cache_memory = init_cache_mem(cache_memory);
+    if(mem_image[0] != '\0' && load_mem_image(main_memory, mem_image)) {
+        free_io(cache_memory, main_memory);
+        return 1;
+    }
 
-        //Verify that no failure occurred
-        if(!failure) {
-            //If not a failure, write the contents of the cache to the memory
-            write_cache_to_memory(cache_mem, main_mem);
+    struct way_partition partition;
+    if(workloads->total_ways > 0) {
+        if(init_way_partition(&partition, cache_memory, workloads->ways, workloads->total_workloads,
+                              workloads->qos)) {
+            free_io(cache_memory, main_memory);
+            return 1;
         }
+        cache_memory.partition = &partition;
+    }
 
-        //Stop benchmark
-        gettimeofday(&t1, 0);
-        //Calculate time difference
-        elapsed = time_difference_msec(t0, t1);
+    struct set_occupancy occupancy;
+    if(set_stats) {
+        if(init_set_occupancy(&occupancy, cache_memory)) {
+            free_io(cache_memory, main_memory);
+            return 1;
+        }
+        cache_memory.occupancy = &occupancy;
+    }
 
-        //Close file descriptor
-        fclose(trace_file);
-        //Free memory allocated to the line
-        if(line) {
-            free(line);
+    struct multiprog mp;
+    if(init_multiprog(&mp, cache_memory, workloads->traces, workloads->total_workloads, quantum)) {
+        if(cache_memory.occupancy) {
+            free_set_occupancy(cache_memory.occupancy);
         }
+        free_io(cache_memory, main_memory);
+        return 1;
+    }
+
+    printf("Running %d workload simulation...\n", workloads->total_workloads);
+    struct timeval t0;
+    struct timeval t1;
+    gettimeofday(&t0, 0);
+    int status = run_multiprog(&mp, &cache_memory, main_memory);
+    gettimeofday(&t1, 0);
+    struct cache_stats stats = multiprog_total_stats(&mp);
 
-        if(failure) {
-            return 4;
+    if(status == 0) {
+        printf("Finished cache simulation!\nProcessed %ld instructions in %f ms\n\n", stats.total_actions,
+               time_difference_msec(t0, t1));
+        if(workloads->solo) {
+            status = run_solo(&mp, cache_memory);
         }
+    }
 
-        printf("Finished cache simulation!\nProcessed %ld instructions in %f ms\n\n", stats->total_actions, elapsed);
-    } else {
-        // File doesn't exist
-        printf("Error: Input file could not be found!\n");
-        return 2;
+    //Dump the whole of main memory, which now holds the written back cache contents
+    if(status == 0 && mem_dump[0] != '\0' && dump_mem_image(main_memory, mem_dump)) {
+        status = 5;
     }
 
-    return 0;
+    if(status == 0) {
+        size_t results_length;
+        char* results = format_results(cache_memory, stats, main_memory, output_config, &results_length);
+        if(!results) {
+            printf("Error: Could not allocate memory for the results\n");
+            status = 5;
+        } else {
+            if(output[0] == '\0') {
+                printf("No output file: Just printing to screen\n\n");
+            } else {
+                FILE* output_file = fopen(output, "w");
+                if(!output_file) {
+                    printf("Error: Output file could not be created / opened!\n");
+                } else {
+                    fwrite(results, 1, results_length, output_file);
+                    //Keep CSV and JSON results parseable
+                    if(output_config.format == OUTPUT_TEXT) {
+                        fprintf(output_file, "\n");
+                        print_multiprog_report(output_file, &mp);
+                        if(cache_memory.occupancy) {
+                            fprintf(output_file, "\n");
+                            print_set_occupancy(output_file, cache_memory.occupancy, cache_memory);
+                        }
+                    }
+                    fclose(output_file);
+                }
+            }
+            fflush(stdout);
+            fwrite(results, 1, results_length, stdout);
+            printf("\n");
+            print_multiprog_report(stdout, &mp);
+            if(cache_memory.occupancy) {
+                printf("\n");
+                print_set_occupancy(stdout, cache_memory.occupancy, cache_memory);
+            }
+            free(results);
+        }
+    }
+
+    free_multiprog(&mp);
+    if(cache_memory.occupancy) {
+        free_set_occupancy(cache_memory.occupancy);
+    }
+    free_io(cache_memory, main_memory);
+    return status;
 }
 
 //Application entry point
@@ -254,7 +655,66 @@ int main(int argc, char *argv[]) {
     //Defining variables for file input, output, and the current working directory
     char input[PATH_MAX] = {0};
     char output[PATH_MAX] = {0};
+    char instrument[PATH_MAX] = {0};
+    char interval_output[PATH_MAX] = {0};
+    char checkpoint_file[PATH_MAX] = "cache_sim.ckpt";
+    char restore[PATH_MAX] = {0};
+    char mem_image[PATH_MAX] = {0};
+    char mem_dump[PATH_MAX] = {0};
+    long checkpoint_every = 0;
+    long hot_top = 0;
+    long interval_length = 0;
+    int interval_format = INTERVAL_FORMAT_CSV;
+#ifdef CACHE_SIM_INSTRUMENT
+    //Hot address settings, only read when the instrumentation hooks are built in
+    char region_map[PATH_MAX] = {0};
+    long hot_counters = 0;
+#endif
     char cwd[PATH_MAX];
+    bool generate = 0;
+    struct gen_config gen_config = zero_gen_config();
+    char* core_traces[MAX_CORES];
+    int total_cores = 0;
+    long quantum = 1;
+    long epoch_length = 4096;
+    long threads = 1;
+    bool set_stats = 0;
+    long sector_size = 0;
+    int tlb_entries[TLB_MAX_LEVELS];
+    int tlb_ways[TLB_MAX_LEVELS];
+    int tlb_levels = 0;
+    int page_size = 0;
+    int page_alloc = PAGE_ALLOC_RANDOM;
+    bool split = 0;
+    struct cache icache_geometry = zero_cache();
+    int dram_channels = 0;
+    int dram_banks = 0;
+    int dram_policy = DRAM_PAGE_OPEN;
+    int dram_timing[3] = {DRAM_DEFAULT_CAS, DRAM_DEFAULT_RCD, DRAM_DEFAULT_RP};
+    bool dram_options = 0;
+    int total_mshrs = 0;
+    int miss_latency = MSHR_DEFAULT_MISS_LATENCY;
+    bool miss_latency_set = 0;
+    struct workload_options workloads;
+    memset(&workloads, 0, sizeof(struct workload_options));
+
+    //The gen subcommand writes a synthetic trace instead of simulating one
+    if(argc >= 2 && strcmp(argv[1], "gen") == 0) {
+        return generate_trace(argc - 1, argv + 1);
+    }
+    //The serve subcommand keeps a simulator resident and answers clients on a Unix domain socket
+    if(argc >= 2 && strcmp(argv[1], "serve") == 0) {
+        if(argc != 3) {
+            printf("Usage information:\ncache_sim serve <socket>\n\nUse cache_sim_client -h to see the commands\n");
+            return 1;
+        }
+        return run_server(argv[2]);
+    }
+
+    //The batch subcommand runs the jobs of a job file on a pool of host threads
+    if(argc >= 2 && strcmp(argv[1], "batch") == 0) {
+        return run_batch_command(argc - 1, argv + 1);
+    }
 
     //Verifying input flags
     if(argc < 9) {
@@ -265,9 +725,113 @@ int main(int argc, char *argv[]) {
             printf("-c <capacity> with <capacity> in KB: 4, 8, 16, 32, or 64\n"
                    "-b <blocksize> with <blocksize> in bytes: 4, 8, 16, 32, 64, 128, 256, or 512\n"
                    "-a <associativity> where <associativity> is integer size of set: 1, 2, 4, 8, or 16\n"
-                   "-i <input_file> where <input_file> is the name and / or path of your memory trace file\n"
+                   "-i <input_file> where <input_file> is the name and / or path of your memory trace file, text or\n"
+                   "   binary, and gzip or zstd compressed traces are read as they are decompressed\n"
                    "[-o] <output_file> where <output_file> is the name and / or path of your output file \n\n");
+            printf("Trace formats:\n"
+                   "text    one access per line, every field in hex: \"0 <addr>\" reads, \"1 <addr> <value>\" writes,\n"
+                   "        and \"2 <addr>\" fetches an instruction. Any line may end with \"<size> <pc>\" or just\n"
+                   "        \"<size>\", the access size in bytes (hex, at most %x) and the PC of the access\n"
+                   "binary  the header \"%s\" and a 32-bit version, then per record an op byte and the address and\n"
+                   "        write value as little endian 64-bit integers. Op bytes with 0x%02x set add the size and PC\n\n",
+                   TRACE_MAX_SIZE, TRACE_BINARY_MAGIC, TRACE_OP_EXTENDED);
+            printf("Output options:\n"
+                   "[--format] <format> results as text, csv, or json (default: text)\n"
+                   "[--no-dump] leave the cache contents and main memory window out of the results\n"
+                   "[--mem-window] <start>:<size> main memory window to dump, <start> in hex and <size> in words\n"
+                   "               (default: 3f7f00:1024)\n\n");
+            printf("Main memory options:\n"
+                   "[--mem-image] <file> initialize main memory from a raw image of host order words\n"
+                   "[--dump-mem] <file> write all of main memory as a raw image after the cache is written back\n\n");
+            printf("Set index options:\n"
+                   "[--index] <function> mod takes the set from the address bits above the word, xor folds the tag\n"
+                   "          into those bits, prime takes the line number modulo the largest prime number of\n"
+                   "          sets, and skew hashes the tag differently for every way (default: mod)\n"
+                   "[--set-stats] report the fills, evictions, and valid lines of every set\n\n");
+            printf("Sector options:\n"
+                   "[--sector] <bytes> split every line into sectors of <bytes>, a power of two from the word size\n"
+                   "           up to the block size, so a miss only fills the sector it needs and only dirty\n"
+                   "           sectors are written back, and report the sector misses and bytes moved\n\n");
+            printf("Translation options:\n"
+                   "[--tlb] <entries>:<ways>,... translate trace addresses as virtual addresses through a TLB of up\n"
+                   "        to %d levels, a miss in every level walks the page table through the cache\n"
+                   "[--page-size] <size> 4k or 2m (default: 4k)\n"
+                   "[--page-alloc] <order> hand out physical frames in random or linear order (default: random)\n\n",
+                   TLB_MAX_LEVELS);
+            printf("Split cache options:\n"
+                   "[--split] send the instruction fetches (op 2) to an instruction cache of the same geometry\n"
+                   "[--icache] <capacity>:<blocksize>:<associativity> geometry of the instruction cache, implies\n"
+                   "           --split\n\n");
+            printf("DRAM options:\n"
+                   "[--dram] <channels>:<banks> time the fills and write-backs of the cache on a DRAM of up to %d\n"
+                   "         channels of up to %d banks with a %d byte row buffer per bank\n"
+                   "[--dram-policy] <policy> open keeps a row open until the bank needs another one, closed\n"
+                   "                precharges after every access (default: open)\n"
+                   "[--dram-timing] <cas>:<rcd>:<rp> column access, row activation, and precharge in memory cycles\n"
+                   "                (default: %d:%d:%d)\n\n",
+                   DRAM_MAX_CHANNELS, DRAM_MAX_BANKS, DRAM_ROW_SIZE, DRAM_DEFAULT_CAS, DRAM_DEFAULT_RCD,
+                   DRAM_DEFAULT_RP);
+            printf("Non-blocking cache options:\n"
+                   "[--mshrs] <count> let up to <count> misses (at most %d) be in flight at once and report the memory\n"
+                   "          level parallelism, MSHR occupancy, and stalls on full MSHRs, accesses issue one per cycle\n"
+                   "[--miss-latency] <cycles> cycles from a miss to its fill, on top of the DRAM latency when --dram\n"
+                   "                 is set (default: %d)\n\n", MAX_MSHRS, MSHR_DEFAULT_MISS_LATENCY);
+            printf("Sampling options:\n"
+                   "[--sample-sets] <ratio> simulate only every <ratio>-th cache set and scale the results up\n"
+                   "[--sample-period] <period> with [--sample-window] <window> measure <window> out of every <period> accesses\n"
+                   "[--sample-warmup] <warmup> accesses used only to warm the cache before each window (default: all)\n\n");
+            printf("Miss ratio curve options:\n"
+                   "[--mrc] estimate the miss ratio curve of the trace in a single pass with SHARDS sampling\n"
+                   "[--mrc-rate] <rate> initial sampling rate between 0 and 1 (default: 0.01)\n"
+                   "[--mrc-samples] <count> largest number of sampled blocks kept in memory (default: 8192)\n"
+                   "[--mrc-max] <capacity> largest capacity in KB reported by the curve (default: 1024)\n\n");
+            printf("Instrumentation options (builds with CACHE_SIM_INSTRUMENT only):\n"
+                   "[--instrument] <file> export reuse distances, per-set counters, and the 3C miss classification\n"
+                   "                      as JSON if <file> ends in .json and as CSV otherwise\n"
+                   "[--hot] <count> report the <count> lines, sets, and regions causing the most misses\n"
+                   "[--hot-counters] <count> heavy hitter counters kept per summary (default: 4096)\n"
+                   "[--regions] <file> region map with one \"<start> <end> <name>\" hex address range per line\n\n");
+            printf("Checkpoint options:\n"
+                   "[--checkpoint-every] <count> snapshot the whole simulator every <count> trace records\n"
+                   "[--checkpoint-file] <file> file the snapshot is written to (default: cache_sim.ckpt)\n"
+                   "[--restore] <file> continue from a snapshot taken with the same -c, -b, -a and trace, the\n"
+                   "            sampling, miss ratio curve, and instrumentation modes only see the records after it\n\n");
+            printf("Synthetic input, used instead of -i:\n"
+                   "[--gen] <pattern> stream a generated trace straight into the simulator\n\n");
+            print_gen_usage();
+            printf("Multi-core options, used instead of -i:\n"
+                   "[--core] <file> add a core with a private cache running the trace <file>, repeat for up to %d\n"
+                   "         cores kept coherent with MESI over a shared bus to main memory\n"
+                   "[--quantum] <count> records a core runs before the next core takes a turn (default: 1)\n"
+                   "[--epoch] <count> records per core read ahead to find stretches without sharing (default: 4096)\n"
+                   "[--threads] <count> host threads simulating the cores during those stretches (default: 1)\n\n",
+                   MAX_CORES);
+            printf("Multi-programmed options, used instead of -i:\n"
+                   "[--workload] <file> add a workload running the trace <file> on the one shared cache, repeat for\n"
+                   "             up to %d workloads taking turns of [--quantum] records\n"
+                   "[--partition] <ways>,<ways>,... ways each workload may fill or evict, in --workload order, the\n"
+                   "              ways left over are shared by all workloads (default: no partition)\n"
+                   "[--qos] duel the partition against the unpartitioned cache on leader sets and let the other\n"
+                   "        sets follow whichever misses less\n"
+                   "[--solo] also run every workload alone on the whole cache to measure the interference\n\n",
+                   MAX_WORKLOADS);
+            printf("Interval statistics options:\n"
+                   "[--interval] <count> emit misses, miss rates, and evictions every <count> accesses\n"
+                   "[--interval-out] <file> file the interval records are streamed to\n"
+                   "[--interval-format] <format> csv or bin (default: csv)\n\n");
             printf("Example: ./cache_sim -c 8 -b 16 -a 4 -i mem.trace -o mem_trace.txt\n");
+            printf("Example: ./cache_sim -c 8 -b 16 -a 4 --gen zipf --gen-length 1000000000 --gen-seed 7\n");
+            printf("Example: ./cache_sim serve /tmp/cache_sim.sock\n");
+            printf("Example: ./cache_sim batch sweep.jobs --threads 8\n");
+            printf("Example: ./cache_sim -c 8 -b 16 -a 4 --core a.trace --core b.trace --quantum 100\n");
+            printf("Example: ./cache_sim -c 8 -b 16 -a 4 --workload a.trace --workload b.trace --partition 3,1 --solo\n");
+            printf("Example: ./cache_sim gen conflict -c 8 -b 16 -a 4 -o conflict.trace --gen-format bin\n");
+            printf("Example: ./cache_sim -c 8 -b 16 -a 4 -i conflict.trace --index skew --set-stats\n");
+            printf("Example: ./cache_sim -c 8 -b 128 -a 4 -i mem.trace --sector 32\n");
+            printf("Example: ./cache_sim -c 8 -b 16 -a 4 -i mem.trace --tlb 64:4,1536:12 --page-size 4k\n");
+            printf("Example: ./cache_sim -c 8 -b 16 -a 4 -i program.trace --icache 4:32:2\n");
+            printf("Example: ./cache_sim -c 8 -b 64 -a 4 -i mem.trace --dram 2:8 --dram-policy closed\n");
+            printf("Example: ./cache_sim -c 8 -b 64 -a 4 -i mem.trace --mshrs 8 --dram 2:8\n");
             return 0;
         }
         // If there are too few arguments, have the user check the -h
@@ -277,8 +841,11 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    //Zero the cache
+    //Zero the cache and the optional analysis configs
     struct cache cache_memory = zero_cache();
+    struct sample_config sample_config = zero_sample_config();
+    struct shards_config shards_config = zero_shards_config();
+    struct output_config output_config = zero_output_config();
 
     //Loop over all program parameters
     //First param is program name so we can skip
@@ -346,11 +913,479 @@ int main(int argc, char *argv[]) {
 
             //Copy value into our output char[]
             strcpy(output, argv[i]);
+        } else if(strcmp(argv[i], "--sample-sets") == 0) {
+            //If set sampling flag
+            i++;
+            long ratio;
+            if(parse_positive_flag(argv[i], &ratio)) {
+                printf("set sampling ratio must be a positive integer\n");
+                return 1;
+            }
+            sample_config.mode = SAMPLE_SETS;
+            sample_config.set_ratio = (int) ratio;
+        } else if(strcmp(argv[i], "--sample-period") == 0) {
+            //If time sampling period flag
+            i++;
+            if(parse_positive_flag(argv[i], &sample_config.period)) {
+                printf("sample period must be a positive integer\n");
+                return 1;
+            }
+            sample_config.mode = SAMPLE_TIME;
+        } else if(strcmp(argv[i], "--sample-window") == 0) {
+            //If time sampling window flag
+            i++;
+            if(parse_positive_flag(argv[i], &sample_config.window)) {
+                printf("sample window must be a positive integer\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--sample-warmup") == 0) {
+            //If time sampling warmup flag, zero is allowed and means no warming at all
+            i++;
+            if(strcmp(argv[i], "0") == 0) {
+                sample_config.warmup = 0;
+            } else if(parse_positive_flag(argv[i], &sample_config.warmup)) {
+                printf("sample warmup must be a non-negative integer\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--mrc") == 0) {
+            //If miss ratio curve flag
+            shards_config.enabled = 1;
+        } else if(strcmp(argv[i], "--mrc-rate") == 0) {
+            //If miss ratio curve sampling rate flag
+            i++;
+            shards_config.enabled = 1;
+            shards_config.rate = strtod(argv[i], NULL);
+            if(shards_config.rate <= 0.0 || shards_config.rate > 1.0) {
+                printf("miss ratio curve sampling rate must be greater than 0 and at most 1\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--mrc-samples") == 0) {
+            //If miss ratio curve sample limit flag
+            i++;
+            shards_config.enabled = 1;
+            if(parse_positive_flag(argv[i], &shards_config.max_samples)) {
+                printf("miss ratio curve sample limit must be a positive integer\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--mrc-max") == 0) {
+            //If miss ratio curve largest capacity flag
+            i++;
+            shards_config.enabled = 1;
+            long capacity;
+            if(parse_positive_flag(argv[i], &capacity)) {
+                printf("miss ratio curve capacity must be a positive integer\n");
+                return 1;
+            }
+            shards_config.max_capacity = (int) capacity;
+        } else if(strcmp(argv[i], "--instrument") == 0) {
+            //If instrumentation flag
+            i++;
+#ifdef CACHE_SIM_INSTRUMENT
+            strcpy(instrument, argv[i]);
+#else
+            printf("instrumentation is not available, rebuild with CACHE_SIM_INSTRUMENT enabled\n");
+            return 1;
+#endif
+        } else if(strcmp(argv[i], "--hot") == 0 || strcmp(argv[i], "--hot-counters") == 0
+                  || strcmp(argv[i], "--regions") == 0) {
+            //If hot address flags
+#ifdef CACHE_SIM_INSTRUMENT
+            i++;
+            if(strcmp(argv[i - 1], "--regions") == 0) {
+                strcpy(region_map, argv[i]);
+                if(hot_top == 0) {
+                    hot_top = 10;
+                }
+            } else if(strcmp(argv[i - 1], "--hot") == 0 && parse_positive_flag(argv[i], &hot_top)) {
+                printf("hot address count must be a positive integer\n");
+                return 1;
+            } else if(strcmp(argv[i - 1], "--hot-counters") == 0 && parse_positive_flag(argv[i], &hot_counters)) {
+                printf("hot address counters must be a positive integer\n");
+                return 1;
+            }
+#else
+            printf("hot address tracking is not available, rebuild with CACHE_SIM_INSTRUMENT enabled\n");
+            return 1;
+#endif
+        } else if(strcmp(argv[i], "--index") == 0) {
+            //If set index function flag
+            i++;
+            cache_memory.index_function = index_function_from_name(argv[i]);
+            if(cache_memory.index_function < 0) {
+                printf("index function must be mod, xor, prime, or skew\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--set-stats") == 0) {
+            //If per-set statistics flag
+            set_stats = 1;
+        } else if(strcmp(argv[i], "--tlb") == 0) {
+            //If TLB flag, a comma separated list of <entries>:<ways> levels
+            i++;
+            tlb_levels = 0;
+            char* cursor = argv[i];
+            while(1) {
+                char* end;
+                long entries = strtol(cursor, &end, 10);
+                long ways = *end == ':' ? strtol(end + 1, &end, 10) : 0;
+                if(tlb_levels == TLB_MAX_LEVELS || entries <= 0 || ways <= 0 || (*end != ',' && *end != '\0')) {
+                    printf("TLB must be a comma separated list of at most %d <entries>:<ways> levels\n",
+                           TLB_MAX_LEVELS);
+                    return 1;
+                }
+                tlb_entries[tlb_levels] = (int) entries;
+                tlb_ways[tlb_levels++] = (int) ways;
+                if(*end == '\0') {
+                    break;
+                }
+                cursor = end + 1;
+            }
+        } else if(strcmp(argv[i], "--split") == 0) {
+            //If split cache flag
+            split = 1;
+        } else if(strcmp(argv[i], "--icache") == 0) {
+            //If instruction cache geometry flag, with the same limits as -c, -b, and -a
+            i++;
+            char* end;
+            long capacity = strtol(argv[i], &end, 10);
+            long line_size = *end == ':' ? strtol(end + 1, &end, 10) : 0;
+            long associativity = *end == ':' ? strtol(end + 1, &end, 10) : 0;
+            if(*end != '\0' || capacity < 4 || capacity > 64 || (capacity & (capacity - 1)) != 0
+                    || line_size < 4 || line_size > 512 || (line_size & (line_size - 1)) != 0
+                    || associativity < 1 || associativity > 16 || (associativity & (associativity - 1)) != 0) {
+                printf("instruction cache must be <capacity>:<blocksize>:<associativity> with the limits of -c, "
+                       "-b, and -a\n");
+                return 1;
+            }
+            icache_geometry.size = (int) capacity * 1024;
+            icache_geometry.line_size = (int) line_size;
+            icache_geometry.associativity = (int) associativity;
+            split = 1;
+        } else if(strcmp(argv[i], "--dram") == 0) {
+            //If DRAM flag, given as <channels>:<banks>
+            i++;
+            char* end;
+            long channels = strtol(argv[i], &end, 10);
+            long banks = *end == ':' ? strtol(end + 1, &end, 10) : 0;
+            if(*end != '\0' || channels < 1 || channels > DRAM_MAX_CHANNELS || (channels & (channels - 1)) != 0
+                    || banks < 1 || banks > DRAM_MAX_BANKS || (banks & (banks - 1)) != 0) {
+                printf("DRAM must be <channels>:<banks>, powers of two of at most %d channels and %d banks\n",
+                       DRAM_MAX_CHANNELS, DRAM_MAX_BANKS);
+                return 1;
+            }
+            dram_channels = (int) channels;
+            dram_banks = (int) banks;
+        } else if(strcmp(argv[i], "--dram-policy") == 0) {
+            //If DRAM page policy flag
+            i++;
+            if(strcmp(argv[i], "open") == 0) {
+                dram_policy = DRAM_PAGE_OPEN;
+            } else if(strcmp(argv[i], "closed") == 0) {
+                dram_policy = DRAM_PAGE_CLOSED;
+            } else {
+                printf("DRAM page policy must be open or closed\n");
+                return 1;
+            }
+            dram_options = 1;
+        } else if(strcmp(argv[i], "--dram-timing") == 0) {
+            //If DRAM timing flag, given as <cas>:<rcd>:<rp>
+            i++;
+            char extra;
+            if(sscanf(argv[i], "%d:%d:%d%c", &dram_timing[0], &dram_timing[1], &dram_timing[2], &extra) != 3
+                    || dram_timing[0] < 1 || dram_timing[1] < 0 || dram_timing[2] < 0) {
+                printf("DRAM timing must be <cas>:<rcd>:<rp> in memory cycles\n");
+                return 1;
+            }
+            dram_options = 1;
+        } else if(strcmp(argv[i], "--mshrs") == 0) {
+            //If MSHR count flag
+            i++;
+            char* end;
+            long count = strtol(argv[i], &end, 10);
+            if(*end != '\0' || count < 1 || count > MAX_MSHRS) {
+                printf("MSHRs must be between 1 and %d\n", MAX_MSHRS);
+                return 1;
+            }
+            total_mshrs = (int) count;
+        } else if(strcmp(argv[i], "--miss-latency") == 0) {
+            //If miss latency flag
+            i++;
+            char* end;
+            long cycles = strtol(argv[i], &end, 10);
+            if(*end != '\0' || cycles < 0 || cycles > INT_MAX) {
+                printf("Miss latency must be a non-negative number of cycles\n");
+                return 1;
+            }
+            miss_latency = (int) cycles;
+            miss_latency_set = 1;
+        } else if(strcmp(argv[i], "--page-size") == 0) {
+            //If page size flag
+            i++;
+            if(strcmp(argv[i], "4k") == 0) {
+                page_size = PAGE_SIZE_SMALL;
+            } else if(strcmp(argv[i], "2m") == 0) {
+                page_size = PAGE_SIZE_HUGE;
+            } else {
+                printf("page size must be 4k or 2m\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--page-alloc") == 0) {
+            //If frame allocation order flag
+            i++;
+            if(strcmp(argv[i], "random") == 0) {
+                page_alloc = PAGE_ALLOC_RANDOM;
+            } else if(strcmp(argv[i], "linear") == 0) {
+                page_alloc = PAGE_ALLOC_LINEAR;
+            } else {
+                printf("page allocation must be random or linear\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--sector") == 0) {
+            //If sector size flag
+            i++;
+            if(parse_positive_flag(argv[i], &sector_size) || sector_size < WORD_SIZE
+                    || (sector_size & (sector_size - 1)) != 0) {
+                printf("sector size must be a power of two of at least %d bytes\n", WORD_SIZE);
+                return 1;
+            }
+            output_config.traffic = 1;
+        } else if(strcmp(argv[i], "--format") == 0) {
+            //If result format flag
+            i++;
+            if(strcmp(argv[i], "text") == 0) {
+                output_config.format = OUTPUT_TEXT;
+            } else if(strcmp(argv[i], "csv") == 0) {
+                output_config.format = OUTPUT_CSV;
+            } else if(strcmp(argv[i], "json") == 0) {
+                output_config.format = OUTPUT_JSON;
+            } else {
+                printf("format must be text, csv, or json\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--no-dump") == 0) {
+            //If the cache and memory dump should be left out
+            output_config.dump = 0;
+        } else if(strcmp(argv[i], "--mem-window") == 0) {
+            //If memory window flag, given as <start>:<size> with the start in hex and the size in words
+            i++;
+            unsigned long long start;
+            long size;
+            char extra;
+            if(sscanf(argv[i], "%llx:%ld%c", &start, &size, &extra) != 2 || size < 0) {
+                printf("memory window must be <start>:<size> with <start> in hex and <size> in words\n");
+                return 1;
+            }
+            output_config.mem_start = (INT_TYPE) start;
+            output_config.mem_size = size;
+            if(check_output_config(output_config)) {
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--interval") == 0) {
+            //If interval statistics flag
+            i++;
+            if(parse_positive_flag(argv[i], &interval_length)) {
+                printf("interval length must be a positive integer\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--interval-out") == 0) {
+            //If interval statistics output flag
+            i++;
+            strcpy(interval_output, argv[i]);
+        } else if(strcmp(argv[i], "--interval-format") == 0) {
+            //If interval statistics format flag
+            i++;
+            if(strcmp(argv[i], "csv") == 0) {
+                interval_format = INTERVAL_FORMAT_CSV;
+            } else if(strcmp(argv[i], "bin") == 0) {
+                interval_format = INTERVAL_FORMAT_BINARY;
+            } else {
+                printf("interval format must be csv or bin\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--mem-image") == 0) {
+            //If main memory image flag
+            i++;
+            strcpy(mem_image, argv[i]);
+        } else if(strcmp(argv[i], "--dump-mem") == 0) {
+            //If main memory dump flag
+            i++;
+            strcpy(mem_dump, argv[i]);
+        } else if(strcmp(argv[i], "--checkpoint-every") == 0) {
+            //If checkpoint interval flag
+            i++;
+            if(parse_positive_flag(argv[i], &checkpoint_every)) {
+                printf("checkpoint interval must be a positive integer\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--checkpoint-file") == 0) {
+            //If checkpoint file flag
+            i++;
+            strcpy(checkpoint_file, argv[i]);
+        } else if(strcmp(argv[i], "--restore") == 0) {
+            //If restore flag
+            i++;
+            strcpy(restore, argv[i]);
+        } else if(strcmp(argv[i], "--gen") == 0) {
+            //If synthetic input flag
+            i++;
+            gen_config.pattern = gen_pattern_from_name(argv[i]);
+            if(gen_config.pattern < 0) {
+                printf("pattern must be seq, stride, uniform, zipf, chase, or conflict\n");
+                return 1;
+            }
+            generate = 1;
+        } else if(strcmp(argv[i], "--core") == 0) {
+            //If core trace flag
+            i++;
+            if(total_cores == MAX_CORES) {
+                printf("at most %d cores can be simulated\n", MAX_CORES);
+                return 1;
+            }
+            core_traces[total_cores++] = argv[i];
+        } else if(strcmp(argv[i], "--quantum") == 0) {
+            //If round-robin quantum flag
+            i++;
+            if(parse_positive_flag(argv[i], &quantum)) {
+                printf("quantum must be a positive integer\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--epoch") == 0) {
+            //If epoch length flag
+            i++;
+            if(parse_positive_flag(argv[i], &epoch_length)) {
+                printf("epoch length must be a positive integer\n");
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--threads") == 0) {
+            //If host thread flag
+            i++;
+            if(parse_positive_flag(argv[i], &threads) || threads > MAX_CORES) {
+                printf("threads must be a positive integer of at most %d\n", MAX_CORES);
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--workload") == 0) {
+            //If shared cache workload flag
+            i++;
+            if(workloads.total_workloads == MAX_WORKLOADS) {
+                printf("at most %d workloads can share the cache\n", MAX_WORKLOADS);
+                return 1;
+            }
+            workloads.traces[workloads.total_workloads++] = argv[i];
+        } else if(strcmp(argv[i], "--partition") == 0) {
+            //If way partition flag, a comma separated list of way counts
+            i++;
+            workloads.total_ways = 0;
+            char* cursor = argv[i];
+            while(workloads.total_ways < MAX_WORKLOADS) {
+                char* end;
+                long ways = strtol(cursor, &end, 10);
+                if(end == cursor || ways <= 0 || (*end != ',' && *end != '\0')) {
+                    printf("partition must be a comma separated list of positive way counts\n");
+                    return 1;
+                }
+                workloads.ways[workloads.total_ways++] = (int) ways;
+                if(*end == '\0') {
+                    break;
+                }
+                cursor = end + 1;
+            }
+        } else if(strcmp(argv[i], "--qos") == 0) {
+            //If set dueling flag
+            workloads.qos = 1;
+        } else if(strcmp(argv[i], "--solo") == 0) {
+            //If solo baseline flag
+            workloads.solo = 1;
+        } else if(strncmp(argv[i], "--gen-", 6) == 0) {
+            //If generator parameter flag
+            i++;
+            if(parse_gen_flag(argv[i - 1], argv[i], &gen_config)) {
+                return 1;
+            }
         }
     }
 
+    //Interval statistics go to their own stream
+    if(interval_length > 0 && interval_output[0] == '\0') {
+        printf("--interval needs an output file set with --interval-out\n");
+        return 1;
+    }
+
+    //The multi-core mode runs its own traces and only reports per core statistics
+    if(total_cores > 0 && (input[0] != '\0' || generate || sample_config.mode != SAMPLE_NONE
+            || shards_config.enabled || instrument[0] != '\0' || hot_top > 0 || interval_length > 0
+            || checkpoint_every > 0 || restore[0] != '\0')) {
+        printf("--core cannot be combined with -i, --gen, sampling, miss ratio curves, instrumentation, "
+               "intervals, or checkpoints\n");
+        return 1;
+    }
+
+    //The multi-programmed mode runs its own traces on one cache
+    if(workloads.total_workloads > 0 && (input[0] != '\0' || generate || total_cores > 0
+            || sample_config.mode != SAMPLE_NONE || shards_config.enabled || instrument[0] != '\0' || hot_top > 0
+            || interval_length > 0 || checkpoint_every > 0 || restore[0] != '\0')) {
+        printf("--workload cannot be combined with -i, --gen, --core, sampling, miss ratio curves, "
+               "instrumentation, intervals, or checkpoints\n");
+        return 1;
+    }
+    //Set sampling simulates whole sets picked by the plain index bits, which only the mod index keeps together
+    if(sample_config.mode == SAMPLE_SETS && cache_memory.index_function != INDEX_MODULO) {
+        printf("--sample-sets needs the mod index function\n");
+        return 1;
+    }
+    if(set_stats && total_cores > 0) {
+        printf("--set-stats cannot be combined with --core\n");
+        return 1;
+    }
+    //Translation keeps no state in snapshots and maps one address space, and sampling picks virtual addresses
+    if(tlb_levels > 0 && (total_cores > 0 || workloads.total_workloads > 0 || sample_config.mode != SAMPLE_NONE
+            || checkpoint_every > 0 || restore[0] != '\0')) {
+        printf("--tlb cannot be combined with --core, --workload, sampling, or checkpoints\n");
+        return 1;
+    }
+    //The instruction cache is a second cache of a single trace run, which has no place in the other modes
+    if(split && (total_cores > 0 || workloads.total_workloads > 0 || sample_config.mode != SAMPLE_NONE
+            || checkpoint_every > 0 || restore[0] != '\0' || tlb_levels > 0)) {
+        printf("--split cannot be combined with --core, --workload, sampling, checkpoints, or --tlb\n");
+        return 1;
+    }
+    //The DRAM keeps no state in snapshots and serves the misses of a single cache
+    if(dram_channels > 0 && (total_cores > 0 || workloads.total_workloads > 0 || sample_config.mode != SAMPLE_NONE
+            || checkpoint_every > 0 || restore[0] != '\0')) {
+        printf("--dram cannot be combined with --core, --workload, sampling, or checkpoints\n");
+        return 1;
+    }
+    if(dram_channels == 0 && dram_options) {
+        printf("--dram-policy and --dram-timing need a DRAM set with --dram\n");
+        return 1;
+    }
+    //The MSHRs time one stream of accesses, which the cores, workloads, and sampled windows are not
+    if(total_mshrs > 0 && (total_cores > 0 || workloads.total_workloads > 0 || sample_config.mode != SAMPLE_NONE
+            || checkpoint_every > 0 || restore[0] != '\0')) {
+        printf("--mshrs cannot be combined with --core, --workload, sampling, or checkpoints\n");
+        return 1;
+    }
+    if(total_mshrs == 0 && miss_latency_set) {
+        printf("--miss-latency needs a non-blocking cache set with --mshrs\n");
+        return 1;
+    }
+    if(sample_config.mode != SAMPLE_TIME && (sample_config.window != 0 || sample_config.warmup >= 0)) {
+        printf("--sample-window and --sample-warmup need time sampling set with --sample-period\n");
+        return 1;
+    }
+    if(tlb_levels == 0 && (page_size != 0 || page_alloc != PAGE_ALLOC_RANDOM)) {
+        printf("--page-size and --page-alloc need a TLB set with --tlb\n");
+        return 1;
+    }
+    if(workloads.total_ways > 0 && workloads.total_ways != workloads.total_workloads) {
+        printf("--partition needs one way count for each --workload\n");
+        return 1;
+    }
+    if(workloads.qos && workloads.total_ways == 0) {
+        printf("--qos needs a partition set with --partition\n");
+        return 1;
+    }
+
     //Verify that the file input is not empty
-    if(input[0] == '\0') {
+    if(input[0] == '\0' && !generate && total_cores == 0 && workloads.total_workloads == 0) {
         printf("File input is empty!\n");
         printf("Improper command line usage. Use the -h flag to see usage "
                "instructions.\n");
@@ -367,12 +1402,73 @@ int main(int argc, char *argv[]) {
     cache_memory.total_lines = cache_memory.size / cache_memory.line_size;
     cache_memory.words_per_line = cache_memory.line_size / WORD_SIZE;
 
+    //Sectors split a line, and every sector needs a bit in the sector masks of the line
+    if(sector_size > 0) {
+        if(sector_size > cache_memory.line_size || cache_memory.line_size / sector_size > MAX_SECTORS) {
+            printf("sector size must be at most the block size and split a block into at most %d sectors\n",
+                   MAX_SECTORS);
+            return 1;
+        }
+        cache_memory.words_per_sector = (int) sector_size / WORD_SIZE;
+    }
+
     //Print information on the main memory and cache setups
     printf("WORD SIZE: %d\n\n", WORD_SIZE);
     printf("MAIN MEMORY CONFIGURATION:\nSIZE: %d\nBLOCK SIZE: %d\nWORDS PER BLOCK: %d\n"
            "TOTAL BLOCKS: %d\n\n", MM_SIZE, MM_BLOCK_SIZE, MM_WORDS_PER_BLOCK, TOTAL_MM_BLOCKS);
     printf("CACHE MEMORY CONFIGURATION:\nSIZE: %d\nBLOCK SIZE: %d\nWORDS PER BLOCK: %d\n"
            "TOTAL BLOCKS: %d\nASSOCIATIVITY: %d\n\n", cache_memory.size, cache_memory.line_size, cache_memory.words_per_line, cache_memory.total_lines, cache_memory.associativity);
+    if(cache_memory.index_function != INDEX_MODULO) {
+        printf("INDEX FUNCTION: %s\n\n", index_function_name(cache_memory.index_function));
+    }
+    if(tlb_levels > 0) {
+        if(page_size == 0) {
+            page_size = PAGE_SIZE_SMALL;
+        }
+        printf("PAGE SIZE: %d\nTLB LEVELS: %d\n\n", page_size, tlb_levels);
+    }
+    if(dram_channels > 0) {
+        printf("DRAM CHANNELS: %d\nDRAM BANKS: %d\n\n", dram_channels, dram_banks);
+    }
+    if(total_mshrs > 0) {
+        printf("MSHRS: %d\nMISS LATENCY: %d\n\n", total_mshrs, miss_latency);
+    }
+    if(split) {
+        if(icache_geometry.size == 0) {
+            icache_geometry.size = cache_memory.size;
+            icache_geometry.line_size = cache_memory.line_size;
+            icache_geometry.associativity = cache_memory.associativity;
+        }
+        icache_geometry.total_lines = icache_geometry.size / icache_geometry.line_size;
+        icache_geometry.words_per_line = icache_geometry.line_size / WORD_SIZE;
+        icache_geometry.index_function = cache_memory.index_function;
+        printf("INSTRUCTION CACHE CONFIGURATION:\nSIZE: %d\nBLOCK SIZE: %d\nWORDS PER BLOCK: %d\n"
+               "TOTAL BLOCKS: %d\nASSOCIATIVITY: %d\n\n", icache_geometry.size, icache_geometry.line_size,
+               icache_geometry.words_per_line, icache_geometry.total_lines, icache_geometry.associativity);
+    }
+    if(sector_size > 0) {
+        printf("SECTOR SIZE: %ld\nSECTORS PER BLOCK: %ld\n\n", sector_size, cache_memory.line_size / sector_size);
+    }
+
+    if(total_cores > 0) {
+        printf("CORES: %d\n", total_cores);
+        for(int i = 0; i < total_cores; i++) {
+            printf("CORE %d INPUT: %s\n", i, core_traces[i]);
+        }
+        printf("\n");
+        return simulate_cores(cache_memory, core_traces, total_cores, quantum, epoch_length, (int) threads,
+                              output, mem_image, mem_dump);
+    }
+
+    if(workloads.total_workloads > 0) {
+        printf("WORKLOADS: %d\n", workloads.total_workloads);
+        for(int i = 0; i < workloads.total_workloads; i++) {
+            printf("WORKLOAD %d INPUT: %s\n", i, workloads.traces[i]);
+        }
+        printf("\n");
+        return simulate_workloads(cache_memory, &workloads, quantum, set_stats, output, output_config, mem_image,
+                                  mem_dump);
+    }
 
     //Zero out stats
     struct cache_stats stats = zero_stats();
@@ -381,8 +1477,28 @@ int main(int argc, char *argv[]) {
     struct main_mem_block* main_memory = init_main_mem();
     cache_memory = init_cache_mem(cache_memory);
 
+    //Replace the initial main memory contents with the image
+    if(mem_image[0] != '\0' && load_mem_image(main_memory, mem_image)) {
+        free_io(cache_memory, main_memory);
+        return 1;
+    }
+
+    //Checkpoints need to know which main memory blocks the cache has written back
+    struct mem_tracker tracker;
+    if(checkpoint_every > 0) {
+        if(init_mem_tracker(&tracker)) {
+            free_io(cache_memory, main_memory);
+            return 1;
+        }
+        cache_memory.tracker = &tracker;
+    }
+
     //Print info on input file, output file, and the current directory
-    printf("INPUT: %s\n", input);
+    if(generate) {
+        printf("INPUT: %s generator\n", gen_pattern_name(gen_config.pattern));
+    } else {
+        printf("INPUT: %s\n", input);
+    }
     if(output[0] == '\0') {
         printf("File output is empty!\n");
     } else {
@@ -392,27 +1508,259 @@ int main(int argc, char *argv[]) {
         printf("CURR DIR: %s\n\n", cwd);
     }
 
-    //Trace the input file
-    int status = process_trace(input, &cache_memory, &stats, main_memory);
+    //Attach the optional analysis modes
+    struct trace_options options;
+    memset(&options, 0, sizeof(struct trace_options));
+    options.checkpoint_every = checkpoint_every;
+    options.checkpoint_file = checkpoint_file;
+
+    struct sampler sampler;
+    if(sample_config.mode != SAMPLE_NONE) {
+        if(init_sampler(&sampler, sample_config, cache_memory)) {
+            free_io(cache_memory, main_memory);
+            return 1;
+        }
+        options.sampler = &sampler;
+    }
+
+    struct shards shards;
+    if(shards_config.enabled) {
+        if(init_shards(&shards, shards_config, cache_memory)) {
+            if(options.sampler) {
+                free_sampler(options.sampler);
+            }
+            free_io(cache_memory, main_memory);
+            return 1;
+        }
+        options.shards = &shards;
+    }
+
+#ifdef CACHE_SIM_INSTRUMENT
+    struct cache_instr instr;
+    if(instrument[0] != '\0') {
+        if(init_cache_instr(&instr, cache_memory)) {
+            if(options.sampler) {
+                free_sampler(options.sampler);
+            }
+            if(options.shards) {
+                free_shards(options.shards);
+            }
+            free_io(cache_memory, main_memory);
+            return 1;
+        }
+        cache_memory.instr = &instr;
+    }
+
+    struct hot_tracker hot;
+    if(hot_top > 0) {
+        //Keep many more counters than reported so the reported counts are close to exact
+        if(hot_counters < hot_top) {
+            hot_counters = hot_top * 16 > 4096 ? hot_top * 16 : 4096;
+        }
+        if(init_hot_tracker(&hot, cache_memory, (int) hot_top, hot_counters)
+                || (region_map[0] != '\0' && load_region_map(&hot, region_map))) {
+            if(cache_memory.instr) {
+                free_cache_instr(cache_memory.instr);
+            }
+            free_hot_tracker(&hot);
+            if(options.sampler) {
+                free_sampler(options.sampler);
+            }
+            if(options.shards) {
+                free_shards(options.shards);
+            }
+            free_io(cache_memory, main_memory);
+            return 1;
+        }
+        cache_memory.hot = &hot;
+    }
+#endif
+
+    struct interval_stream intervals;
+    if(interval_length > 0) {
+        if(open_interval_stream(&intervals, interval_output, interval_format, interval_length)) {
+            if(options.sampler) {
+                free_sampler(options.sampler);
+            }
+            if(options.shards) {
+                free_shards(options.shards);
+            }
+#ifdef CACHE_SIM_INSTRUMENT
+            if(cache_memory.instr) {
+                free_cache_instr(cache_memory.instr);
+            }
+            if(cache_memory.hot) {
+                free_hot_tracker(cache_memory.hot);
+            }
+#endif
+            free_io(cache_memory, main_memory);
+            return 1;
+        }
+        options.intervals = &intervals;
+    }
+
+    //The per-set counters are attached last so that only the final cleanup has to free them, if they cannot
+    //be allocated the error is reported and the run goes on without them
+    struct set_occupancy occupancy;
+    if(set_stats && init_set_occupancy(&occupancy, cache_memory) == 0) {
+        cache_memory.occupancy = &occupancy;
+    }
+
+    //The translation stage is attached next, but unlike the counters the run cannot go on without it
+    int status = 0;
+    struct translation translation;
+    if(tlb_levels > 0) {
+        if(init_translation(&translation, cache_memory, page_size, page_alloc, tlb_entries, tlb_ways, tlb_levels)) {
+            status = 1;
+        } else {
+            cache_memory.translation = &translation;
+        }
+    }
+    struct instruction_cache icache;
+    if(split) {
+        icache.cache_mem = init_cache_mem(icache_geometry);
+        icache.stats = zero_stats();
+        cache_memory.icache = &icache;
+    }
+    //The DRAM sits behind both caches of a split cache
+    struct dram dram;
+    if(dram_channels > 0) {
+        if(init_dram(&dram, dram_channels, dram_banks, dram_policy, dram_timing[0], dram_timing[1], dram_timing[2])) {
+            status = 1;
+        } else {
+            cache_memory.dram = &dram;
+            if(split) {
+                icache.cache_mem.dram = &dram;
+            }
+        }
+    }
+    //The instruction cache of a split cache shares the MSHRs, so fetches and data misses overlap in one clock
+    struct mshr_file mshrs;
+    if(total_mshrs > 0) {
+        if(init_mshr_file(&mshrs, total_mshrs, miss_latency)) {
+            status = 1;
+        } else {
+            cache_memory.mshrs = &mshrs;
+            if(split) {
+                icache.cache_mem.mshrs = &mshrs;
+            }
+        }
+    }
+
+    //Trace the input file or the generated trace
+    struct generator gen;
+    struct trace_reader reader;
+    memset(&reader, 0, sizeof(struct trace_reader));
+    if(status != 0 || (generate && init_generator(&gen, gen_config, cache_memory))) {
+        status = 1;
+    } else {
+        status = open_trace_input(input, generate ? &gen : NULL, &reader);
+        //A compressed trace is read through a pipe, which has no position to checkpoint or restore
+        if(status == 0 && reader.decompressor && (checkpoint_every > 0 || restore[0] != '\0')) {
+            printf("Error: Checkpoints need an uncompressed trace file\n");
+            status = 1;
+        }
+        if(status == 0 && restore[0] != '\0') {
+            //Continue from the snapshot, intervals are measured from the restored stats
+            if(restore_checkpoint(restore, &cache_memory, &stats, main_memory, &reader)) {
+                status = 1;
+            } else {
+                printf("Restored %s at record %ld\n", restore, reader.record_num);
+                if(options.intervals) {
+                    options.intervals->start = stats;
+                }
+            }
+        }
+        if(status == 0) {
+            status = process_trace(&reader, &cache_memory, &stats, main_memory, &options);
+        }
+        close_trace_reader(&reader);
+        if(generate) {
+            free_generator(&gen);
+        }
+    }
+
+    //Write the last partial interval and wait for the interval stream to reach the disk
+    if(options.intervals && close_interval_stream(options.intervals, stats) != 0 && status == 0) {
+        status = 5;
+    }
+
+    //Dump the whole of main memory, which now holds the written back cache contents
+    if(status == 0 && mem_dump[0] != '\0' && dump_mem_image(main_memory, mem_dump)) {
+        status = 5;
+    }
 
     //Verify the status from the trace
     if(status == 0) {
-        //If no output file was specified, just print to the screen
-        if(output[0] == '\0') {
-            printf("No output file: Just printing to screen\n\n");
+#ifdef CACHE_SIM_INSTRUMENT
+        //Export the instrumentation
+        if(cache_memory.instr) {
+            export_cache_instr(instrument, cache_memory.instr);
+        }
+#endif
+
+        //Format the results once for both the output file and the terminal
+        size_t results_length;
+        char* results = format_results(cache_memory, stats, main_memory, output_config, &results_length);
+        if(!results) {
+            printf("Error: Could not allocate memory for the results\n");
+            status = 5;
         } else {
-            //Output file specified, write output to file
-            write_cache_and_memory(output, cache_memory, stats, main_memory);
+            //If no output file was specified, just print to the screen
+            if(output[0] == '\0') {
+                printf("No output file: Just printing to screen\n\n");
+            } else {
+                //Output file specified, write output to file
+                FILE* output_file = fopen(output, "w");
+                if(!output_file) {
+                    printf("Error: Output file could not be created / opened!\n");
+                } else {
+                    fwrite(results, 1, results_length, output_file);
+                    //The reports of the analysis modes are text, keep CSV and JSON results parseable
+                    if(output_config.format == OUTPUT_TEXT) {
+                        print_reports(output_file, &options, cache_memory);
+                    }
+                    fclose(output_file);
+                }
+            }
+            //Print to the terminal, followed by the reports of the analysis modes
+            fflush(stdout);
+            fwrite(results, 1, results_length, stdout);
+            print_reports(stdout, &options, cache_memory);
+            free(results);
         }
-        //Print to the terminal
-        print_cache_and_memory(cache_memory, stats, main_memory);
-    } else {
-        //Trace failed, free memory and exit
-        free_io(cache_memory, main_memory);
-        return status;
     }
 
     //Free memory and exit
+    if(cache_memory.occupancy) {
+        free_set_occupancy(cache_memory.occupancy);
+    }
+    if(cache_memory.translation) {
+        free_translation(cache_memory.translation);
+    }
+    if(cache_memory.icache) {
+        free_cache_mem(cache_memory.icache->cache_mem);
+    }
+    if(cache_memory.dram) {
+        free_dram(cache_memory.dram);
+    }
+    if(cache_memory.mshrs) {
+        free_mshr_file(cache_memory.mshrs);
+    }
+    if(options.sampler) {
+        free_sampler(options.sampler);
+    }
+    if(options.shards) {
+        free_shards(options.shards);
+    }
+#ifdef CACHE_SIM_INSTRUMENT
+    if(cache_memory.instr) {
+        free_cache_instr(cache_memory.instr);
+    }
+    if(cache_memory.hot) {
+        free_hot_tracker(cache_memory.hot);
+    }
+#endif
     free_io(cache_memory, main_memory);
-    return 0;
+    return status;
 }
\ No newline at end of file
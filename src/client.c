@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+//OS Specific Libraries
+#ifdef _WIN32
+// Windows-specific code
+#include <limits.h>
+#elif __linux__
+// Linux-specific code
+#include <limits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#elif __APPLE__
+// MacOS-specific code
+#include <sys/syslimits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "lib/headers/server.h"
+//
+// Command line client for the simulator server
+//
+
+#ifndef _WIN32
+//Function to send a command and print the reply of the server, returns non-zero if the server answered ERR
+//or the connection was lost
+static int exchange(FILE* in, FILE* out, char* command, char** reply, size_t* reply_len) {
+    if(command) {
+        fprintf(out, "%s\n", command);
+    }
+    fflush(out);
+
+    if(getline(reply, reply_len, in) == -1) {
+        printf("Error: The server closed the connection\n");
+        return 1;
+    }
+    printf("%s", *reply);
+
+    return strncmp(*reply, "OK", 2) != 0;
+}
+
+//Function to stream the lines of a local trace file to the server as a RECORDS command
+static int send_records(FILE* in, FILE* out, char* path, char** reply, size_t* reply_len) {
+    FILE* trace_file = fopen(path, "r");
+    if(!trace_file) {
+        printf("Error: Input file could not be read!\n");
+        return 1;
+    }
+
+    fprintf(out, "RECORDS\n");
+    char* line = NULL;
+    size_t len = 0;
+    long read;
+    while((read = getline(&line, &len, trace_file)) != -1) {
+        fwrite(line, 1, read, out);
+        //The last line of a trace may come without a line ending
+        if(read > 0 && line[read - 1] != '\n') {
+            fputc('\n', out);
+        }
+    }
+    fprintf(out, "%s\n", SERVER_RECORDS_END);
+
+    free(line);
+    fclose(trace_file);
+    return exchange(in, out, NULL, reply, reply_len);
+}
+#endif
+
+//Client entry point
+int main(int argc, char *argv[]) {
+    if(argc < 3 || strcmp(argv[1], "-h") == 0) {
+        printf("Usage information:\ncache_sim_client <socket> <command> [<command> ...]\n\n");
+        printf("Commands are sent in order over one connection:\n"
+               "config <capacity> <blocksize> <associativity> rebuild the cache of the server\n"
+               "reset empty the cache, restore main memory, and zero the stats\n"
+               "trace <file> simulate a trace file, read by the server\n"
+               "records <file> simulate a trace file, read by the client and sent over the socket\n"
+               "flush write the cache contents back to main memory\n"
+               "stats print the statistics since the last reset\n"
+               "shutdown stop the server\n\n");
+        printf("Example: ./cache_sim_client /tmp/cache_sim.sock config 8 16 4 trace mem.trace stats\n");
+        return argc < 3;
+    }
+
+#ifdef _WIN32
+    printf("Error: The client is not available on Windows\n");
+    return 1;
+#else
+    struct sockaddr_un address;
+    if(strlen(argv[1]) >= sizeof(address.sun_path)) {
+        printf("Error: Socket path is too long\n");
+        return 1;
+    }
+    memset(&address, 0, sizeof(struct sockaddr_un));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, argv[1]);
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server < 0 || connect(server, (struct sockaddr*) &address, sizeof(struct sockaddr_un)) != 0) {
+        printf("Error: Could not connect to %s\n", argv[1]);
+        if(server >= 0) {
+            close(server);
+        }
+        return 1;
+    }
+    FILE* in = fdopen(server, "r");
+    FILE* out = fdopen(dup(server), "w");
+
+    char* reply = NULL;
+    size_t reply_len = 0;
+    char command[PATH_MAX + 16];
+    int status = 0;
+
+    for(int i = 2; i < argc && status == 0; i++) {
+        if(strcmp(argv[i], "config") == 0 && i + 3 < argc) {
+            snprintf(command, sizeof(command), "CONFIG %s %s %s", argv[i + 1], argv[i + 2], argv[i + 3]);
+            i += 3;
+            status = exchange(in, out, command, &reply, &reply_len);
+        } else if(strcmp(argv[i], "trace") == 0 && i + 1 < argc) {
+            //The server may run in another directory, so send the full path
+            char path[PATH_MAX];
+            i++;
+            if(!realpath(argv[i], path)) {
+                printf("Error: Input file could not be found!\n");
+                status = 1;
+            } else {
+                snprintf(command, sizeof(command), "TRACE %s", path);
+                status = exchange(in, out, command, &reply, &reply_len);
+            }
+        } else if(strcmp(argv[i], "records") == 0 && i + 1 < argc) {
+            i++;
+            status = send_records(in, out, argv[i], &reply, &reply_len);
+        } else if(strcmp(argv[i], "reset") == 0 || strcmp(argv[i], "flush") == 0
+                  || strcmp(argv[i], "stats") == 0 || strcmp(argv[i], "shutdown") == 0) {
+            snprintf(command, sizeof(command), "%s", argv[i]);
+            for(int j = 0; command[j] != '\0'; j++) {
+                command[j] = (char) toupper(command[j]);
+            }
+            status = exchange(in, out, command, &reply, &reply_len);
+        } else {
+            printf("Unknown or incomplete command %s. Use the -h flag to see usage instructions.\n", argv[i]);
+            status = 1;
+        }
+    }
+
+    //Closing the connection is enough for the server to move on to the next client
+    free(reply);
+    fclose(in);
+    fclose(out);
+    return status;
+#endif
+}
@@ -0,0 +1,77 @@
+//
+// Batch runner for job files of traces and cache configs, run on a pool of host threads with the results
+// kept in a local cache keyed by the trace contents and the config
+//
+
+#ifndef CACHE_SIM_BATCH_H
+#define CACHE_SIM_BATCH_H
+#include <pthread.h>
+#include "io.h"
+#include "output.h"
+#include "session.h"
+#include "trace.h"
+
+//Defining the largest number of host threads and the default directory of the result cache
+#define BATCH_MAX_THREADS 64
+#define BATCH_CACHE_DIR ".cache_sim_results"
+
+//Defining the version of the cached results, raised whenever the simulator changes its results so that
+//results of an older simulator are not used
+#define BATCH_CACHE_VERSION 1
+
+//Defining the states of a job
+#define BATCH_JOB_PENDING 0
+#define BATCH_JOB_SIMULATED 1
+#define BATCH_JOB_CACHED 2
+#define BATCH_JOB_REPEATED 3
+#define BATCH_JOB_FAILED 4
+
+//Job files hold one job per line, a trace followed by the options of the job:
+//  <trace> -c <capacity> -b <blocksize> -a <associativity> [--index <function>] [--sector <bytes>]
+//          [--format text|csv|json] [--no-dump] [--mem-window <start>:<size>] [-o <output_file>]
+//Blank lines and lines starting with # are skipped, jobs without an output file are printed in job order
+
+//Data structure to house a trace used by the jobs, parsed once and only read by the jobs
+struct batch_trace {
+    char* name;
+    unsigned long long hash;
+    bool needed;
+    int status;
+    struct trace trace;
+};
+
+//Data structure to house a job of a batch and its results
+struct batch_job {
+    int line_num;
+    int trace;
+    struct session_config config;
+    struct output_config output;
+    char* output_name;
+
+    //Config as the canonical text the cache key is made from, and the job it repeats if any
+    char key[256];
+    int same_as;
+
+    int status;
+    char* results;
+    size_t length;
+    double msec;
+};
+
+//Data structure to house a batch of jobs and the queue the host threads take them from
+struct batch {
+    struct batch_job* jobs;
+    int total_jobs;
+    struct batch_trace* traces;
+    int total_traces;
+
+    char* cache_dir;
+    int threads;
+
+    int next_job;
+    pthread_mutex_t lock;
+};
+
+int run_batch(char* job_file, int threads, char* cache_dir);
+
+#endif //CACHE_SIM_BATCH_H
@@ -0,0 +1,67 @@
+//
+// Checkpoint and restore of the full simulator state
+//
+
+#ifndef CACHE_SIM_CHECKPOINT_H
+#define CACHE_SIM_CHECKPOINT_H
+#include "io.h"
+#include "trace.h"
+
+//Defining the snapshot header magic and version
+#define CHECKPOINT_MAGIC "CSCK"
+#define CHECKPOINT_VERSION 4
+
+//Defining the trace source of a generated trace, text and binary traces use their TRACE_FORMAT value
+#define CHECKPOINT_SOURCE_GENERATOR 2
+
+//Data structure to house the snapshot header. A snapshot is laid out so that it can be used straight from
+//a read-only mapping: the header, one checkpoint_line per cache line, the words of every cache line, the
+//indices of the main memory blocks written back so far, and the words of those blocks. Snapshots are
+//only read by builds with the same word size and structure layout, which the header records
+struct checkpoint_header {
+    char magic[4];
+    unsigned int version;
+    unsigned int header_size;
+    unsigned int word_size;
+    unsigned int source;
+
+    int size;
+    int line_size;
+    int associativity;
+    int total_lines;
+    int words_per_line;
+    int pc;
+    int index_function;
+    int words_per_sector;
+
+    struct cache_stats stats;
+
+    //Trace position: records consumed, and the byte offset of the next record in a trace file or the
+    //state of the generator
+    long long records;
+    long long offset;
+    unsigned long long gen_state;
+    long long gen_produced;
+    long long gen_position;
+
+    long long memory_blocks;
+};
+
+//Data structure to house the state of a single cache line in a snapshot
+struct checkpoint_line {
+    unsigned long long tag;
+    unsigned long long valid_sectors;
+    unsigned long long dirty_sectors;
+    int last_pc;
+    unsigned char loaded;
+    unsigned char valid;
+    unsigned char dirty;
+    unsigned char padding;
+};
+
+int write_checkpoint(char* path, struct cache* cache_mem, struct cache_stats stats,
+                     struct main_mem_block* main_mem, struct trace_reader* reader);
+int restore_checkpoint(char* path, struct cache* cache_mem, struct cache_stats* stats,
+                       struct main_mem_block* main_mem, struct trace_reader* reader);
+
+#endif //CACHE_SIM_CHECKPOINT_H
@@ -0,0 +1,93 @@
+//
+// Multi-core simulation with private caches kept coherent by a snooping MESI protocol
+//
+
+#ifndef CACHE_SIM_COHERENCE_H
+#define CACHE_SIM_COHERENCE_H
+#include <pthread.h>
+#include "io.h"
+#include "trace.h"
+
+//Defining the MESI line states
+#define MESI_INVALID 0
+#define MESI_SHARED 1
+#define MESI_EXCLUSIVE 2
+#define MESI_MODIFIED 3
+
+//Defining the largest number of cores
+#define MAX_CORES 64
+
+//Data structure to house a hash map from block numbers to a small value, used for the blocks a core lost to
+//invalidations and for the blocks touched during an epoch
+struct block_map {
+    unsigned long long* keys;
+    int* values;
+    long capacity;
+    long count;
+};
+
+//Data structure to house the coherence counters of a single core
+struct coherence_stats {
+    //Bus transactions issued by the core
+    long bus_reads;
+    long bus_read_exclusives;
+    long bus_upgrades;
+
+    //Invalidations the core caused in other caches and suffered from other cores
+    long invalidations_sent;
+    long invalidations_received;
+    //Modified lines the core had to write back because another core read them
+    long interventions;
+
+    //Misses on blocks last lost to an invalidation, split by whether the missing word is the one whose
+    //write caused the invalidation
+    long coherence_misses;
+    long true_sharing_misses;
+    long false_sharing_misses;
+};
+
+//Data structure to house a core with its private cache and trace
+struct mesi_core {
+    struct cache cache_mem;
+    struct cache_stats stats;
+    struct coherence_stats coherence;
+    unsigned char* states;
+
+    struct trace_reader reader;
+    char* trace_name;
+    bool done;
+
+    //Blocks invalidated by other cores, mapped to the word whose write invalidated them
+    struct block_map invalidated;
+
+    //Records of the current epoch
+    struct trace_record* buffer;
+    long buffered;
+};
+
+//Data structure to house a multi-core simulation
+struct multicore {
+    int total_cores;
+    struct mesi_core* cores;
+    struct main_mem_block* main_mem;
+    int word_shift;
+
+    //Cores take turns of quantum records, every epoch hands each core epoch_length records
+    long quantum;
+    long epoch_length;
+    int threads;
+
+    //Owner of every block touched during an epoch, used to find epochs the cores can run in parallel
+    struct block_map epoch_owner;
+    long parallel_epochs;
+    long serial_epochs;
+};
+
+int init_multicore(struct multicore* mc, struct cache geometry, char** traces, int total_cores,
+                   struct main_mem_block* main_mem, long quantum, long epoch_length, int threads);
+void free_multicore(struct multicore* mc);
+
+int run_multicore(struct multicore* mc);
+void print_multicore_report(FILE* out, struct multicore* mc);
+
+#endif //CACHE_SIM_COHERENCE_H
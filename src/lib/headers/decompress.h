@@ -0,0 +1,40 @@
+//
+// Compressed trace input, decompressed on a helper thread into a pipe the trace parser reads from
+//
+
+#ifndef CACHE_SIM_DECOMPRESS_H
+#define CACHE_SIM_DECOMPRESS_H
+#include <pthread.h>
+#include "io.h"
+
+//Defining the compression formats of a trace file, told apart by their magic numbers
+#define COMPRESS_NONE 0
+#define COMPRESS_GZIP 1
+#define COMPRESS_ZSTD 2
+
+//Defining the size of the chunks read from the compressed file and handed to the parser
+#define DECOMPRESS_CHUNK_SIZE 65536
+
+//Data structure to house the helper thread decompressing a trace. The thread writes the decompressed
+//chunks into a pipe, so the parser reads them through a plain stream and memory use stays at one chunk
+//each way no matter how large the trace is
+struct decompressor {
+    int format;
+    FILE* in;
+
+    //Bytes already read from the file to recognize the format, passed to the decoder first
+    unsigned char magic[4];
+    size_t magic_size;
+
+    int out_fd;
+    pthread_t thread;
+    bool failed;
+};
+
+int compression_format(unsigned char* magic, size_t size);
+char* compression_name(int format);
+int start_decompressor(struct decompressor* decompressor, FILE* in, unsigned char* magic, size_t magic_size,
+                       FILE** out);
+int finish_decompressor(struct decompressor* decompressor);
+
+#endif //CACHE_SIM_DECOMPRESS_H
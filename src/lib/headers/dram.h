@@ -0,0 +1,68 @@
+//
+// DRAM back end behind a cache, timing the line fills and write-backs with a row buffer per bank
+//
+
+#ifndef CACHE_SIM_DRAM_H
+#define CACHE_SIM_DRAM_H
+#include "io.h"
+
+//Defining the largest number of channels and banks per channel
+#define DRAM_MAX_CHANNELS 8
+#define DRAM_MAX_BANKS 32
+
+//Defining the row size in bytes, and the bytes and cycles of one burst on the data bus
+#define DRAM_ROW_SIZE 8192
+#define DRAM_BURST_BYTES 64
+#define DRAM_BURST_CYCLES 4
+
+//Defining the default timings in memory cycles: column access, row activation, and precharge
+#define DRAM_DEFAULT_CAS 16
+#define DRAM_DEFAULT_RCD 16
+#define DRAM_DEFAULT_RP 16
+
+//Defining the page policies: rows stay open until another row of the bank is needed, or every access
+//closes its row again
+#define DRAM_PAGE_OPEN 0
+#define DRAM_PAGE_CLOSED 1
+
+//Defining the row buffer outcomes of a request: the row is open, the bank has no row open, or another row
+//is open and has to be closed first
+#define DRAM_ROW_HIT 0
+#define DRAM_ROW_MISS 1
+#define DRAM_ROW_CONFLICT 2
+#define DRAM_OUTCOMES 3
+
+//Data structure to house the counts of the read or the write requests
+struct dram_counts {
+    long requests;
+    long outcomes[DRAM_OUTCOMES];
+    long bytes;
+    long long cycles;
+};
+
+//Data structure to house the DRAM behind a cache. Byte addresses map to row, bank, channel, and column
+//from the top bits down, so that a line never spans two rows and consecutive rows go to other channels
+struct dram {
+    int channels;
+    int banks;
+    int policy;
+    int t_cas;
+    int t_rcd;
+    int t_rp;
+
+    //Open row of every bank, channel by channel, -1 while the bank is precharged
+    long* open_rows;
+    long* bank_requests;
+    long* bank_hits;
+
+    struct dram_counts reads;
+    struct dram_counts writes;
+};
+
+int init_dram(struct dram* dram, int channels, int banks, int policy, int t_cas, int t_rcd, int t_rp);
+void free_dram(struct dram* dram);
+
+long dram_access(struct dram* dram, INT_TYPE addr, int bytes, bool write);
+void print_dram_report(FILE* out, struct dram* dram);
+
+#endif //CACHE_SIM_DRAM_H
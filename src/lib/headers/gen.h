@@ -0,0 +1,68 @@
+//
+// Seeded synthetic trace generation for scaling and stress benchmarks
+//
+
+#ifndef CACHE_SIM_GEN_H
+#define CACHE_SIM_GEN_H
+#include "io.h"
+#include "trace.h"
+
+//Defining the access patterns
+#define GEN_SEQUENTIAL 0
+#define GEN_STRIDED 1
+#define GEN_UNIFORM 2
+#define GEN_ZIPF 3
+#define GEN_CHASE 4
+#define GEN_CONFLICT 5
+#define GEN_PATTERNS 6
+
+//Data structure to house the user supplied generator parameters
+struct gen_config {
+    int pattern;
+    long length;
+    unsigned long long seed;
+    //Percentage of the accesses that are writes
+    int write_percent;
+
+    //Word addresses are generated in [base, base + footprint) and clamped to main memory
+    INT_TYPE base;
+    long footprint;
+    //Distance in words between strided accesses and between pointer chasing nodes
+    long stride;
+    //Zipf exponent of the hot-set pattern, between 0 and 1
+    double zipf_exponent;
+    //Lines cycled through by the conflict pattern, 0 for one more than the associativity
+    long conflict_lines;
+};
+
+//Data structure to house the state of a generator
+struct generator {
+    struct gen_config config;
+    unsigned long long state;
+    long produced;
+    long position;
+
+    //Conflict pattern geometry
+    long conflict_stride;
+
+    //Pointer chasing successor of every node, a single random cycle over all nodes
+    unsigned int* chase;
+    long chase_nodes;
+
+    //Zipf constants, computed once for the footprint
+    double zeta_n;
+    double zipf_alpha;
+    double zipf_eta;
+    double zipf_half;
+};
+
+struct gen_config zero_gen_config();
+int gen_pattern_from_name(char* name);
+const char* gen_pattern_name(int pattern);
+
+int init_generator(struct generator* gen, struct gen_config config, struct cache cache_mem);
+void free_generator(struct generator* gen);
+
+int gen_next(struct generator* gen, struct trace_record* record);
+
+#endif //CACHE_SIM_GEN_H
@@ -0,0 +1,76 @@
+//
+// Hot address and region attribution of misses and dirty evictions
+//
+
+#ifndef CACHE_SIM_HOT_H
+#define CACHE_SIM_HOT_H
+#include "io.h"
+
+//Defining the longest region name kept from a region map file
+#define REGION_NAME_SIZE 64
+
+//Data structure to house a single Space-Saving counter
+struct ss_counter {
+    INT_TYPE key;
+    long count;
+    //Upper bound on how much of count was inherited from the key it replaced
+    long error;
+    long table_index;
+};
+
+//Data structure to house a Space-Saving heavy hitters summary. A min heap of counters keyed by count,
+//with a hash table from key to heap position, so every update is O(log capacity)
+struct space_saving {
+    long capacity;
+    long size;
+    struct ss_counter* heap;
+
+    long table_size;
+    INT_TYPE* table_keys;
+    long* table_heap;
+};
+
+//Data structure to house a user defined address range
+struct hot_region {
+    char name[REGION_NAME_SIZE];
+    INT_TYPE start;
+    INT_TYPE end;
+
+    long misses;
+    long dirty_evictions;
+};
+
+//Data structure to house all hot address tracking state of a cache
+struct hot_tracker {
+    int top;
+    int word_shift;
+    int total_sets;
+
+    //Geometry and index function of the cache, so that hot lines decode to the sets the cache counts them in
+    struct cache geometry;
+
+    struct space_saving line_misses;
+    struct space_saving line_dirty_evictions;
+    long* set_misses;
+
+    //Regions sorted by start address, misses outside every region are counted separately
+    long total_regions;
+    struct hot_region* regions;
+    long unmapped_misses;
+    long unmapped_dirty_evictions;
+};
+
+int init_space_saving(struct space_saving* summary, long capacity);
+void free_space_saving(struct space_saving* summary);
+void space_saving_add(struct space_saving* summary, INT_TYPE key);
+
+int init_hot_tracker(struct hot_tracker* hot, struct cache cache_mem, int top, long counters);
+int load_region_map(struct hot_tracker* hot, char* path);
+void free_hot_tracker(struct hot_tracker* hot);
+
+void hot_record_miss(struct hot_tracker* hot, INT_TYPE addr, INT_TYPE set);
+void hot_record_dirty_eviction(struct hot_tracker* hot, INT_TYPE addr);
+
+void print_hot_report(FILE* out, struct hot_tracker* hot);
+
+#endif //CACHE_SIM_HOT_H
@@ -0,0 +1,54 @@
+//
+// Optional cache instrumentation: reuse distances, per-set counters, and 3C miss classification
+//
+
+#ifndef CACHE_SIM_INSTRUMENT_H
+#define CACHE_SIM_INSTRUMENT_H
+#include "io.h"
+#include "lru_stack.h"
+
+//Defining the number of log2 reuse distance buckets, bucket 0 holds distance 0 and bucket k holds
+//distances from 2^(k-1) up to 2^k - 1
+#define INSTR_DISTANCE_BUCKETS 33
+
+//Defining the export formats
+#define INSTR_FORMAT_CSV 0
+#define INSTR_FORMAT_JSON 1
+
+//Data structure to house the counters of a single cache set
+struct set_counters {
+    long accesses;
+    long misses;
+    long evictions;
+    long dirty_evictions;
+    long conflict_misses;
+};
+
+//Data structure to house all instrumentation state of a cache
+struct cache_instr {
+    int word_shift;
+    int total_lines;
+    int total_sets;
+
+    //Fully associative LRU shadow of the cache, used for the reuse distances and the 3C classification
+    struct lru_stack shadow;
+
+    long cold_accesses;
+    long distances[INSTR_DISTANCE_BUCKETS];
+
+    long compulsory_misses;
+    long capacity_misses;
+    long conflict_misses;
+
+    struct set_counters* sets;
+};
+
+int init_cache_instr(struct cache_instr* instr, struct cache cache_mem);
+void free_cache_instr(struct cache_instr* instr);
+
+void instr_record(struct cache_instr* instr, INT_TYPE addr, INT_TYPE set, bool hit, int load_status);
+
+void print_instr_summary(FILE* out, struct cache_instr* instr);
+int export_cache_instr(char* path, struct cache_instr* instr);
+
+#endif //CACHE_SIM_INSTRUMENT_H
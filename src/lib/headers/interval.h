@@ -0,0 +1,48 @@
+//
+// Interval statistics streaming for phase analysis
+//
+
+#ifndef CACHE_SIM_INTERVAL_H
+#define CACHE_SIM_INTERVAL_H
+#include "io.h"
+#include "stream_writer.h"
+
+//Defining the interval output formats
+#define INTERVAL_FORMAT_CSV 0
+#define INTERVAL_FORMAT_BINARY 1
+
+//Defining the binary interval stream header, followed by one record of INTERVAL_BINARY_FIELDS little
+//endian 64-bit integers per interval: first access, accesses, reads, writes, read misses, write misses,
+//evictions, and dirty evictions
+#define INTERVAL_BINARY_MAGIC "CSIV"
+#define INTERVAL_BINARY_VERSION 1
+#define INTERVAL_BINARY_FIELDS 8
+
+//Data structure to house the state of an interval stream
+struct interval_stream {
+    long length;
+    int format;
+
+    //Accesses left until the current interval is complete
+    long remaining;
+    long index;
+
+    //Stats at the start of the current interval
+    struct cache_stats start;
+
+    struct stream_writer writer;
+};
+
+int open_interval_stream(struct interval_stream* stream, char* path, int format, long length);
+int close_interval_stream(struct interval_stream* stream, struct cache_stats stats);
+
+void interval_emit(struct interval_stream* stream, struct cache_stats stats);
+
+//Function to count one access towards the current interval, emitting a record once it is complete
+static inline void interval_tick(struct interval_stream* stream, struct cache_stats stats) {
+    if(--stream->remaining == 0) {
+        interval_emit(stream, stats);
+    }
+}
+
+#endif //CACHE_SIM_INTERVAL_H
@@ -11,9 +11,20 @@
 #include <string.h>
 #include <stdbool.h>
 
-//Defining cache read and write values
+//Defining the largest number of sectors in a cache line, one bit each in the sector masks
+#define MAX_SECTORS 64
+
+//Defining cache read and write values, and the instruction fetch of the extended trace format
 #define CACHE_READ 0
 #define CACHE_WRITE 1
+#define CACHE_FETCH 2
+
+//Defining the set index functions: the address bits above the word, those bits folded with the tag by XOR,
+//the line number modulo the largest prime number of sets, and a different tag hash for every way
+#define INDEX_MODULO 0
+#define INDEX_XOR 1
+#define INDEX_PRIME 2
+#define INDEX_SKEW 3
 
 //Defining the start address and size of main memory to print
 #define MAIN_MEMORY_START_PRINT 0x003f7f00
@@ -78,9 +89,50 @@ struct cache_mem_block {
     bool dirty;
     int last_pc;
 
+    //Sectors of the line filled from main memory and sectors written since, one bit per sector
+    unsigned long long valid_sectors;
+    unsigned long long dirty_sectors;
+
     INT_TYPE* words;
 };
 
+//Optional instrumentation attached to a cache, only used when built with CACHE_SIM_INSTRUMENT
+struct cache_instr;
+struct hot_tracker;
+
+//Optional way partition of a cache shared by several workloads
+struct way_partition;
+
+//Optional per-set fill and eviction counters
+struct set_occupancy;
+
+//Optional virtual to physical translation in front of a cache
+struct translation;
+
+//Optional instruction cache of a split cache, which takes the instruction fetches
+struct instruction_cache;
+
+//Optional DRAM timing model behind a cache, which takes the fills and write-backs
+struct dram;
+
+//Optional MSHRs of a non-blocking cache, which time the misses in flight
+struct mshr_file;
+
+//Data structure to house the main memory blocks written back by a cache, so that main memory can be
+//restored without touching the blocks that still hold their initial values
+struct mem_tracker {
+    bool* written;
+    INT_TYPE* blocks;
+    long count;
+};
+
+//Data structure to house the tag, set, and word information for an address
+struct address_info {
+    INT_TYPE tag;
+    INT_TYPE set;
+    INT_TYPE word;
+};
+
 //Data structure which contains all info for the cache itself
 struct cache {
     int size;
@@ -91,7 +143,33 @@ struct cache {
     int total_sets;
     int pc;
 
+    //Set index function, the number of set index bits, and the number of sets used by prime indexing
+    int index_function;
+    int index_bits;
+    INT_TYPE index_prime;
+
+    //Words per sector and sectors per line, a miss only fills the sector of the address
+    int words_per_sector;
+    int sectors_per_line;
+
+    //Line touched by the last access, its block address and decoded address, valid until a tag changes, and
+    //the most recently used way of every set, both checked before the ways of a set are scanned
+    bool last_valid;
+    INT_TYPE last_block;
+    INT_TYPE last_line;
+    struct address_info last_info;
+    unsigned char* mru_ways;
+
     struct cache_mem_block* lines;
+    struct cache_instr* instr;
+    struct hot_tracker* hot;
+    struct mem_tracker* tracker;
+    struct way_partition* partition;
+    struct set_occupancy* occupancy;
+    struct translation* translation;
+    struct instruction_cache* icache;
+    struct dram* dram;
+    struct mshr_file* mshrs;
 };
 
 //Data structure to house all the simulation statistics
@@ -107,21 +185,39 @@ struct cache_stats {
     long total_evictions;
     long dirty_evictions;
     long total_loads;
+
+    //Misses on lines in the cache whose sector was not filled yet, and the bytes moved to and from memory
+    long sector_misses;
+    long bytes_filled;
+    long bytes_written_back;
+
+    //Instruction fetches, which are counted in the totals but not as data reads
+    long total_fetches;
+    long fetch_misses;
 };
 
-//Data structure to house the tag, set, and word information for an address
-struct address_info {
-    INT_TYPE tag;
-    INT_TYPE set;
-    INT_TYPE word;
+//Data structure to house the instruction cache of a split cache and its statistics
+struct instruction_cache {
+    struct cache cache_mem;
+    struct cache_stats stats;
 };
 
+#ifdef _WIN32
+size_t getline(char **lineptr, size_t *n, FILE *stream);
+#endif
+
 struct cache zero_cache();
 struct cache_stats zero_stats();
 struct cache init_cache_mem(struct cache cache_mem);
 struct main_mem_block* init_main_mem();
+void free_cache_mem(struct cache cache_mem);
 void free_io(struct cache cache_mem, struct main_mem_block* main_mem);
 
+void reset_cache_mem(struct cache* cache_mem);
+int init_mem_tracker(struct mem_tracker* tracker);
+void reset_main_mem(struct main_mem_block* main_mem, struct mem_tracker* tracker);
+void free_mem_tracker(struct mem_tracker* tracker);
+
 void print_cache_and_memory(struct cache cache_mem, struct cache_stats stats,
         struct main_mem_block* main_mem);
 void write_cache_and_memory(char* output, struct cache cache_mem, struct cache_stats stats,
@@ -131,13 +227,22 @@ struct address_info info_from_address(INT_TYPE addr, int total_cache_sets, int c
 INT_TYPE address_from_info(INT_TYPE tag, INT_TYPE set, INT_TYPE word,
                            int total_cache_sets, int cache_block_size);
 
+struct address_info cache_info_from_address(struct cache cache_mem, INT_TYPE addr);
+INT_TYPE cache_line_address(struct cache cache_mem, INT_TYPE line);
+INT_TYPE cache_way_line(struct cache cache_mem, struct address_info info, int way);
+int index_function_from_name(char* name);
+char* index_function_name(int index_function);
+
 bool addr_in_cache(struct cache cache_mem, struct address_info info);
-bool set_has_empty(struct cache cache_mem, INT_TYPE set);
+bool set_has_empty(struct cache cache_mem, struct address_info info);
 
-INT_TYPE get_lru_cm_line(struct cache cache_mem, INT_TYPE set);
+INT_TYPE get_loaded_cm_line(struct cache cache_mem, struct address_info info);
+INT_TYPE get_available_cm_line(struct cache cache_mem, struct address_info info);
+INT_TYPE get_lru_cm_line(struct cache cache_mem, struct address_info info);
 
 bool evict_line(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE line, bool keep_in_cache);
-int load_line(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE addr);
+int load_line(struct cache* cache_mem, struct cache_stats* stats, struct main_mem_block* main_mem,
+              INT_TYPE addr);
 
 int write_back(struct cache* cache_mem, struct address_info info, INT_TYPE new_val);
 
@@ -145,6 +250,8 @@ int write_to_cache(struct cache* cache_mem, struct cache_stats* stats,
         struct main_mem_block* main_mem, INT_TYPE addr, INT_TYPE new_val);
 int read_from_cache(struct cache* cache_mem, struct cache_stats* stats,
         struct main_mem_block* main_mem, INT_TYPE addr);
+int fetch_from_cache(struct cache* cache_mem, struct cache_stats* stats,
+        struct main_mem_block* main_mem, INT_TYPE addr);
 void write_cache_to_memory(struct cache* cache_mem, struct main_mem_block* main_mem);
 
 #endif //CACHE_SIM_IO_H
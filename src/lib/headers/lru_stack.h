@@ -0,0 +1,40 @@
+//
+// LRU stack distance tracking for fully associative cache models
+//
+
+#ifndef CACHE_SIM_LRU_STACK_H
+#define CACHE_SIM_LRU_STACK_H
+#include "io.h"
+
+//Defining the distance reported for a block which has never been seen
+#define LRU_STACK_COLD -1L
+
+//Data structure to house an LRU stack. Every tracked block keeps the timestamp of its last access, and a
+//Fenwick tree over the timestamps counts how many distinct blocks were touched since then. Timestamps are
+//renumbered once they run out, so the memory used only depends on the number of tracked blocks
+struct lru_stack {
+    long capacity;
+    long live;
+
+    //Open addressing hash table from block address to the slot holding its last access timestamp
+    long table_size;
+    INT_TYPE* keys;
+    long* stamps;
+    bool* used;
+
+    //Timestamp slots, the block that owns each slot, and the Fenwick tree over occupied slots
+    long slots;
+    long next_stamp;
+    INT_TYPE* owners;
+    bool* occupied;
+    int* tree;
+};
+
+int init_lru_stack(struct lru_stack* stack, long capacity);
+void free_lru_stack(struct lru_stack* stack);
+void reset_lru_stack(struct lru_stack* stack);
+
+long lru_stack_access(struct lru_stack* stack, INT_TYPE block);
+bool lru_stack_remove(struct lru_stack* stack, INT_TYPE block);
+
+#endif //CACHE_SIM_LRU_STACK_H
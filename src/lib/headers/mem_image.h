@@ -0,0 +1,14 @@
+//
+// Loading main memory from a binary image and dumping the whole of main memory as one
+//
+
+#ifndef CACHE_SIM_MEM_IMAGE_H
+#define CACHE_SIM_MEM_IMAGE_H
+#include "io.h"
+
+//A main memory image is the raw words of main memory in host byte order, word address i at byte offset
+//i * WORD_SIZE. Images smaller than main memory only replace the words they cover
+int load_mem_image(struct main_mem_block* main_mem, char* path);
+int dump_mem_image(struct main_mem_block* main_mem, char* path);
+
+#endif //CACHE_SIM_MEM_IMAGE_H
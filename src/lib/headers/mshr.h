@@ -0,0 +1,55 @@
+//
+// Non-blocking cache timing: miss status holding registers tracking the misses in flight, with the memory
+// level parallelism and the stalls on a full set of registers
+//
+
+#ifndef CACHE_SIM_MSHR_H
+#define CACHE_SIM_MSHR_H
+#include "io.h"
+
+//Defining the largest number of MSHRs
+#define MAX_MSHRS 64
+
+//Defining the default cycles from a miss to its fill, on top of the DRAM latency when a DRAM is attached,
+//and the cycles between two accesses issued back to back
+#define MSHR_DEFAULT_MISS_LATENCY 100
+#define MSHR_ISSUE_CYCLES 1
+
+//Data structure to house the MSHRs of a non-blocking cache. Accesses issue one after the other, a miss
+//takes a free register until its fill arrives, and an access to a block already in flight merges into its
+//register instead of taking another. The core only stalls when a miss finds every register taken
+struct mshr_file {
+    int total;
+    int miss_latency;
+
+    //Whether each register is taken, its block, and the cycle its fill arrives. A fill can arrive in the
+    //cycle of its miss, so the cycle alone cannot mark a register as taken
+    bool* busy;
+    INT_TYPE* blocks;
+    unsigned long long* ready;
+    int used;
+    int peak;
+
+    //Current cycle, and the cycle the occupancy was counted up to
+    unsigned long long clock;
+    unsigned long long counted;
+
+    long accesses;
+    long primary_misses;
+    long secondary_misses;
+    long stalls;
+    unsigned long long stall_cycles;
+
+    //Cycles spent with every number of registers taken, and the sum of the registers taken over all cycles
+    unsigned long long* occupancy;
+    unsigned long long outstanding;
+};
+
+int init_mshr_file(struct mshr_file* mshrs, int total, int miss_latency);
+void free_mshr_file(struct mshr_file* mshrs);
+
+void mshr_access(struct mshr_file* mshrs, INT_TYPE block, bool miss, long memory_cycles);
+void drain_mshr_file(struct mshr_file* mshrs);
+void print_mshr_report(FILE* out, struct mshr_file* mshrs);
+
+#endif //CACHE_SIM_MSHR_H
@@ -0,0 +1,50 @@
+//
+// Multi-programmed workloads interleaved on one shared cache
+//
+
+#ifndef CACHE_SIM_MULTIPROG_H
+#define CACHE_SIM_MULTIPROG_H
+#include "io.h"
+#include "partition.h"
+#include "trace.h"
+
+//Defining the owner of a cache line no workload has filled yet
+#define NO_WORKLOAD 0xff
+
+//Data structure to house a workload and its share of the cache statistics
+struct workload {
+    char* trace_name;
+    struct trace_reader reader;
+    bool done;
+    struct cache_stats stats;
+
+    //Evictions of lines this workload accessed last by other workloads, and the reverse
+    long lines_lost;
+    long lines_taken;
+
+    //Statistics of the workload alone on an unpartitioned cache of the same geometry
+    bool has_solo;
+    struct cache_stats solo_stats;
+};
+
+//Data structure to house workloads taking turns on one cache, quantum records at a time
+struct multiprog {
+    int total_workloads;
+    struct workload* workloads;
+    long quantum;
+    long context_switches;
+
+    //Workload that last accessed every cache line
+    unsigned char* owners;
+    struct way_partition* partition;
+};
+
+int init_multiprog(struct multiprog* mp, struct cache cache_mem, char** traces, int total_workloads, long quantum);
+void free_multiprog(struct multiprog* mp);
+
+int run_multiprog(struct multiprog* mp, struct cache* cache_mem, struct main_mem_block* main_mem);
+int run_solo(struct multiprog* mp, struct cache geometry);
+struct cache_stats multiprog_total_stats(struct multiprog* mp);
+void print_multiprog_report(FILE* out, struct multiprog* mp);
+
+#endif //CACHE_SIM_MULTIPROG_H
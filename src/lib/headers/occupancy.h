@@ -0,0 +1,25 @@
+//
+// Per-set fill, eviction, and occupancy statistics, used to compare set index functions
+//
+
+#ifndef CACHE_SIM_OCCUPANCY_H
+#define CACHE_SIM_OCCUPANCY_H
+#include "io.h"
+
+//Defining the number of busiest sets listed in the report
+#define OCCUPANCY_TOP_SETS 8
+
+//Data structure to house the fills and evictions of every set
+struct set_occupancy {
+    int total_sets;
+    long* fills;
+    long* evictions;
+};
+
+int init_set_occupancy(struct set_occupancy* occupancy, struct cache cache_mem);
+void free_set_occupancy(struct set_occupancy* occupancy);
+
+void record_set_fill(struct set_occupancy* occupancy, INT_TYPE set, bool evicted);
+void print_set_occupancy(FILE* out, struct set_occupancy* occupancy, struct cache cache_mem);
+
+#endif //CACHE_SIM_OCCUPANCY_H
@@ -0,0 +1,43 @@
+//
+// Buffered result formatter for the statistics, cache contents, and main memory window
+//
+
+#ifndef CACHE_SIM_OUTPUT_H
+#define CACHE_SIM_OUTPUT_H
+#include "io.h"
+
+//Defining the result formats
+#define OUTPUT_TEXT 0
+#define OUTPUT_CSV 1
+#define OUTPUT_JSON 2
+
+//Data structure to house the result output settings
+struct output_config {
+    int format;
+    //Whether the cache contents and main memory window are written after the statistics
+    bool dump;
+    //Whether the sector misses and the bytes moved between the cache and main memory are written
+    bool traffic;
+
+    //Main memory window, as a start word address and a number of words
+    INT_TYPE mem_start;
+    long mem_size;
+};
+
+//Data structure to house a growable output buffer
+struct output_buffer {
+    char* data;
+    size_t used;
+    size_t capacity;
+    bool failed;
+};
+
+struct output_config zero_output_config();
+int check_output_config(struct output_config config);
+
+char* format_results(struct cache cache_mem, struct cache_stats stats, struct main_mem_block* main_mem,
+                     struct output_config config, size_t* length);
+int write_results(FILE* out, struct cache cache_mem, struct cache_stats stats, struct main_mem_block* main_mem,
+                  struct output_config config);
+
+#endif //CACHE_SIM_OUTPUT_H
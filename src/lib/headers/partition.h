@@ -0,0 +1,41 @@
+//
+// Way partitioning of a shared cache between workloads, with optional set dueling QoS
+//
+
+#ifndef CACHE_SIM_PARTITION_H
+#define CACHE_SIM_PARTITION_H
+#include "io.h"
+
+//Defining the largest number of workloads sharing a cache
+#define MAX_WORKLOADS 64
+
+//Defining the set dueling period, every period sets hold one leader set of each policy, and the range of
+//the policy selector
+#define PARTITION_DUEL_PERIOD 32
+#define PARTITION_PSEL_MAX 1023
+
+//Data structure to house the ways every workload may allocate into. Lines in any way can be hit by every
+//workload, the masks only limit which lines a miss of a workload can fill or evict
+struct way_partition {
+    int total_workloads;
+    unsigned int masks[MAX_WORKLOADS];
+    unsigned int all_ways;
+    //Workload whose access is being simulated
+    int current;
+
+    //Set dueling between the partition and an unpartitioned cache: leader sets always use one of the
+    //policies, and their misses move the selector which the follower sets obey
+    bool qos;
+    int period;
+    int psel;
+    long partitioned_leader_misses;
+    long shared_leader_misses;
+};
+
+int init_way_partition(struct way_partition* partition, struct cache cache_mem, int* ways, int total_workloads,
+                       bool qos);
+unsigned int partition_ways(struct way_partition* partition, INT_TYPE set);
+void partition_record_miss(struct way_partition* partition, INT_TYPE set);
+bool partition_followers_partitioned(struct way_partition* partition);
+
+#endif //CACHE_SIM_PARTITION_H
@@ -0,0 +1,77 @@
+//
+// Statistical sampling (set sampling and time sampling) for the cache simulator
+//
+
+#ifndef CACHE_SIM_SAMPLING_H
+#define CACHE_SIM_SAMPLING_H
+#include "io.h"
+
+//Defining the sampling modes
+#define SAMPLE_NONE 0
+#define SAMPLE_SETS 1
+#define SAMPLE_TIME 2
+
+//Defining what the simulator should do with a single access
+#define SAMPLE_SKIP 0
+#define SAMPLE_WARM 1
+#define SAMPLE_MEASURE 2
+
+//Z value used for the 95% confidence intervals
+#define SAMPLE_Z_95 1.96
+
+//Data structure to house the user supplied sampling parameters
+struct sample_config {
+    int mode;
+
+    //Set sampling: simulate every set_ratio-th set
+    int set_ratio;
+
+    //Time sampling: measure sample_window accesses out of every sample_period accesses,
+    //after warming the cache with warmup accesses. A warmup of -1 warms with every unmeasured access
+    long period;
+    long window;
+    long warmup;
+};
+
+//Data structure to house the counts of a single sampling unit (a set or a time window)
+struct sample_unit {
+    long reads;
+    long writes;
+    long read_misses;
+    long write_misses;
+    long evictions;
+    long dirty_evictions;
+};
+
+//Data structure to house the state of a sampling run
+struct sampler {
+    struct sample_config config;
+
+    int total_sets;
+    int cache_block_size;
+
+    //Number of accesses seen in the trace, including skipped ones
+    long position;
+    long seen_reads;
+    long seen_writes;
+    //Unit the current access is attributed to
+    long current_unit;
+
+    long total_units;
+    long capacity_units;
+    struct sample_unit* units;
+
+    //Stats of warming accesses, which only update the cache state
+    struct cache_stats warm_stats;
+};
+
+struct sample_config zero_sample_config();
+int init_sampler(struct sampler* sampler, struct sample_config config, struct cache cache_mem);
+void free_sampler(struct sampler* sampler);
+
+int sampler_classify(struct sampler* sampler, int read_write, INT_TYPE addr);
+void sampler_record(struct sampler* sampler, struct cache_stats before, struct cache_stats after);
+
+void print_sample_report(FILE* out, struct sampler* sampler);
+
+#endif //CACHE_SIM_SAMPLING_H
@@ -0,0 +1,24 @@
+//
+// Long-running simulator server that keeps cache and main memory resident behind a Unix domain socket
+//
+
+#ifndef CACHE_SIM_SERVER_H
+#define CACHE_SIM_SERVER_H
+#include "io.h"
+#include "session.h"
+#include "trace.h"
+
+//Commands are single text lines answered by a single line starting with OK or ERR:
+//  CONFIG <capacity> <blocksize> <associativity>   rebuild the cache, capacity in KB and block size in bytes
+//  RESET                                           empty the cache, restore main memory, and zero the stats
+//  TRACE <path>                                    simulate a text or binary trace file on the server
+//  RECORDS                                         simulate the trace lines that follow, up to a line "END"
+//  FLUSH                                           write the cache contents back to main memory
+//  STATS                                           answer with the statistics since the last reset
+//  QUIT                                            close the connection
+//  SHUTDOWN                                        close the connection and stop the server
+#define SERVER_RECORDS_END "END"
+
+int run_server(char* socket_path);
+
+#endif //CACHE_SIM_SERVER_H
@@ -0,0 +1,44 @@
+//
+// Embeddable simulator sessions: a cache and its main memory driven with batches of records, without any
+// file I/O or global state so that one process can run several sessions side by side
+//
+
+#ifndef CACHE_SIM_SESSION_H
+#define CACHE_SIM_SESSION_H
+#include "io.h"
+#include "trace.h"
+
+//Data structure to house the cache config of a session, capacity in KB and sizes in bytes. A sector size of
+//0 leaves the lines unsectored
+struct session_config {
+    int capacity;
+    int block_size;
+    int associativity;
+    int index_function;
+    int sector_size;
+};
+
+//Data structure to house a resident simulator instance
+struct sim_session {
+    struct cache cache_mem;
+    struct main_mem_block* main_mem;
+    struct cache_stats stats;
+    struct mem_tracker tracker;
+};
+
+struct session_config zero_session_config();
+int check_session_config(struct session_config config);
+
+int init_sim_session(struct sim_session* session);
+void free_sim_session(struct sim_session* session);
+struct sim_session* create_sim_session();
+void destroy_sim_session(struct sim_session* session);
+
+int configure_sim_session(struct sim_session* session, struct session_config config);
+void reset_sim_session(struct sim_session* session);
+void flush_sim_session(struct sim_session* session);
+
+long simulate_batch(struct sim_session* session, struct trace_record* records, long count);
+struct cache_stats sim_session_stats(struct sim_session* session);
+
+#endif //CACHE_SIM_SESSION_H
@@ -0,0 +1,63 @@
+//
+// Single pass miss ratio curve estimation using SHARDS spatial sampling
+//
+
+#ifndef CACHE_SIM_SHARDS_H
+#define CACHE_SIM_SHARDS_H
+#include "io.h"
+#include "lru_stack.h"
+
+//Defining the hash space that sampling thresholds are taken from
+#define SHARDS_MODULUS 16777216
+//Defining the number of histogram bins the curve is built from
+#define SHARDS_BINS 4096
+
+//Data structure to house the user supplied SHARDS parameters
+struct shards_config {
+    bool enabled;
+    //Initial sampling rate, lowered on the fly once more than max_samples blocks are tracked
+    double rate;
+    long max_samples;
+    //Largest capacity in KB the curve is reported for
+    int max_capacity;
+};
+
+//Data structure to house a sampled block in the max heap ordered by hash value
+struct shards_sample {
+    unsigned int hash;
+    INT_TYPE block;
+};
+
+//Data structure to house the state of a SHARDS run
+struct shards {
+    struct shards_config config;
+
+    int word_shift;
+    int line_size;
+
+    //Blocks are sampled when their hash is below the threshold, the rate is threshold / SHARDS_MODULUS
+    unsigned int threshold;
+
+    struct lru_stack stack;
+    long heap_size;
+    struct shards_sample* heap;
+
+    //Histogram of scaled reuse distances, every bin covers bin_lines cache lines
+    long bin_lines;
+    double* histogram;
+    double cold;
+    double overflow;
+
+    long total_accesses;
+};
+
+struct shards_config zero_shards_config();
+int init_shards(struct shards* shards, struct shards_config config, struct cache cache_mem);
+void free_shards(struct shards* shards);
+
+void shards_access(struct shards* shards, INT_TYPE addr);
+double shards_miss_rate(struct shards* shards, long capacity_lines);
+
+void print_shards_report(FILE* out, struct shards* shards, int cache_size);
+
+#endif //CACHE_SIM_SHARDS_H
@@ -0,0 +1,36 @@
+//
+// Double buffered output stream which hands full buffers to a background writer thread
+//
+
+#ifndef CACHE_SIM_STREAM_WRITER_H
+#define CACHE_SIM_STREAM_WRITER_H
+#include <pthread.h>
+#include "io.h"
+
+//Defining the default size of each of the two buffers
+#define STREAM_WRITER_BUFFER_SIZE 1048576
+
+//Data structure to house a double buffered writer. The simulation fills one buffer while the writer
+//thread drains the other, so it only waits when the disk falls a whole buffer behind
+struct stream_writer {
+    FILE* file;
+
+    size_t buffer_size;
+    char* buffers[2];
+    int active;
+    size_t used;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool pending;
+    size_t pending_size;
+    bool closing;
+    bool failed;
+};
+
+int open_stream_writer(struct stream_writer* writer, char* path, size_t buffer_size);
+void stream_write(struct stream_writer* writer, const void* data, size_t size);
+int close_stream_writer(struct stream_writer* writer);
+
+#endif //CACHE_SIM_STREAM_WRITER_H
@@ -0,0 +1,90 @@
+//
+// Virtual to physical address translation with a multi-level TLB and page walks through the cache
+//
+
+#ifndef CACHE_SIM_TLB_H
+#define CACHE_SIM_TLB_H
+#include "io.h"
+
+//Defining the largest number of TLB levels
+#define TLB_MAX_LEVELS 3
+
+//Defining the page sizes in bytes
+#define PAGE_SIZE_SMALL 4096
+#define PAGE_SIZE_HUGE 2097152
+
+//Defining the page table layout: nodes of one small page holding 8 byte entries, walked from the root in 4
+//levels for small pages and 3 levels for huge pages
+#define PTE_SIZE 8
+#define PTES_PER_NODE (PAGE_SIZE_SMALL / PTE_SIZE)
+#define WALK_LEVELS_SMALL 4
+#define WALK_LEVELS_HUGE 3
+
+//Defining the order physical frames are handed out in on the first touch of a page, and the seed of the
+//random order
+#define PAGE_ALLOC_RANDOM 0
+#define PAGE_ALLOC_LINEAR 1
+#define PAGE_ALLOC_SEED 0x5eed
+
+//Data structure to house one set-associative TLB level. Every entry holds a virtual page number plus one,
+//so that 0 marks an empty entry, and the frame it maps to
+struct tlb_level {
+    int entries;
+    int ways;
+    int total_sets;
+
+    unsigned long long* tags;
+    long* frames;
+    unsigned long long* last_use;
+
+    long hits;
+    long misses;
+};
+
+//Data structure to house the translation stage in front of a cache. Page table nodes live in frames at
+//the top of main memory, and the frames below are mapped to virtual pages as the trace touches them
+struct translation {
+    int page_size;
+    int page_shift;
+    int walk_levels;
+    int alloc;
+
+    int total_levels;
+    struct tlb_level levels[TLB_MAX_LEVELS];
+    unsigned long long clock;
+
+    //Frame of every virtual page, or -1 while the page was not touched
+    long total_pages;
+    long* page_frames;
+
+    //Frames of the page table nodes of every walk level, indexed by the virtual page number bits above
+    //the level, in small pages counted from the first node frame
+    long* node_frames[WALK_LEVELS_SMALL];
+    long total_nodes;
+    long next_node;
+    INT_TYPE node_base;
+
+    //Data frames in the order they are handed out
+    long* free_frames;
+    long total_frames;
+    long next_frame;
+
+    long translations;
+    long walks;
+    struct cache_stats walk_stats;
+
+    //Accesses per set when the cache is indexed with the virtual and with the physical address
+    int total_sets;
+    long* virtual_sets;
+    long* physical_sets;
+    long moved;
+};
+
+int init_translation(struct translation* translation, struct cache cache_mem, int page_size, int alloc,
+                     int* entries, int* ways, int total_levels);
+void free_translation(struct translation* translation);
+
+int translate_address(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE addr, INT_TYPE* result);
+void print_translation_report(FILE* out, struct translation* translation);
+
+#endif //CACHE_SIM_TLB_H
@@ -0,0 +1,74 @@
+//
+// Trace records, the trace line parser, and fully parsed in-memory traces
+//
+
+#ifndef CACHE_SIM_TRACE_H
+#define CACHE_SIM_TRACE_H
+#include "io.h"
+
+//Defining the binary trace header, a magic followed by the format version as a little endian 32-bit
+//integer. Every record is an op byte followed by the address, and for writes the value, as little endian
+//64-bit integers. An op byte with the extended flag set is followed by the size and the PC as well
+#define TRACE_BINARY_MAGIC "TRCS"
+#define TRACE_BINARY_VERSION 1
+#define TRACE_OP_EXTENDED 0x80
+
+//Defining the largest access size in bytes of an extended record
+#define TRACE_MAX_SIZE 0xffff
+
+//Defining the trace file formats
+#define TRACE_FORMAT_TEXT 0
+#define TRACE_FORMAT_BINARY 1
+
+struct generator;
+struct decompressor;
+
+//Data structure to house a single decoded trace record. The size in bytes and the PC are only set by
+//extended records, a size of 0 is a single word and a PC of 0 is no PC
+struct trace_record {
+    INT_TYPE addr;
+    INT_TYPE val;
+    INT_TYPE pc;
+    unsigned short size;
+    unsigned char op;
+};
+
+//Data structure to house a whole trace decoded into memory
+struct trace {
+    long length;
+    long capacity;
+    struct trace_record* records;
+};
+
+//Data structure to house a source of trace records: a text trace, a binary trace, or a generator
+struct trace_reader {
+    FILE* file;
+    int format;
+    long record_num;
+
+    char* line;
+    size_t len;
+
+    struct generator* gen;
+    struct decompressor* decompressor;
+};
+
+int parse_trace_line(char* line, long read, int line_num, struct trace_record* record);
+
+int open_trace_reader(struct trace_reader* reader, char* input_file);
+void open_generator_reader(struct trace_reader* reader, struct generator* gen);
+int read_trace_record(struct trace_reader* reader, struct trace_record* record);
+void close_trace_reader(struct trace_reader* reader);
+
+int write_trace_header(FILE* out, int format);
+int write_trace_record(FILE* out, int format, struct trace_record record);
+
+int load_trace(char* input_file, struct trace* trace);
+void free_trace(struct trace* trace);
+
+int simulate_record(struct cache* cache_mem, struct cache_stats* stats, struct main_mem_block* main_mem,
+                    struct trace_record record);
+int simulate_trace_records(struct cache* cache_mem, struct cache_stats* stats, struct main_mem_block* main_mem,
+                           struct trace_record* records, long count);
+
+#endif //CACHE_SIM_TRACE_H
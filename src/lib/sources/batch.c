@@ -0,0 +1,508 @@
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+#include "../headers/batch.h"
+//
+// Batch runner for job files of traces and cache configs, run on a pool of host threads with the results
+// kept in a local cache keyed by the trace contents and the config
+//
+
+//Defining the 64-bit FNV-1a offset basis and prime used for the content hashes
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+//Function to read a monotonic clock in milliseconds
+static double batch_msec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000.0 + (double) ts.tv_nsec / 1000000.0;
+}
+
+//Function to add bytes to a running FNV-1a hash
+static unsigned long long hash_bytes(unsigned long long hash, const unsigned char* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+//Function to hash the contents of a file, returns non-zero if it cannot be read
+static int hash_file(char* name, unsigned long long* hash) {
+    FILE* file = fopen(name, "rb");
+    if(!file) {
+        printf("Error: Input file %s could not be opened!\n", name);
+        return 1;
+    }
+
+    unsigned char buffer[65536];
+    size_t read;
+    *hash = FNV_OFFSET;
+    while((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        *hash = hash_bytes(*hash, buffer, read);
+    }
+    int status = ferror(file) != 0;
+    fclose(file);
+    return status;
+}
+
+//Function to get the index of a trace of the batch, adding it the first time it is named. Returns -1 if it
+//cannot be added
+static int batch_trace_index(struct batch* batch, char* name) {
+    for(int i = 0; i < batch->total_traces; i++) {
+        if(strcmp(batch->traces[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    struct batch_trace* traces = realloc(batch->traces, (batch->total_traces + 1) * sizeof(struct batch_trace));
+    if(!traces) {
+        return -1;
+    }
+    batch->traces = traces;
+    struct batch_trace* trace = &batch->traces[batch->total_traces];
+    memset(trace, 0, sizeof(struct batch_trace));
+    trace->name = strdup(name);
+    if(!trace->name) {
+        return -1;
+    }
+    return batch->total_traces++;
+}
+
+//Function to parse a positive integer option of a job, returns non-zero if it is not one
+static int parse_job_int(char* value, int* result) {
+    char* end;
+    long parsed = strtol(value, &end, 10);
+    if(*end != '\0' || parsed <= 0 || parsed > 1048576) {
+        return 1;
+    }
+    *result = (int) parsed;
+    return 0;
+}
+
+//Function to parse the options of a job line after its trace, returns non-zero after printing the reason if
+//they are invalid
+static int parse_job_options(struct batch_job* job, char** tokens, int total_tokens) {
+    for(int i = 0; i < total_tokens; i++) {
+        char* flag = tokens[i];
+        char* value = i + 1 < total_tokens ? tokens[i + 1] : NULL;
+        if(strcmp(flag, "--no-dump") == 0) {
+            job->output.dump = 0;
+            continue;
+        }
+        if(!value) {
+            printf("Error: Job file line %d: %s needs a value\n", job->line_num, flag);
+            return 1;
+        }
+        i++;
+
+        int bad = 0;
+        if(strcmp(flag, "-c") == 0) {
+            bad = parse_job_int(value, &job->config.capacity);
+        } else if(strcmp(flag, "-b") == 0) {
+            bad = parse_job_int(value, &job->config.block_size);
+        } else if(strcmp(flag, "-a") == 0) {
+            bad = parse_job_int(value, &job->config.associativity);
+        } else if(strcmp(flag, "--index") == 0) {
+            job->config.index_function = index_function_from_name(value);
+            bad = job->config.index_function < 0;
+        } else if(strcmp(flag, "--sector") == 0) {
+            bad = parse_job_int(value, &job->config.sector_size);
+            job->output.traffic = 1;
+        } else if(strcmp(flag, "--format") == 0) {
+            if(strcmp(value, "text") == 0) {
+                job->output.format = OUTPUT_TEXT;
+            } else if(strcmp(value, "csv") == 0) {
+                job->output.format = OUTPUT_CSV;
+            } else if(strcmp(value, "json") == 0) {
+                job->output.format = OUTPUT_JSON;
+            } else {
+                bad = 1;
+            }
+        } else if(strcmp(flag, "--mem-window") == 0) {
+            unsigned long long start;
+            long size;
+            char extra;
+            bad = sscanf(value, "%llx:%ld%c", &start, &size, &extra) != 2 || size < 0;
+            job->output.mem_start = (INT_TYPE) start;
+            job->output.mem_size = size;
+        } else if(strcmp(flag, "-o") == 0) {
+            job->output_name = strdup(value);
+            bad = job->output_name == NULL;
+        } else {
+            printf("Error: Job file line %d: unknown option %s\n", job->line_num, flag);
+            return 1;
+        }
+        if(bad) {
+            printf("Error: Job file line %d: invalid value %s for %s\n", job->line_num, value, flag);
+            return 1;
+        }
+    }
+
+    if(check_session_config(job->config)) {
+        printf("Error: Job file line %d: cache config must use the limits of -c, -b, -a, and --sector\n",
+               job->line_num);
+        return 1;
+    }
+    return check_output_config(job->output);
+}
+
+//Function to read the jobs of a job file into a batch, returns non-zero after printing the reason if the
+//file cannot be read or a job is invalid
+static int read_job_file(struct batch* batch, char* job_file) {
+    FILE* file = fopen(job_file, "r");
+    if(!file) {
+        printf("Error: Job file %s could not be opened!\n", job_file);
+        return 1;
+    }
+
+    char* line = NULL;
+    size_t len = 0;
+    int line_num = 0;
+    int status = 0;
+    while(status == 0 && getline(&line, &len, file) != -1) {
+        line_num++;
+        char* tokens[64];
+        int total_tokens = 0;
+        for(char* token = strtok(line, " \t\r\n"); token && total_tokens < 64; token = strtok(NULL, " \t\r\n")) {
+            tokens[total_tokens++] = token;
+        }
+        if(total_tokens == 0 || tokens[0][0] == '#') {
+            continue;
+        }
+
+        struct batch_job* jobs = realloc(batch->jobs, (batch->total_jobs + 1) * sizeof(struct batch_job));
+        if(!jobs) {
+            printf("Error: Could not allocate memory for the jobs\n");
+            status = 1;
+            break;
+        }
+        batch->jobs = jobs;
+        struct batch_job* job = &batch->jobs[batch->total_jobs++];
+        memset(job, 0, sizeof(struct batch_job));
+        job->line_num = line_num;
+        job->config = zero_session_config();
+        job->output = zero_output_config();
+        job->same_as = -1;
+        job->trace = batch_trace_index(batch, tokens[0]);
+        if(job->trace < 0) {
+            printf("Error: Could not allocate memory for the jobs\n");
+            status = 1;
+        } else {
+            status = parse_job_options(job, tokens + 1, total_tokens - 1);
+        }
+    }
+    free(line);
+    fclose(file);
+
+    if(status == 0 && batch->total_jobs == 0) {
+        printf("Error: Job file %s has no jobs\n", job_file);
+        status = 1;
+    }
+    return status;
+}
+
+//Function to write the canonical text of the config of a job, which every setting affecting its results
+//is part of
+static void make_job_key(struct batch_job* job) {
+    snprintf(job->key, sizeof(job->key), "-c %d -b %d -a %d --index %s --sector %d --format %d --dump %d "
+             "--traffic %d --mem-window %llx:%ld", job->config.capacity, job->config.block_size,
+             job->config.associativity, index_function_name(job->config.index_function), job->config.sector_size,
+             job->output.format, job->output.dump, job->output.traffic, (unsigned long long) job->output.mem_start,
+             job->output.mem_size);
+}
+
+//Function to write the first line of a cached result, which names everything the result depends on
+static void make_cache_header(struct batch* batch, struct batch_job* job, char* header, size_t size) {
+    snprintf(header, size, "cache_sim result v%d w%d %016llx %s\n", BATCH_CACHE_VERSION, WORD_SIZE,
+             batch->traces[job->trace].hash, job->key);
+}
+
+//Function to get the path of the cached result of a job, named by the hash of its header line
+static void make_cache_path(struct batch* batch, struct batch_job* job, char* path, size_t size) {
+    char header[512];
+    make_cache_header(batch, job, header, sizeof(header));
+    unsigned long long hash = hash_bytes(FNV_OFFSET, (unsigned char*) header, strlen(header));
+    snprintf(path, size, "%s/%016llx.result", batch->cache_dir, hash);
+}
+
+//Function to read the cached result of a job, returns non-zero if there is none. A file whose header does
+//not name the job exactly is a hash collision and is not used
+static int read_cached_result(struct batch* batch, struct batch_job* job) {
+    char path[4096];
+    char header[512];
+    make_cache_path(batch, job, path, sizeof(path));
+    make_cache_header(batch, job, header, sizeof(header));
+
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    size_t header_length = strlen(header);
+    char* data = size >= (long) header_length ? malloc(size) : NULL;
+    int status = 1;
+    if(data && fread(data, 1, size, file) == (size_t) size && memcmp(data, header, header_length) == 0) {
+        job->length = size - header_length;
+        job->results = malloc(job->length + 1);
+        if(job->results) {
+            memcpy(job->results, data + header_length, job->length);
+            status = 0;
+        }
+    }
+    free(data);
+    fclose(file);
+    return status;
+}
+
+//Function to store the result of a job in the cache. The result is written under a name of its own and
+//renamed into place, so that batches sharing the cache never read a partly written result
+static void write_cached_result(struct batch* batch, struct batch_job* job, int index) {
+    char path[4096];
+    char temp[4200];
+    char header[512];
+    make_cache_path(batch, job, path, sizeof(path));
+    make_cache_header(batch, job, header, sizeof(header));
+    snprintf(temp, sizeof(temp), "%s.%ld.%d.tmp", path, (long) getpid(), index);
+
+    FILE* file = fopen(temp, "wb");
+    if(!file) {
+        return;
+    }
+    bool failed = fwrite(header, 1, strlen(header), file) != strlen(header)
+                  || fwrite(job->results, 1, job->length, file) != job->length;
+    failed |= fclose(file) != 0;
+    if(failed || rename(temp, path) != 0) {
+        remove(temp);
+    }
+}
+
+//Function to run a job on a session of a host thread, the session is reconfigured for every job
+static void run_batch_job(struct batch* batch, struct sim_session* session, struct batch_job* job, int index) {
+    struct batch_trace* trace = &batch->traces[job->trace];
+    double start = batch_msec();
+
+    if(trace->status != 0 || configure_sim_session(session, job->config)) {
+        job->status = BATCH_JOB_FAILED;
+        return;
+    }
+    simulate_batch(session, trace->trace.records, trace->trace.length);
+    flush_sim_session(session);
+    job->results = format_results(session->cache_mem, session->stats, session->main_mem, job->output,
+                                  &job->length);
+    if(!job->results) {
+        job->status = BATCH_JOB_FAILED;
+        return;
+    }
+    job->msec = batch_msec() - start;
+    job->status = BATCH_JOB_SIMULATED;
+
+    if(batch->cache_dir) {
+        write_cached_result(batch, job, index);
+    }
+}
+
+//Function run by a host thread, taking pending jobs off the queue until it is empty. A thread creates its
+//session, and with it its main memory, on its first job
+static void* run_batch_worker(void* arg) {
+    struct batch* batch = arg;
+    struct sim_session* session = NULL;
+    while(1) {
+        pthread_mutex_lock(&batch->lock);
+        int index = batch->next_job;
+        while(index < batch->total_jobs && batch->jobs[index].status != BATCH_JOB_PENDING) {
+            index++;
+        }
+        batch->next_job = index + 1;
+        pthread_mutex_unlock(&batch->lock);
+        if(index >= batch->total_jobs) {
+            break;
+        }
+
+        if(!session) {
+            session = create_sim_session();
+        }
+        if(!session) {
+            batch->jobs[index].status = BATCH_JOB_FAILED;
+            continue;
+        }
+        run_batch_job(batch, session, &batch->jobs[index], index);
+    }
+    destroy_sim_session(session);
+    return NULL;
+}
+
+//Function to get the name of the state of a job
+static char* batch_status_name(int status) {
+    switch(status) {
+        case BATCH_JOB_SIMULATED:
+            return "simulated";
+        case BATCH_JOB_CACHED:
+            return "cached";
+        case BATCH_JOB_REPEATED:
+            return "repeated";
+        default:
+            return "failed";
+    }
+}
+
+//Function to write the results of every job to its output file or the terminal, in job order, followed by
+//a summary of the batch. Returns non-zero if a job failed
+static int write_batch_results(struct batch* batch, double msec) {
+    int counts[BATCH_JOB_FAILED + 1] = {0};
+    for(int i = 0; i < batch->total_jobs; i++) {
+        struct batch_job* job = &batch->jobs[i];
+        counts[job->status]++;
+        if(job->status == BATCH_JOB_FAILED) {
+            continue;
+        }
+        if(job->output_name) {
+            FILE* output_file = fopen(job->output_name, "w");
+            if(!output_file) {
+                printf("Error: Output file %s could not be created / opened!\n", job->output_name);
+                counts[job->status]--;
+                job->status = BATCH_JOB_FAILED;
+                counts[BATCH_JOB_FAILED]++;
+                continue;
+            }
+            fwrite(job->results, 1, job->length, output_file);
+            fclose(output_file);
+        } else {
+            printf("JOB %d: %s %s\n", job->line_num, batch->traces[job->trace].name, job->key);
+            fflush(stdout);
+            fwrite(job->results, 1, job->length, stdout);
+            printf("\n");
+        }
+    }
+
+    printf("BATCH:\nJobs: %d, simulated: %d, cached: %d, repeated: %d, failed: %d\n", batch->total_jobs,
+           counts[BATCH_JOB_SIMULATED], counts[BATCH_JOB_CACHED], counts[BATCH_JOB_REPEATED],
+           counts[BATCH_JOB_FAILED]);
+    printf("Threads: %d, wall time: %.3f ms\n", batch->threads, msec);
+    printf("%-6s %-10s %-12s %s\n", "Line", "Status", "Time(ms)", "Trace");
+    for(int i = 0; i < batch->total_jobs; i++) {
+        struct batch_job* job = &batch->jobs[i];
+        printf("%-6d %-10s %-12.3f %s\n", job->line_num, batch_status_name(job->status), job->msec,
+               batch->traces[job->trace].name);
+    }
+    return counts[BATCH_JOB_FAILED] > 0;
+}
+
+//Function to free the memory allocated to a batch
+static void free_batch(struct batch* batch) {
+    for(int i = 0; i < batch->total_jobs; i++) {
+        free(batch->jobs[i].output_name);
+        free(batch->jobs[i].results);
+    }
+    for(int i = 0; i < batch->total_traces; i++) {
+        free(batch->traces[i].name);
+        free_trace(&batch->traces[i].trace);
+    }
+    free(batch->jobs);
+    free(batch->traces);
+}
+
+//Function to run the jobs of a job file on up to threads host threads. Jobs whose result is in the cache
+//directory are not run again, as are jobs repeating an earlier job of the file, and only the traces of the
+//jobs left are parsed. A NULL cache directory turns the result cache off. Returns non-zero if the job file
+//is invalid or a job failed
+int run_batch(char* job_file, int threads, char* cache_dir) {
+    struct batch batch;
+    memset(&batch, 0, sizeof(struct batch));
+    batch.cache_dir = cache_dir;
+    batch.threads = threads;
+    double start = batch_msec();
+
+    if(read_job_file(&batch, job_file)) {
+        free_batch(&batch);
+        return 1;
+    }
+    for(int i = 0; i < batch.total_traces; i++) {
+        batch.traces[i].status = hash_file(batch.traces[i].name, &batch.traces[i].hash);
+    }
+    if(cache_dir) {
+#ifdef _WIN32
+        int made = _mkdir(cache_dir);
+#else
+        int made = mkdir(cache_dir, 0755);
+#endif
+        if(made != 0 && errno != EEXIST) {
+            printf("Error: Result cache directory %s could not be created, running without it\n", cache_dir);
+            batch.cache_dir = NULL;
+        }
+    }
+
+    //Settle every job the cache or an earlier job answers, the rest need their trace
+    for(int i = 0; i < batch.total_jobs; i++) {
+        struct batch_job* job = &batch.jobs[i];
+        make_job_key(job);
+        if(batch.traces[job->trace].status != 0) {
+            job->status = BATCH_JOB_FAILED;
+            continue;
+        }
+        for(int j = 0; j < i && job->same_as < 0; j++) {
+            if(batch.jobs[j].trace == job->trace && strcmp(batch.jobs[j].key, job->key) == 0) {
+                job->same_as = j;
+                job->status = BATCH_JOB_REPEATED;
+            }
+        }
+        if(job->same_as < 0 && batch.cache_dir && read_cached_result(&batch, job) == 0) {
+            job->status = BATCH_JOB_CACHED;
+        }
+        if(job->status == BATCH_JOB_PENDING) {
+            batch.traces[job->trace].needed = 1;
+        }
+    }
+
+    //Parse the traces once, the jobs only read them
+    for(int i = 0; i < batch.total_traces; i++) {
+        if(batch.traces[i].needed) {
+            batch.traces[i].status = load_trace(batch.traces[i].name, &batch.traces[i].trace);
+        }
+    }
+
+    pthread_t workers[BATCH_MAX_THREADS];
+    int total_workers = 0;
+    pthread_mutex_init(&batch.lock, NULL);
+    for(int i = 0; i < threads; i++) {
+        if(pthread_create(&workers[total_workers], NULL, run_batch_worker, &batch) == 0) {
+            total_workers++;
+        }
+    }
+    //Without any host thread the jobs run on this one
+    if(total_workers == 0) {
+        run_batch_worker(&batch);
+    }
+    for(int i = 0; i < total_workers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    pthread_mutex_destroy(&batch.lock);
+
+    //Repeated jobs take the results of the job they repeat
+    for(int i = 0; i < batch.total_jobs; i++) {
+        struct batch_job* job = &batch.jobs[i];
+        if(job->same_as < 0) {
+            continue;
+        }
+        struct batch_job* first = &batch.jobs[job->same_as];
+        job->results = first->status == BATCH_JOB_FAILED ? NULL : malloc(first->length + 1);
+        if(!job->results) {
+            job->status = BATCH_JOB_FAILED;
+            continue;
+        }
+        memcpy(job->results, first->results, first->length);
+        job->length = first->length;
+    }
+
+    int status = write_batch_results(&batch, batch_msec() - start);
+    free_batch(&batch);
+    return status;
+}
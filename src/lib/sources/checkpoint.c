@@ -0,0 +1,263 @@
+#include "../headers/checkpoint.h"
+#include "../headers/gen.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+//
+// Checkpoint and restore of the full simulator state
+//
+
+//Function to write a snapshot of the simulator to a temporary file and move it over the checkpoint once it
+//is complete, so an interrupted run always leaves the previous checkpoint intact
+int write_checkpoint(char* path, struct cache* cache_mem, struct cache_stats stats,
+                     struct main_mem_block* main_mem, struct trace_reader* reader) {
+    if(!cache_mem->tracker) {
+        printf("Error: Checkpoints need the main memory tracker\n");
+        return 1;
+    }
+
+    struct checkpoint_header header;
+    memset(&header, 0, sizeof(struct checkpoint_header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, 4);
+    header.version = CHECKPOINT_VERSION;
+    header.header_size = sizeof(struct checkpoint_header);
+    header.word_size = WORD_SIZE;
+    header.size = cache_mem->size;
+    header.line_size = cache_mem->line_size;
+    header.associativity = cache_mem->associativity;
+    header.total_lines = cache_mem->total_lines;
+    header.words_per_line = cache_mem->words_per_line;
+    header.pc = cache_mem->pc;
+    header.index_function = cache_mem->index_function;
+    header.words_per_sector = cache_mem->words_per_sector;
+    header.stats = stats;
+    header.records = reader->record_num;
+    header.memory_blocks = cache_mem->tracker->count;
+    if(reader->gen) {
+        header.source = CHECKPOINT_SOURCE_GENERATOR;
+        header.gen_state = reader->gen->state;
+        header.gen_produced = reader->gen->produced;
+        header.gen_position = reader->gen->position;
+    } else {
+        header.source = reader->format;
+        header.offset = ftell(reader->file);
+    }
+
+    size_t temp_length = strlen(path) + 5;
+    char* temp_path = malloc(temp_length);
+    if(!temp_path) {
+        printf("Error: Could not allocate memory for the checkpoint path\n");
+        return 1;
+    }
+    snprintf(temp_path, temp_length, "%s.tmp", path);
+    FILE* out = fopen(temp_path, "wb");
+    if(!out) {
+        printf("Error: Checkpoint file could not be created / opened!\n");
+        free(temp_path);
+        return 1;
+    }
+
+    bool failure = fwrite(&header, sizeof(struct checkpoint_header), 1, out) != 1;
+    for(int i = 0; i < cache_mem->total_lines && !failure; i++) {
+        struct checkpoint_line line;
+        memset(&line, 0, sizeof(struct checkpoint_line));
+        line.tag = cache_mem->lines[i].tag;
+        line.valid_sectors = cache_mem->lines[i].valid_sectors;
+        line.dirty_sectors = cache_mem->lines[i].dirty_sectors;
+        line.last_pc = cache_mem->lines[i].last_pc;
+        line.loaded = cache_mem->lines[i].loaded;
+        line.valid = cache_mem->lines[i].valid;
+        line.dirty = cache_mem->lines[i].dirty;
+        failure = fwrite(&line, sizeof(struct checkpoint_line), 1, out) != 1;
+    }
+    for(int i = 0; i < cache_mem->total_lines && !failure; i++) {
+        failure = fwrite(cache_mem->lines[i].words, WORD_SIZE, cache_mem->words_per_line, out)
+                  != (size_t) cache_mem->words_per_line;
+    }
+    for(long i = 0; i < cache_mem->tracker->count && !failure; i++) {
+        unsigned long long block = cache_mem->tracker->blocks[i];
+        failure = fwrite(&block, sizeof(block), 1, out) != 1;
+    }
+    for(long i = 0; i < cache_mem->tracker->count && !failure; i++) {
+        failure = fwrite(main_mem[cache_mem->tracker->blocks[i]].words, WORD_SIZE, MM_WORDS_PER_BLOCK, out)
+                  != (size_t) MM_WORDS_PER_BLOCK;
+    }
+
+    if(fclose(out) != 0 || failure) {
+        printf("Error: Could not write the checkpoint to %s\n", temp_path);
+        remove(temp_path);
+        free(temp_path);
+        return 1;
+    }
+#ifdef _WIN32
+    //rename does not replace an existing file on Windows
+    remove(path);
+#endif
+    int status = 0;
+    if(rename(temp_path, path) != 0) {
+        printf("Error: Could not move the checkpoint to %s\n", path);
+        status = 1;
+    }
+
+    free(temp_path);
+    return status;
+}
+
+//Function to map a whole file into memory read-only, returns NULL if it cannot be read
+static unsigned char* map_file(char* path, size_t* size) {
+#ifdef _WIN32
+    FILE* in = fopen(path, "rb");
+    if(!in) {
+        return NULL;
+    }
+    fseek(in, 0, SEEK_END);
+    *size = (size_t) ftell(in);
+    fseek(in, 0, SEEK_SET);
+    unsigned char* data = malloc(*size > 0 ? *size : 1);
+    if(data && fread(data, 1, *size, in) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(in);
+    return data;
+#else
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = (size_t) info.st_size;
+    void* data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    return data == MAP_FAILED ? NULL : data;
+#endif
+}
+
+//Function to release a file mapped by map_file
+static void unmap_file(unsigned char* data, size_t size) {
+#ifdef _WIN32
+    free(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+//Function to check that a snapshot header fits the cache and trace it is restored into, returns non-zero
+//after printing the reason if it does not
+static int check_header(struct checkpoint_header* header, size_t size, struct cache* cache_mem,
+                        struct trace_reader* reader) {
+    if(memcmp(header->magic, CHECKPOINT_MAGIC, 4) != 0 || header->version != CHECKPOINT_VERSION
+            || header->header_size != sizeof(struct checkpoint_header) || header->word_size != WORD_SIZE) {
+        printf("Error: Checkpoint was not written by this build of the simulator\n");
+        return 1;
+    }
+    if(header->size != cache_mem->size || header->line_size != cache_mem->line_size
+            || header->associativity != cache_mem->associativity
+            || header->index_function != cache_mem->index_function
+            || header->words_per_sector != cache_mem->words_per_sector) {
+        printf("Error: Checkpoint was taken with -c %d -b %d -a %d --index %s --sector %d\n", header->size / 1024,
+               header->line_size, header->associativity, index_function_name(header->index_function),
+               header->words_per_sector * WORD_SIZE);
+        return 1;
+    }
+    unsigned int source = reader->gen ? CHECKPOINT_SOURCE_GENERATOR : (unsigned int) reader->format;
+    if(header->source != source) {
+        printf("Error: Checkpoint was taken from a different kind of trace input\n");
+        return 1;
+    }
+
+    //The snapshot must hold everything the header promises
+    size_t expected = sizeof(struct checkpoint_header)
+                      + (size_t) header->total_lines * sizeof(struct checkpoint_line)
+                      + (size_t) header->total_lines * header->words_per_line * WORD_SIZE
+                      + (size_t) header->memory_blocks * (sizeof(unsigned long long) + MM_WORDS_PER_BLOCK * WORD_SIZE);
+    if(header->memory_blocks < 0 || header->memory_blocks > TOTAL_MM_BLOCKS || size != expected) {
+        printf("Error: Checkpoint file is truncated or corrupt\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+//Function to load a snapshot into an initialized cache and main memory and move the trace reader to the
+//record after the checkpoint
+int restore_checkpoint(char* path, struct cache* cache_mem, struct cache_stats* stats,
+                       struct main_mem_block* main_mem, struct trace_reader* reader) {
+    size_t size = 0;
+    unsigned char* data = map_file(path, &size);
+    if(!data) {
+        printf("Error: Checkpoint file could not be read!\n");
+        return 1;
+    }
+    if(size < sizeof(struct checkpoint_header)) {
+        printf("Error: Checkpoint file is truncated or corrupt\n");
+        unmap_file(data, size);
+        return 1;
+    }
+
+    struct checkpoint_header header;
+    memcpy(&header, data, sizeof(struct checkpoint_header));
+    if(check_header(&header, size, cache_mem, reader)) {
+        unmap_file(data, size);
+        return 1;
+    }
+
+    unsigned char* cursor = data + sizeof(struct checkpoint_header);
+    for(int i = 0; i < cache_mem->total_lines; i++) {
+        struct checkpoint_line line;
+        memcpy(&line, cursor, sizeof(struct checkpoint_line));
+        cursor += sizeof(struct checkpoint_line);
+        cache_mem->lines[i].tag = (INT_TYPE) line.tag;
+        cache_mem->lines[i].valid_sectors = line.valid_sectors;
+        cache_mem->lines[i].dirty_sectors = line.dirty_sectors;
+        cache_mem->lines[i].last_pc = line.last_pc;
+        cache_mem->lines[i].loaded = line.loaded;
+        cache_mem->lines[i].valid = line.valid;
+        cache_mem->lines[i].dirty = line.dirty;
+    }
+    cache_mem->last_valid = 0;
+    for(int i = 0; i < cache_mem->total_lines; i++) {
+        memcpy(cache_mem->lines[i].words, cursor, cache_mem->words_per_line * WORD_SIZE);
+        cursor += cache_mem->words_per_line * WORD_SIZE;
+    }
+    unsigned char* block_words = cursor + header.memory_blocks * sizeof(unsigned long long);
+    for(long long i = 0; i < header.memory_blocks; i++) {
+        unsigned long long block;
+        memcpy(&block, cursor + i * sizeof(unsigned long long), sizeof(block));
+        if(block >= (unsigned long long) TOTAL_MM_BLOCKS) {
+            printf("Error: Checkpoint file is truncated or corrupt\n");
+            unmap_file(data, size);
+            return 1;
+        }
+        memcpy(main_mem[block].words, block_words + i * MM_WORDS_PER_BLOCK * WORD_SIZE,
+               MM_WORDS_PER_BLOCK * WORD_SIZE);
+
+        //Keep tracking the restored blocks so that later checkpoints include them
+        if(cache_mem->tracker && !cache_mem->tracker->written[block]) {
+            cache_mem->tracker->written[block] = 1;
+            cache_mem->tracker->blocks[cache_mem->tracker->count++] = (INT_TYPE) block;
+        }
+    }
+    unmap_file(data, size);
+
+    cache_mem->pc = header.pc;
+    *stats = header.stats;
+    reader->record_num = (long) header.records;
+    if(reader->gen) {
+        reader->gen->state = header.gen_state;
+        reader->gen->produced = (long) header.gen_produced;
+        reader->gen->position = (long) header.gen_position;
+    } else if(fseek(reader->file, (long) header.offset, SEEK_SET) != 0) {
+        printf("Error: Could not move the trace to the checkpoint position\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,462 @@
+#include "../headers/coherence.h"
+//
+// Multi-core simulation with private caches kept coherent by a snooping MESI protocol
+//
+
+//Defining the empty slot of a block map, keys are stored plus one
+#define BLOCK_MAP_EMPTY 0
+
+//Function for initializing a block map
+static int init_block_map(struct block_map* map, long capacity) {
+    map->capacity = 16;
+    while(map->capacity < capacity * 2) {
+        map->capacity *= 2;
+    }
+    map->count = 0;
+    map->keys = calloc(map->capacity, sizeof(unsigned long long));
+    map->values = calloc(map->capacity, sizeof(int));
+
+    return !map->keys || !map->values;
+}
+
+//Function to free the memory allocated to a block map
+static void free_block_map(struct block_map* map) {
+    free(map->keys);
+    free(map->values);
+    map->keys = NULL;
+    map->values = NULL;
+}
+
+//Function to empty a block map
+static void clear_block_map(struct block_map* map) {
+    memset(map->keys, 0, map->capacity * sizeof(unsigned long long));
+    map->count = 0;
+}
+
+//Function to find the slot of a block, or the empty slot where it would go
+static long block_map_slot(struct block_map* map, unsigned long long block) {
+    unsigned long long key = block + 1;
+    long slot = (long) ((key * 0x9e3779b97f4a7c15ULL) >> 20) & (map->capacity - 1);
+    while(map->keys[slot] != BLOCK_MAP_EMPTY && map->keys[slot] != key) {
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    return slot;
+}
+
+//Function to look up a block, returns non-zero and sets value if the block is in the map
+static bool block_map_get(struct block_map* map, unsigned long long block, int* value) {
+    long slot = block_map_slot(map, block);
+    if(map->keys[slot] == BLOCK_MAP_EMPTY) {
+        return 0;
+    }
+    *value = map->values[slot];
+    return 1;
+}
+
+//Function to add or update a block, doubling the map when it gets half full
+static void block_map_put(struct block_map* map, unsigned long long block, int value) {
+    if((map->count + 1) * 2 > map->capacity) {
+        unsigned long long* keys = map->keys;
+        int* values = map->values;
+        long capacity = map->capacity;
+
+        unsigned long long* new_keys = calloc(capacity * 2, sizeof(unsigned long long));
+        int* new_values = calloc(capacity * 2, sizeof(int));
+        if(new_keys && new_values) {
+            map->keys = new_keys;
+            map->values = new_values;
+            map->capacity = capacity * 2;
+            map->count = 0;
+            for(long i = 0; i < capacity; i++) {
+                if(keys[i] != BLOCK_MAP_EMPTY) {
+                    long slot = block_map_slot(map, keys[i] - 1);
+                    map->keys[slot] = keys[i];
+                    map->values[slot] = values[i];
+                    map->count++;
+                }
+            }
+            free(keys);
+            free(values);
+        } else {
+            free(new_keys);
+            free(new_values);
+        }
+    }
+
+    long slot = block_map_slot(map, block);
+    if(map->keys[slot] == BLOCK_MAP_EMPTY) {
+        map->keys[slot] = block + 1;
+        map->count++;
+    }
+    map->values[slot] = value;
+}
+
+//Function to remove a block, later entries of the probe run are shifted back so lookups never stop early
+static void block_map_remove(struct block_map* map, unsigned long long block) {
+    long slot = block_map_slot(map, block);
+    if(map->keys[slot] == BLOCK_MAP_EMPTY) {
+        return;
+    }
+
+    long hole = slot;
+    long next = (hole + 1) & (map->capacity - 1);
+    while(map->keys[next] != BLOCK_MAP_EMPTY) {
+        long home = (long) ((map->keys[next] * 0x9e3779b97f4a7c15ULL) >> 20) & (map->capacity - 1);
+        //Move the entry into the hole unless its home slot lies cyclically after the hole
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if(movable) {
+            map->keys[hole] = map->keys[next];
+            map->values[hole] = map->values[next];
+            hole = next;
+        }
+        next = (next + 1) & (map->capacity - 1);
+    }
+    map->keys[hole] = BLOCK_MAP_EMPTY;
+    map->count--;
+}
+
+//Function for initializing a multi-core simulation, every core gets a private cache of the given geometry
+//and its own trace
+int init_multicore(struct multicore* mc, struct cache geometry, char** traces, int total_cores,
+                   struct main_mem_block* main_mem, long quantum, long epoch_length, int threads) {
+    memset(mc, 0, sizeof(struct multicore));
+    mc->total_cores = total_cores;
+    mc->main_mem = main_mem;
+    mc->word_shift = (int) log2(geometry.words_per_line);
+    mc->quantum = quantum;
+    mc->threads = threads;
+
+    //Epochs hold a whole number of quanta so the cores stay in the same round-robin order
+    mc->epoch_length = (epoch_length + quantum - 1) / quantum * quantum;
+
+    mc->cores = calloc(total_cores, sizeof(struct mesi_core));
+    if(!mc->cores || init_block_map(&mc->epoch_owner, mc->epoch_length * total_cores)) {
+        printf("Error: Could not allocate memory for the cores\n");
+        free_multicore(mc);
+        return 1;
+    }
+
+    for(int i = 0; i < total_cores; i++) {
+        struct mesi_core* core = &mc->cores[i];
+        core->trace_name = traces[i];
+        core->cache_mem = init_cache_mem(geometry);
+        core->stats = zero_stats();
+        core->states = calloc(geometry.total_lines, sizeof(unsigned char));
+        core->buffer = calloc(mc->epoch_length, sizeof(struct trace_record));
+        if(!core->states || !core->buffer || init_block_map(&core->invalidated, 1024)) {
+            printf("Error: Could not allocate memory for the cores\n");
+            free_multicore(mc);
+            return 1;
+        }
+
+        int status = open_trace_reader(&core->reader, traces[i]);
+        if(status != 0) {
+            free_multicore(mc);
+            return status;
+        }
+    }
+
+    return 0;
+}
+
+//Function to free the memory allocated to a multi-core simulation, main memory is left to its owner
+void free_multicore(struct multicore* mc) {
+    for(int i = 0; mc->cores && i < mc->total_cores; i++) {
+        struct mesi_core* core = &mc->cores[i];
+        if(core->cache_mem.lines) {
+            free_cache_mem(core->cache_mem);
+        }
+        free(core->states);
+        free(core->buffer);
+        free_block_map(&core->invalidated);
+        close_trace_reader(&core->reader);
+    }
+    free(mc->cores);
+    free_block_map(&mc->epoch_owner);
+    mc->cores = NULL;
+}
+
+//Function to find the line of a core holding an address in a valid state, -1 if it has none. Unlike
+//addr_in_cache the line has to be loaded, so empty lines never pass for copies of tag 0 blocks
+static long holding_line(struct mesi_core* core, struct address_info info) {
+    for(int i = 0; i < core->cache_mem.associativity; i++) {
+        INT_TYPE line = cache_way_line(core->cache_mem, info, i);
+        if(core->cache_mem.lines[line].loaded && core->cache_mem.lines[line].tag == info.tag
+                && core->states[line] != MESI_INVALID) {
+            return (long) line;
+        }
+    }
+    return -1;
+}
+
+//Function to answer a bus read from another core: modified copies are written back and every copy drops to
+//shared. Returns non-zero if any other core holds the block
+static bool snoop_read(struct multicore* mc, int requester, struct address_info info) {
+    bool shared = 0;
+    for(int i = 0; i < mc->total_cores; i++) {
+        struct mesi_core* core = &mc->cores[i];
+        long line = i == requester ? -1 : holding_line(core, info);
+        if(line < 0) {
+            continue;
+        }
+
+        if(core->states[line] == MESI_MODIFIED) {
+            evict_line(&core->cache_mem, mc->main_mem, (INT_TYPE) line, 1);
+            core->cache_mem.lines[line].dirty = 0;
+            core->cache_mem.lines[line].dirty_sectors = 0;
+            core->coherence.interventions++;
+        }
+        core->states[line] = MESI_SHARED;
+        shared = 1;
+    }
+    return shared;
+}
+
+//Function to invalidate every other copy of a block before a write, modified copies are written back first
+static void snoop_invalidate(struct multicore* mc, int requester, struct address_info info,
+                             unsigned long long block) {
+    for(int i = 0; i < mc->total_cores; i++) {
+        struct mesi_core* core = &mc->cores[i];
+        long line = i == requester ? -1 : holding_line(core, info);
+        if(line < 0) {
+            continue;
+        }
+
+        //Writing back a clean copy stores the same words, so every copy can leave the same way
+        evict_line(&core->cache_mem, mc->main_mem, (INT_TYPE) line, 0);
+        core->states[line] = MESI_INVALID;
+        core->coherence.invalidations_received++;
+        mc->cores[requester].coherence.invalidations_sent++;
+        block_map_put(&core->invalidated, block, (int) info.word);
+    }
+}
+
+//Function to run a single access of a core. Without snooping the caller guarantees that no other core
+//holds or touches the block, which is what lets cores run on separate threads
+static void coherent_access(struct multicore* mc, int index, struct trace_record record, bool snoop) {
+    struct mesi_core* core = &mc->cores[index];
+    struct address_info info = cache_info_from_address(core->cache_mem, record.addr);
+    unsigned long long block = (unsigned long long) record.addr >> mc->word_shift;
+
+    long held = holding_line(core, info);
+    int state = held < 0 ? MESI_INVALID : core->states[held];
+
+    //A miss on a block another core took away is a coherence miss
+    int invalidating_word;
+    if(state == MESI_INVALID && block_map_get(&core->invalidated, block, &invalidating_word)) {
+        core->coherence.coherence_misses++;
+        if(invalidating_word == (int) info.word) {
+            core->coherence.true_sharing_misses++;
+        } else {
+            core->coherence.false_sharing_misses++;
+        }
+        block_map_remove(&core->invalidated, block);
+    }
+
+    //Instruction fetches are reads of the private cache
+    if(record.op != CACHE_WRITE) {
+        int new_state = state;
+        if(state == MESI_INVALID) {
+            core->coherence.bus_reads++;
+            new_state = snoop && snoop_read(mc, index, info) ? MESI_SHARED : MESI_EXCLUSIVE;
+        }
+        read_from_cache(&core->cache_mem, &core->stats, mc->main_mem, record.addr);
+        core->states[get_loaded_cm_line(core->cache_mem, info)] = (unsigned char) new_state;
+    } else {
+        if(state == MESI_INVALID) {
+            core->coherence.bus_read_exclusives++;
+        } else if(state == MESI_SHARED) {
+            core->coherence.bus_upgrades++;
+        }
+        if(snoop && (state == MESI_INVALID || state == MESI_SHARED)) {
+            snoop_invalidate(mc, index, info, block);
+        }
+        write_to_cache(&core->cache_mem, &core->stats, mc->main_mem, record.addr, record.val);
+        core->states[get_loaded_cm_line(core->cache_mem, info)] = MESI_MODIFIED;
+    }
+}
+
+//Function to read the next epoch of every core, returns non-zero if a trace is malformed
+static int fill_epoch(struct multicore* mc, bool* any) {
+    *any = 0;
+    for(int i = 0; i < mc->total_cores; i++) {
+        struct mesi_core* core = &mc->cores[i];
+        core->buffered = 0;
+        while(!core->done && core->buffered < mc->epoch_length) {
+            int result = read_trace_record(&core->reader, &core->buffer[core->buffered]);
+            if(result < 0) {
+                printf("Error: Core %d trace %s is malformed\n", i, core->trace_name);
+                return 1;
+            }
+            if(result == 0) {
+                core->done = 1;
+            } else {
+                core->buffered++;
+            }
+        }
+        if(core->buffered > 0) {
+            *any = 1;
+        }
+    }
+    return 0;
+}
+
+//Function to check whether the cores of an epoch only touch blocks that no other core touches in the
+//epoch or holds in its cache, in which case their order does not matter
+static bool epoch_is_private(struct multicore* mc) {
+    clear_block_map(&mc->epoch_owner);
+    for(int i = 0; i < mc->total_cores; i++) {
+        struct mesi_core* core = &mc->cores[i];
+        for(long j = 0; j < core->buffered; j++) {
+            unsigned long long block = (unsigned long long) core->buffer[j].addr >> mc->word_shift;
+            int owner;
+            if(block_map_get(&mc->epoch_owner, block, &owner)) {
+                if(owner != i) {
+                    return 0;
+                }
+                continue;
+            }
+            block_map_put(&mc->epoch_owner, block, i);
+
+            struct address_info info = cache_info_from_address(core->cache_mem, core->buffer[j].addr);
+            for(int k = 0; k < mc->total_cores; k++) {
+                if(k != i && holding_line(&mc->cores[k], info) >= 0) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+//Data structure to house the work of a host thread during a parallel epoch
+struct epoch_worker {
+    struct multicore* mc;
+    int first_core;
+    pthread_t thread;
+};
+
+//Function run by a host thread, simulating every threads-th core on its own
+static void* run_epoch_worker(void* arg) {
+    struct epoch_worker* worker = arg;
+    struct multicore* mc = worker->mc;
+    for(int i = worker->first_core; i < mc->total_cores; i += mc->threads) {
+        for(long j = 0; j < mc->cores[i].buffered; j++) {
+            coherent_access(mc, i, mc->cores[i].buffer[j], 0);
+        }
+    }
+    return NULL;
+}
+
+//Function to run an epoch in round-robin order, quantum records of a core at a time
+static void run_serial_epoch(struct multicore* mc) {
+    long position = 0;
+    bool any = 1;
+    while(any) {
+        any = 0;
+        for(int i = 0; i < mc->total_cores; i++) {
+            struct mesi_core* core = &mc->cores[i];
+            for(long j = position; j < position + mc->quantum && j < core->buffered; j++) {
+                coherent_access(mc, i, core->buffer[j], 1);
+                any = 1;
+            }
+        }
+        position += mc->quantum;
+    }
+}
+
+//Function to run all traces to the end and write every cache back to main memory, returns 4 if a trace is
+//malformed like process_trace
+int run_multicore(struct multicore* mc) {
+    bool any = 1;
+    while(1) {
+        if(fill_epoch(mc, &any)) {
+            return 4;
+        }
+        if(!any) {
+            break;
+        }
+
+        //Cores that share nothing during the epoch run at the same time on separate host threads
+        if(mc->threads > 1 && epoch_is_private(mc)) {
+            struct epoch_worker workers[MAX_CORES];
+            int total_workers = mc->threads < mc->total_cores ? mc->threads : mc->total_cores;
+            for(int i = 0; i < total_workers; i++) {
+                workers[i].mc = mc;
+                workers[i].first_core = i;
+                pthread_create(&workers[i].thread, NULL, run_epoch_worker, &workers[i]);
+            }
+            for(int i = 0; i < total_workers; i++) {
+                pthread_join(workers[i].thread, NULL);
+            }
+            mc->parallel_epochs++;
+        } else {
+            run_serial_epoch(mc);
+            mc->serial_epochs++;
+        }
+    }
+
+    //Only modified lines differ from main memory and a block is modified in at most one cache
+    for(int i = 0; i < mc->total_cores; i++) {
+        write_cache_to_memory(&mc->cores[i].cache_mem, mc->main_mem);
+    }
+    return 0;
+}
+
+//Function to print the statistics of every core and the coherence traffic
+void print_multicore_report(FILE* out, struct multicore* mc) {
+    struct cache_stats total = zero_stats();
+    struct coherence_stats coherence;
+    memset(&coherence, 0, sizeof(struct coherence_stats));
+
+    fprintf(out, "MULTI-CORE STATISTICS:\n");
+    fprintf(out, "%-5s %-10s %-10s %-10s %-10s %-9s %-10s %-10s %s\n", "Core", "Accesses", "Reads", "Writes",
+            "Misses", "MissRate", "Evictions", "DirtyEvict", "Trace");
+    for(int i = 0; i < mc->total_cores; i++) {
+        struct mesi_core* core = &mc->cores[i];
+        struct cache_stats stats = core->stats;
+        fprintf(out, "%-5d %-10ld %-10ld %-10ld %-10ld %-9.6f %-10ld %-10ld %s\n", i, stats.total_actions,
+                stats.total_reads, stats.total_writes, stats.total_misses,
+                stats.total_actions == 0 ? 0.0 : (double) stats.total_misses / (double) stats.total_actions,
+                stats.total_evictions, stats.dirty_evictions, core->trace_name);
+
+        total.total_actions += stats.total_actions;
+        total.total_reads += stats.total_reads;
+        total.total_writes += stats.total_writes;
+        total.total_misses += stats.total_misses;
+        total.total_evictions += stats.total_evictions;
+        total.dirty_evictions += stats.dirty_evictions;
+    }
+    fprintf(out, "%-5s %-10ld %-10ld %-10ld %-10ld %-9.6f %-10ld %-10ld\n\n", "All", total.total_actions,
+            total.total_reads, total.total_writes, total.total_misses,
+            total.total_actions == 0 ? 0.0 : (double) total.total_misses / (double) total.total_actions,
+            total.total_evictions, total.dirty_evictions);
+
+    fprintf(out, "MESI COHERENCE:\n");
+    fprintf(out, "%-5s %-9s %-9s %-9s %-9s %-9s %-13s %-9s %-9s %s\n", "Core", "BusRd", "BusRdX", "BusUpgr",
+            "InvSent", "InvRecv", "Interventions", "CohMiss", "TrueShr", "FalseShr");
+    for(int i = 0; i < mc->total_cores; i++) {
+        struct coherence_stats stats = mc->cores[i].coherence;
+        fprintf(out, "%-5d %-9ld %-9ld %-9ld %-9ld %-9ld %-13ld %-9ld %-9ld %ld\n", i, stats.bus_reads,
+                stats.bus_read_exclusives, stats.bus_upgrades, stats.invalidations_sent,
+                stats.invalidations_received, stats.interventions, stats.coherence_misses,
+                stats.true_sharing_misses, stats.false_sharing_misses);
+
+        coherence.bus_reads += stats.bus_reads;
+        coherence.bus_read_exclusives += stats.bus_read_exclusives;
+        coherence.bus_upgrades += stats.bus_upgrades;
+        coherence.invalidations_sent += stats.invalidations_sent;
+        coherence.invalidations_received += stats.invalidations_received;
+        coherence.interventions += stats.interventions;
+        coherence.coherence_misses += stats.coherence_misses;
+        coherence.true_sharing_misses += stats.true_sharing_misses;
+        coherence.false_sharing_misses += stats.false_sharing_misses;
+    }
+    fprintf(out, "%-5s %-9ld %-9ld %-9ld %-9ld %-9ld %-13ld %-9ld %-9ld %ld\n\n", "All", coherence.bus_reads,
+            coherence.bus_read_exclusives, coherence.bus_upgrades, coherence.invalidations_sent,
+            coherence.invalidations_received, coherence.interventions, coherence.coherence_misses,
+            coherence.true_sharing_misses, coherence.false_sharing_misses);
+
+    fprintf(out, "Round-robin quantum: %ld records, epochs run in parallel: %ld, serially: %ld\n",
+            mc->quantum, mc->parallel_epochs, mc->serial_epochs);
+}
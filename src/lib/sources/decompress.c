@@ -0,0 +1,261 @@
+#include <signal.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef CACHE_SIM_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CACHE_SIM_ZSTD
+#include <zstd.h>
+#endif
+#include "../headers/decompress.h"
+//
+// Compressed trace input, decompressed on a helper thread into a pipe the trace parser reads from
+//
+
+//Function to get the compression format of a file from its first bytes, a gzip member starts with 1F 8B
+//and a zstd frame with 28 B5 2F FD
+int compression_format(unsigned char* magic, size_t size) {
+    if(size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return COMPRESS_GZIP;
+    }
+    if(size >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return COMPRESS_ZSTD;
+    }
+    return COMPRESS_NONE;
+}
+
+//Function to get the name of a compression format
+char* compression_name(int format) {
+    switch(format) {
+        case COMPRESS_GZIP:
+            return "gzip";
+        case COMPRESS_ZSTD:
+            return "zstd";
+        default:
+            return "none";
+    }
+}
+
+#if defined(CACHE_SIM_ZLIB) || defined(CACHE_SIM_ZSTD)
+//Function to read the next compressed bytes, the bytes read to recognize the format come first
+static size_t read_compressed(struct decompressor* decompressor, unsigned char* buffer, size_t size) {
+    size_t read = 0;
+    if(decompressor->magic_size > 0) {
+        read = decompressor->magic_size < size ? decompressor->magic_size : size;
+        memcpy(buffer, decompressor->magic, read);
+        memmove(decompressor->magic, decompressor->magic + read, decompressor->magic_size - read);
+        decompressor->magic_size -= read;
+    }
+    return read + fread(buffer + read, 1, size - read, decompressor->in);
+}
+
+//Function to hand a decompressed chunk to the parser, returns non-zero if the parser stopped reading
+static int write_decompressed(struct decompressor* decompressor, unsigned char* data, size_t size) {
+    while(size > 0) {
+#ifdef _WIN32
+        int written = _write(decompressor->out_fd, data, (unsigned int) size);
+#else
+        ssize_t written = write(decompressor->out_fd, data, size);
+#endif
+        if(written <= 0) {
+            return 1;
+        }
+        data += written;
+        size -= (size_t) written;
+    }
+    return 0;
+}
+#endif
+
+#ifdef CACHE_SIM_ZLIB
+//Function to decompress a gzip file, one member after the other like gzip -d does. Returns non-zero if the
+//file is corrupt or truncated
+static int inflate_gzip(struct decompressor* decompressor, unsigned char* in, unsigned char* out) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    //Window bits above 15 select the gzip wrapper instead of the zlib one
+    if(inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return 1;
+    }
+
+    int status = Z_OK;
+    bool ended = 0;
+    //More output may be pending inside zlib while the last chunk came back full, even without input left,
+    //unless the member ended with that chunk
+    bool full = 0;
+    while(1) {
+        if(stream.avail_in == 0 && !full) {
+            stream.avail_in = (uInt) read_compressed(decompressor, in, DECOMPRESS_CHUNK_SIZE);
+            stream.next_in = in;
+            if(stream.avail_in == 0) {
+                break;
+            }
+        }
+        //A member ended and more bytes follow, so another member starts. The bytes are read first, so that a
+        //file ending right after a member is not taken for a truncated next member
+        if(ended) {
+            inflateReset(&stream);
+            ended = 0;
+        }
+
+        stream.avail_out = DECOMPRESS_CHUNK_SIZE;
+        stream.next_out = out;
+        status = inflate(&stream, Z_NO_FLUSH);
+        if(status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            break;
+        }
+        if(write_decompressed(decompressor, out, DECOMPRESS_CHUNK_SIZE - stream.avail_out)) {
+            inflateEnd(&stream);
+            return 0;
+        }
+        ended = status == Z_STREAM_END;
+        full = !ended && stream.avail_out == 0;
+    }
+    inflateEnd(&stream);
+    return !ended || ferror(decompressor->in);
+}
+#endif
+
+#ifdef CACHE_SIM_ZSTD
+//Function to decompress a zstd file of one or more frames. Returns non-zero if the file is corrupt or
+//truncated
+static int decompress_zstd(struct decompressor* decompressor, unsigned char* in, unsigned char* out) {
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if(!stream) {
+        return 1;
+    }
+    ZSTD_initDStream(stream);
+
+    //A hint of 0 means the last frame was complete
+    size_t hint = 1;
+    int status = 0;
+    bool full = 0;
+    ZSTD_inBuffer input = {in, 0, 0};
+    while(status == 0) {
+        if(input.pos == input.size && !full) {
+            input.size = read_compressed(decompressor, in, DECOMPRESS_CHUNK_SIZE);
+            input.pos = 0;
+            if(input.size == 0) {
+                break;
+            }
+        }
+
+        ZSTD_outBuffer output = {out, DECOMPRESS_CHUNK_SIZE, 0};
+        hint = ZSTD_decompressStream(stream, &output, &input);
+        if(ZSTD_isError(hint)) {
+            status = 1;
+        } else if(write_decompressed(decompressor, out, output.pos)) {
+            hint = 0;
+            break;
+        }
+        //A frame that ended with a full chunk has flushed everything, the next bytes start another frame
+        full = hint != 0 && output.pos == output.size;
+    }
+    ZSTD_freeDStream(stream);
+    return status != 0 || hint != 0 || ferror(decompressor->in);
+}
+#endif
+
+//Function run by the helper thread, decompressing the whole file into the pipe and closing it at the end
+static void* run_decompressor(void* arg) {
+    struct decompressor* decompressor = arg;
+#ifndef _WIN32
+    //A parser that stops early closes its end of the pipe, which has to fail the writes of this thread
+    //instead of raising SIGPIPE
+    sigset_t pipe_signal;
+    sigemptyset(&pipe_signal);
+    sigaddset(&pipe_signal, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_signal, NULL);
+#endif
+
+    unsigned char* in = malloc(DECOMPRESS_CHUNK_SIZE);
+    unsigned char* out = malloc(DECOMPRESS_CHUNK_SIZE);
+    decompressor->failed = 1;
+    if(in && out) {
+#ifdef CACHE_SIM_ZLIB
+        if(decompressor->format == COMPRESS_GZIP) {
+            decompressor->failed = inflate_gzip(decompressor, in, out);
+        }
+#endif
+#ifdef CACHE_SIM_ZSTD
+        if(decompressor->format == COMPRESS_ZSTD) {
+            decompressor->failed = decompress_zstd(decompressor, in, out);
+        }
+#endif
+    }
+    free(in);
+    free(out);
+
+#ifdef _WIN32
+    _close(decompressor->out_fd);
+#else
+    close(decompressor->out_fd);
+#endif
+    return NULL;
+}
+
+//Function to start decompressing a file on a helper thread, handing back the stream of decompressed bytes.
+//The bytes read to recognize the format are passed along. Returns non-zero after printing the reason if
+//the format was not built in or the thread cannot be started
+int start_decompressor(struct decompressor* decompressor, FILE* in, unsigned char* magic, size_t magic_size,
+                       FILE** out) {
+    memset(decompressor, 0, sizeof(struct decompressor));
+    decompressor->format = compression_format(magic, magic_size);
+    decompressor->in = in;
+    memcpy(decompressor->magic, magic, magic_size);
+    decompressor->magic_size = magic_size;
+
+    bool available = 0;
+#ifdef CACHE_SIM_ZLIB
+    available |= decompressor->format == COMPRESS_GZIP;
+#endif
+#ifdef CACHE_SIM_ZSTD
+    available |= decompressor->format == COMPRESS_ZSTD;
+#endif
+    if(!available) {
+        printf("Error: Input file is %s compressed, rebuild with %s installed to read it\n",
+               compression_name(decompressor->format), decompressor->format == COMPRESS_GZIP ? "zlib" : "zstd");
+        return 1;
+    }
+
+    int fds[2];
+#ifdef _WIN32
+    if(_pipe(fds, DECOMPRESS_CHUNK_SIZE, _O_BINARY) != 0) {
+#else
+    if(pipe(fds) != 0) {
+#endif
+        printf("Error: Could not start decompressing the input file\n");
+        return 1;
+    }
+    decompressor->out_fd = fds[1];
+    *out = fdopen(fds[0], "rb");
+    if(!*out || pthread_create(&decompressor->thread, NULL, run_decompressor, decompressor) != 0) {
+        printf("Error: Could not start decompressing the input file\n");
+        if(*out) {
+            fclose(*out);
+            *out = NULL;
+        } else {
+            close(fds[0]);
+        }
+        close(fds[1]);
+        return 1;
+    }
+    return 0;
+}
+
+//Function to wait for the helper thread and close the compressed file. A parser stopping early has to close
+//the decompressed stream first. Returns non-zero after printing the reason if the file was corrupt
+int finish_decompressor(struct decompressor* decompressor) {
+    pthread_join(decompressor->thread, NULL);
+    fclose(decompressor->in);
+    decompressor->in = NULL;
+    if(decompressor->failed) {
+        printf("Error: Compressed input file is corrupt or truncated\n");
+        return 1;
+    }
+    return 0;
+}
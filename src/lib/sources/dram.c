@@ -0,0 +1,131 @@
+#include "../headers/dram.h"
+//
+// DRAM back end behind a cache, timing the line fills and write-backs with a row buffer per bank
+//
+
+//Function for initializing the DRAM, the channels and banks must be powers of two. Every bank starts
+//precharged
+int init_dram(struct dram* dram, int channels, int banks, int policy, int t_cas, int t_rcd, int t_rp) {
+    memset(dram, 0, sizeof(struct dram));
+    if(channels < 1 || channels > DRAM_MAX_CHANNELS || (channels & (channels - 1)) != 0
+            || banks < 1 || banks > DRAM_MAX_BANKS || (banks & (banks - 1)) != 0) {
+        printf("Error: DRAM needs a power of two of at most %d channels and %d banks, got %d and %d\n",
+               DRAM_MAX_CHANNELS, DRAM_MAX_BANKS, channels, banks);
+        return 1;
+    }
+    dram->channels = channels;
+    dram->banks = banks;
+    dram->policy = policy;
+    dram->t_cas = t_cas;
+    dram->t_rcd = t_rcd;
+    dram->t_rp = t_rp;
+
+    dram->open_rows = malloc(channels * banks * sizeof(long));
+    dram->bank_requests = calloc(channels * banks, sizeof(long));
+    dram->bank_hits = calloc(channels * banks, sizeof(long));
+    if(!dram->open_rows || !dram->bank_requests || !dram->bank_hits) {
+        printf("Error: Could not allocate memory for the DRAM\n");
+        free_dram(dram);
+        return 1;
+    }
+    for(int i = 0; i < channels * banks; i++) {
+        dram->open_rows[i] = -1;
+    }
+    return 0;
+}
+
+//Function to free the memory allocated to the DRAM
+void free_dram(struct dram* dram) {
+    free(dram->open_rows);
+    free(dram->bank_requests);
+    free(dram->bank_hits);
+    dram->open_rows = NULL;
+    dram->bank_requests = NULL;
+    dram->bank_hits = NULL;
+}
+
+//Function to time a request of a number of bytes starting at a word address, a fill of the cache reads and
+//a write-back writes. The row buffer of the bank decides the cost of opening the row, and the bytes take
+//one burst per DRAM_BURST_BYTES. Returns the latency in memory cycles
+long dram_access(struct dram* dram, INT_TYPE addr, int bytes, bool write) {
+    unsigned long long row_number = (unsigned long long) addr * WORD_SIZE / DRAM_ROW_SIZE;
+    int channel = (int) (row_number % (unsigned long long) dram->channels);
+    int bank = (int) (row_number / (unsigned long long) dram->channels % (unsigned long long) dram->banks);
+    long row = (long) (row_number / (unsigned long long) dram->channels / (unsigned long long) dram->banks);
+    int index = channel * dram->banks + bank;
+
+    int outcome;
+    long latency = dram->t_cas;
+    if(dram->open_rows[index] == row) {
+        outcome = DRAM_ROW_HIT;
+    } else if(dram->open_rows[index] < 0) {
+        outcome = DRAM_ROW_MISS;
+        latency += dram->t_rcd;
+    } else {
+        outcome = DRAM_ROW_CONFLICT;
+        latency += dram->t_rp + dram->t_rcd;
+    }
+    latency += (long) ((bytes + DRAM_BURST_BYTES - 1) / DRAM_BURST_BYTES) * DRAM_BURST_CYCLES;
+
+    //A closed page policy precharges the bank right after the access, off the path of the next request
+    dram->open_rows[index] = dram->policy == DRAM_PAGE_OPEN ? row : -1;
+    dram->bank_requests[index]++;
+    dram->bank_hits[index] += outcome == DRAM_ROW_HIT;
+
+    struct dram_counts* counts = write ? &dram->writes : &dram->reads;
+    counts->requests++;
+    counts->outcomes[outcome]++;
+    counts->bytes += bytes;
+    counts->cycles += latency;
+    return latency;
+}
+
+//Function to print one row of the request counts
+static void print_dram_counts(FILE* out, char* title, struct dram_counts counts) {
+    fprintf(out, "%-7s %-10ld %-10ld %-10ld %-10ld %-10.6f %.2f\n", title, counts.requests,
+            counts.outcomes[DRAM_ROW_HIT], counts.outcomes[DRAM_ROW_MISS], counts.outcomes[DRAM_ROW_CONFLICT],
+            counts.requests == 0 ? 0.0 : (double) counts.outcomes[DRAM_ROW_HIT] / (double) counts.requests,
+            counts.requests == 0 ? 0.0 : (double) counts.cycles / (double) counts.requests);
+}
+
+//Function to print the row buffer outcomes and latencies of the reads and writes, and the requests of every
+//channel
+void print_dram_report(FILE* out, struct dram* dram) {
+    fprintf(out, "DRAM:\n");
+    fprintf(out, "Channels: %d, banks per channel: %d, row size: %d bytes, page policy: %s\n", dram->channels,
+            dram->banks, DRAM_ROW_SIZE, dram->policy == DRAM_PAGE_OPEN ? "open" : "closed");
+    fprintf(out, "Timing in memory cycles: CAS %d, RCD %d, RP %d, burst %d per %d bytes\n", dram->t_cas,
+            dram->t_rcd, dram->t_rp, DRAM_BURST_CYCLES, DRAM_BURST_BYTES);
+
+    struct dram_counts total = dram->reads;
+    total.requests += dram->writes.requests;
+    total.bytes += dram->writes.bytes;
+    total.cycles += dram->writes.cycles;
+    for(int i = 0; i < DRAM_OUTCOMES; i++) {
+        total.outcomes[i] += dram->writes.outcomes[i];
+    }
+    fprintf(out, "%-7s %-10s %-10s %-10s %-10s %-10s %s\n", "Kind", "Requests", "RowHits", "RowMisses",
+            "Conflicts", "HitRate", "AvgLatency");
+    print_dram_counts(out, "Reads", dram->reads);
+    print_dram_counts(out, "Writes", dram->writes);
+    print_dram_counts(out, "Total", total);
+    fprintf(out, "Bytes read: %ld, bytes written: %ld\n", dram->reads.bytes, dram->writes.bytes);
+
+    fprintf(out, "\n%-8s %-10s %-10s %s\n", "Channel", "Requests", "HitRate", "BusiestBank");
+    for(int i = 0; i < dram->channels; i++) {
+        long requests = 0;
+        long hits = 0;
+        int busiest = 0;
+        for(int j = 0; j < dram->banks; j++) {
+            int index = i * dram->banks + j;
+            requests += dram->bank_requests[index];
+            hits += dram->bank_hits[index];
+            if(dram->bank_requests[index] > dram->bank_requests[i * dram->banks + busiest]) {
+                busiest = j;
+            }
+        }
+        fprintf(out, "%-8d %-10ld %-10.6f %d (%ld requests)\n", i, requests,
+                requests == 0 ? 0.0 : (double) hits / (double) requests, busiest,
+                dram->bank_requests[i * dram->banks + busiest]);
+    }
+}
@@ -0,0 +1,206 @@
+#include "../headers/gen.h"
+//
+// Seeded synthetic trace generation for scaling and stress benchmarks
+//
+
+static const char* PATTERN_NAMES[GEN_PATTERNS] = {"seq", "stride", "uniform", "zipf", "chase", "conflict"};
+
+//Function for setting the values of a generator config to the defaults
+struct gen_config zero_gen_config() {
+    struct gen_config primer;
+
+    primer.pattern = GEN_SEQUENTIAL;
+    primer.length = 1000000;
+    primer.seed = 1;
+    primer.write_percent = 30;
+    primer.base = 0;
+    primer.footprint = 1048576;
+    primer.stride = 16;
+    primer.zipf_exponent = 0.99;
+    primer.conflict_lines = 0;
+
+    return primer;
+}
+
+//Function to look up a pattern by name, returns -1 if there is no such pattern
+int gen_pattern_from_name(char* name) {
+    for(int i = 0; i < GEN_PATTERNS; i++) {
+        if(strcmp(name, PATTERN_NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//Function to get the name of a pattern
+const char* gen_pattern_name(int pattern) {
+    return PATTERN_NAMES[pattern];
+}
+
+//Function to draw the next 64-bit random value, xorshift64*
+static unsigned long long gen_random(struct generator* gen) {
+    gen->state ^= gen->state >> 12;
+    gen->state ^= gen->state << 25;
+    gen->state ^= gen->state >> 27;
+    return gen->state * 2685821657736338717ULL;
+}
+
+//Function to draw a random value in [0, bound)
+static long gen_below(struct generator* gen, long bound) {
+    return (long) (gen_random(gen) % (unsigned long long) bound);
+}
+
+//Function to draw a uniform double in [0, 1)
+static double gen_unit(struct generator* gen) {
+    return (double) (gen_random(gen) >> 11) / 9007199254740992.0;
+}
+
+//Function for initializing a generator, the cache geometry is only needed by the conflict pattern
+int init_generator(struct generator* gen, struct gen_config config, struct cache cache_mem) {
+    memset(gen, 0, sizeof(struct generator));
+    long memory_words = MM_SIZE / WORD_SIZE;
+
+    if(config.write_percent < 0 || config.write_percent > 100) {
+        printf("Error: Generator write percentage must be between 0 and 100\n");
+        return 1;
+    }
+    if((long) config.base >= memory_words) {
+        printf("Error: Generator base address must be inside the %ld words of main memory\n", memory_words);
+        return 1;
+    }
+    //Keep every generated address inside main memory
+    if(config.footprint > memory_words - (long) config.base) {
+        config.footprint = memory_words - (long) config.base;
+    }
+    if(config.footprint <= 0 || config.stride <= 0) {
+        printf("Error: Generator footprint and stride must be positive\n");
+        return 1;
+    }
+
+    //Seed through splitmix64 so that neighbouring seeds give unrelated streams, xorshift needs a non-zero state
+    unsigned long long z = config.seed + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    gen->state = (z ^ (z >> 31)) | 1;
+
+    if(config.pattern == GEN_ZIPF) {
+        if(config.zipf_exponent <= 0.0 || config.zipf_exponent >= 1.0) {
+            printf("Error: Zipf exponent must be between 0 and 1\n");
+            return 1;
+        }
+        //Constants of the Gray et al. rejection-free Zipf sampler over the footprint words
+        double theta = config.zipf_exponent;
+        double zeta_2 = 1.0 + pow(0.5, theta);
+        for(long i = 1; i <= config.footprint; i++) {
+            gen->zeta_n += 1.0 / pow((double) i, theta);
+        }
+        gen->zipf_alpha = 1.0 / (1.0 - theta);
+        gen->zipf_eta = (1.0 - pow(2.0 / (double) config.footprint, 1.0 - theta)) / (1.0 - zeta_2 / gen->zeta_n);
+        gen->zipf_half = zeta_2;
+    } else if(config.pattern == GEN_CHASE) {
+        gen->chase_nodes = config.footprint / config.stride;
+        if(gen->chase_nodes < 2) {
+            printf("Error: Pointer chasing needs a footprint of at least two strides\n");
+            return 1;
+        }
+        gen->chase = malloc(gen->chase_nodes * sizeof(unsigned int));
+        if(!gen->chase) {
+            printf("Error: Could not allocate memory for the pointer chasing nodes\n");
+            return 1;
+        }
+        //Sattolo's algorithm turns the identity into a random permutation made of one single cycle
+        for(long i = 0; i < gen->chase_nodes; i++) {
+            gen->chase[i] = (unsigned int) i;
+        }
+        for(long i = gen->chase_nodes - 1; i > 0; i--) {
+            long j = gen_below(gen, i);
+            unsigned int swap = gen->chase[i];
+            gen->chase[i] = gen->chase[j];
+            gen->chase[j] = swap;
+        }
+    } else if(config.pattern == GEN_CONFLICT) {
+        if(cache_mem.size == 0 || cache_mem.line_size == 0 || cache_mem.associativity == 0) {
+            printf("Error: The conflict pattern needs the cache capacity, block size, and associativity\n");
+            return 1;
+        }
+        //Addresses one cache way apart all land in the same set
+        long total_sets = (long) cache_mem.size / cache_mem.line_size / cache_mem.associativity;
+        gen->conflict_stride = total_sets * (cache_mem.line_size / WORD_SIZE);
+        if(config.conflict_lines <= 0) {
+            config.conflict_lines = cache_mem.associativity + 1;
+        }
+        if((config.conflict_lines - 1) * gen->conflict_stride >= config.footprint) {
+            printf("Error: The conflict lines do not fit in the generator footprint\n");
+            return 1;
+        }
+    }
+
+    gen->config = config;
+    return 0;
+}
+
+//Function to free the memory allocated to a generator
+void free_generator(struct generator* gen) {
+    free(gen->chase);
+    gen->chase = NULL;
+}
+
+//Function to produce the next record, returns 0 once the configured length has been generated
+int gen_next(struct generator* gen, struct trace_record* record) {
+    if(gen->produced == gen->config.length) {
+        return 0;
+    }
+
+    long offset = 0;
+    switch(gen->config.pattern) {
+        case GEN_SEQUENTIAL:
+            offset = gen->position % gen->config.footprint;
+            break;
+        case GEN_STRIDED:
+            offset = (gen->position * gen->config.stride) % gen->config.footprint;
+            break;
+        case GEN_UNIFORM:
+            offset = gen_below(gen, gen->config.footprint);
+            break;
+        case GEN_ZIPF: {
+            //Rank 0 is the hottest word, so the hot set sits at the start of the footprint
+            double u = gen_unit(gen);
+            double uz = u * gen->zeta_n;
+            if(uz < 1.0) {
+                offset = 0;
+            } else if(uz < gen->zipf_half) {
+                offset = 1;
+            } else {
+                offset = (long) ((double) gen->config.footprint * pow(gen->zipf_eta * u - gen->zipf_eta + 1.0,
+                                                                      gen->zipf_alpha));
+            }
+            if(offset >= gen->config.footprint) {
+                offset = gen->config.footprint - 1;
+            }
+            break;
+        }
+        case GEN_CHASE:
+            gen->position = gen->produced == 0 ? 0 : gen->chase[gen->position];
+            offset = gen->position * gen->config.stride;
+            break;
+        case GEN_CONFLICT:
+            offset = (gen->position % gen->config.conflict_lines) * gen->conflict_stride;
+            break;
+    }
+    if(gen->config.pattern != GEN_CHASE) {
+        gen->position++;
+    }
+
+    record->addr = (INT_TYPE) (gen->config.base + offset);
+    record->op = CACHE_READ;
+    record->val = 0;
+    record->size = 0;
+    record->pc = 0;
+    if(gen->config.write_percent > 0 && gen_below(gen, 100) < gen->config.write_percent) {
+        record->op = CACHE_WRITE;
+        record->val = (INT_TYPE) gen_random(gen);
+    }
+
+    gen->produced++;
+    return 1;
+}
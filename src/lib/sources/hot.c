@@ -0,0 +1,372 @@
+#include "../headers/hot.h"
+//
+// Hot address and region attribution of misses and dirty evictions
+//
+
+//Function to hash a key into a Space-Saving table
+static long ss_hash(INT_TYPE key, long table_size) {
+    unsigned long long x = (unsigned long long) key;
+    x *= 0x9E3779B97F4A7C15ULL;
+    return (long) ((x >> 32) & (unsigned long long) (table_size - 1));
+}
+
+//Function for initializing a Space-Saving summary which keeps capacity counters
+int init_space_saving(struct space_saving* summary, long capacity) {
+    memset(summary, 0, sizeof(struct space_saving));
+    summary->capacity = capacity;
+    summary->table_size = 16;
+    while(summary->table_size < capacity * 2) {
+        summary->table_size *= 2;
+    }
+
+    summary->heap = calloc(capacity, sizeof(struct ss_counter));
+    summary->table_keys = calloc(summary->table_size, sizeof(INT_TYPE));
+    summary->table_heap = malloc(summary->table_size * sizeof(long));
+    if(!summary->heap || !summary->table_keys || !summary->table_heap) {
+        free_space_saving(summary);
+        return 1;
+    }
+    for(long i = 0; i < summary->table_size; i++) {
+        summary->table_heap[i] = -1;
+    }
+
+    return 0;
+}
+
+//Function to free the memory allocated to a Space-Saving summary
+void free_space_saving(struct space_saving* summary) {
+    free(summary->heap);
+    free(summary->table_keys);
+    free(summary->table_heap);
+    memset(summary, 0, sizeof(struct space_saving));
+}
+
+//Function to swap two heap counters and keep the table pointing at them
+static void ss_swap(struct space_saving* summary, long a, long b) {
+    struct ss_counter counter = summary->heap[a];
+    summary->heap[a] = summary->heap[b];
+    summary->heap[b] = counter;
+    summary->table_heap[summary->heap[a].table_index] = a;
+    summary->table_heap[summary->heap[b].table_index] = b;
+}
+
+//Function to move a counter down the min heap after its count grew
+static void ss_sift_down(struct space_saving* summary, long i) {
+    while(i * 2 + 1 < summary->size) {
+        long child = i * 2 + 1;
+        if(child + 1 < summary->size && summary->heap[child + 1].count < summary->heap[child].count) {
+            child++;
+        }
+        if(summary->heap[child].count >= summary->heap[i].count) {
+            break;
+        }
+        ss_swap(summary, i, child);
+        i = child;
+    }
+}
+
+//Function to insert a key into the table pointing at a heap position
+static long ss_table_insert(struct space_saving* summary, INT_TYPE key, long heap_index) {
+    long i = ss_hash(key, summary->table_size);
+    while(summary->table_heap[i] >= 0) {
+        i = (i + 1) & (summary->table_size - 1);
+    }
+    summary->table_keys[i] = key;
+    summary->table_heap[i] = heap_index;
+    return i;
+}
+
+//Function to remove a table entry with backward shift deletion
+static void ss_table_remove(struct space_saving* summary, long index) {
+    long hole = index;
+    long i = (index + 1) & (summary->table_size - 1);
+    while(summary->table_heap[i] >= 0) {
+        long home = ss_hash(summary->table_keys[i], summary->table_size);
+        if(((i - home) & (summary->table_size - 1)) >= ((i - hole) & (summary->table_size - 1))) {
+            summary->table_keys[hole] = summary->table_keys[i];
+            summary->table_heap[hole] = summary->table_heap[i];
+            summary->heap[summary->table_heap[hole]].table_index = hole;
+            hole = i;
+        }
+        i = (i + 1) & (summary->table_size - 1);
+    }
+    summary->table_heap[hole] = -1;
+}
+
+//Function to count one occurrence of a key
+void space_saving_add(struct space_saving* summary, INT_TYPE key) {
+    //Already tracked, bump its count
+    long i = ss_hash(key, summary->table_size);
+    while(summary->table_heap[i] >= 0) {
+        if(summary->table_keys[i] == key) {
+            long heap_index = summary->table_heap[i];
+            summary->heap[heap_index].count++;
+            ss_sift_down(summary, heap_index);
+            return;
+        }
+        i = (i + 1) & (summary->table_size - 1);
+    }
+
+    if(summary->size < summary->capacity) {
+        //Room left, a new counter with a count of one always belongs at the top of the min heap
+        long heap_index = summary->size++;
+        summary->heap[heap_index].key = key;
+        summary->heap[heap_index].count = 1;
+        summary->heap[heap_index].error = 0;
+        summary->heap[heap_index].table_index = ss_table_insert(summary, key, heap_index);
+        while(heap_index > 0 && summary->heap[(heap_index - 1) / 2].count > 1) {
+            ss_swap(summary, heap_index, (heap_index - 1) / 2);
+            heap_index = (heap_index - 1) / 2;
+        }
+        return;
+    }
+
+    //Full, the new key takes over the smallest counter and inherits its count as error
+    long minimum = summary->heap[0].count;
+    ss_table_remove(summary, summary->heap[0].table_index);
+    summary->heap[0].key = key;
+    summary->heap[0].count = minimum + 1;
+    summary->heap[0].error = minimum;
+    summary->heap[0].table_index = ss_table_insert(summary, key, 0);
+    ss_sift_down(summary, 0);
+}
+
+//Function for initializing hot address tracking for a cache
+int init_hot_tracker(struct hot_tracker* hot, struct cache cache_mem, int top, long counters) {
+    memset(hot, 0, sizeof(struct hot_tracker));
+    hot->top = top;
+    hot->word_shift = (int) log2(cache_mem.words_per_line);
+    hot->total_sets = cache_mem.total_sets;
+    hot->geometry = zero_cache();
+    hot->geometry.line_size = cache_mem.line_size;
+    hot->geometry.words_per_line = cache_mem.words_per_line;
+    hot->geometry.total_sets = cache_mem.total_sets;
+    hot->geometry.index_function = cache_mem.index_function;
+    hot->geometry.index_bits = cache_mem.index_bits;
+    hot->geometry.index_prime = cache_mem.index_prime;
+
+    hot->set_misses = calloc(cache_mem.total_sets, sizeof(long));
+    if(!hot->set_misses || init_space_saving(&hot->line_misses, counters)
+            || init_space_saving(&hot->line_dirty_evictions, counters)) {
+        printf("Error: Could not allocate memory for the hot address tracking\n");
+        free_hot_tracker(hot);
+        return 1;
+    }
+
+    return 0;
+}
+
+//Function to order regions by start address
+static int compare_regions(const void* a, const void* b) {
+    const struct hot_region* left = a;
+    const struct hot_region* right = b;
+    return (left->start > right->start) - (left->start < right->start);
+}
+
+//Function to load a region map file. Every line holds a start address, an end address (exclusive), and a
+//name. Addresses are in hex like the trace, and lines starting with # are comments
+int load_region_map(struct hot_tracker* hot, char* path) {
+    FILE* map_file = fopen(path, "r");
+    if(!map_file) {
+        printf("Error: Region map file could not be read!\n");
+        return 1;
+    }
+
+    char* line = NULL;
+    size_t len = 0;
+    long capacity = 0;
+    int line_num = 1;
+    int status = 0;
+
+    while(getline(&line, &len, map_file) != -1) {
+        unsigned long long start;
+        unsigned long long end;
+        char name[REGION_NAME_SIZE];
+
+        //Skip blank lines and comments
+        char* first = line;
+        while(*first == ' ' || *first == '\t') {
+            first++;
+        }
+        if(*first == '#' || *first == '\n' || *first == '\r' || *first == '\0') {
+            line_num++;
+            continue;
+        }
+
+        if(sscanf(line, "%llx %llx %63s", &start, &end, name) != 3 || end <= start) {
+            printf("Error: Malformed region on line %d of the region map\n", line_num);
+            status = 1;
+            break;
+        }
+
+        if(hot->total_regions == capacity) {
+            capacity = capacity == 0 ? 16 : capacity * 2;
+            struct hot_region* regions = realloc(hot->regions, capacity * sizeof(struct hot_region));
+            if(!regions) {
+                printf("Error: Could not allocate memory for the region map\n");
+                status = 1;
+                break;
+            }
+            hot->regions = regions;
+        }
+
+        struct hot_region* region = &hot->regions[hot->total_regions++];
+        memset(region, 0, sizeof(struct hot_region));
+        strcpy(region->name, name);
+        region->start = (INT_TYPE) start;
+        region->end = (INT_TYPE) end;
+        line_num++;
+    }
+
+    if(line) {
+        free(line);
+    }
+    fclose(map_file);
+
+    if(status == 0) {
+        qsort(hot->regions, hot->total_regions, sizeof(struct hot_region), compare_regions);
+    }
+    return status;
+}
+
+//Function to free the memory allocated to hot address tracking
+void free_hot_tracker(struct hot_tracker* hot) {
+    free(hot->set_misses);
+    free(hot->regions);
+    hot->set_misses = NULL;
+    hot->regions = NULL;
+    free_space_saving(&hot->line_misses);
+    free_space_saving(&hot->line_dirty_evictions);
+}
+
+//Function to find the region holding an address, or NULL if it is outside every region
+static struct hot_region* find_region(struct hot_tracker* hot, INT_TYPE addr) {
+    //Binary search for the last region starting at or before the address
+    long low = 0;
+    long high = hot->total_regions - 1;
+    long found = -1;
+    while(low <= high) {
+        long middle = low + (high - low) / 2;
+        if(hot->regions[middle].start <= addr) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    if(found >= 0 && addr < hot->regions[found].end) {
+        return &hot->regions[found];
+    }
+    return NULL;
+}
+
+//Function to record a miss of an address which maps to the given set
+void hot_record_miss(struct hot_tracker* hot, INT_TYPE addr, INT_TYPE set) {
+    space_saving_add(&hot->line_misses, addr >> hot->word_shift);
+    hot->set_misses[set]++;
+
+    if(hot->total_regions > 0) {
+        struct hot_region* region = find_region(hot, addr);
+        if(region) {
+            region->misses++;
+        } else {
+            hot->unmapped_misses++;
+        }
+    }
+}
+
+//Function to record the eviction of a dirty line starting at the given address
+void hot_record_dirty_eviction(struct hot_tracker* hot, INT_TYPE addr) {
+    space_saving_add(&hot->line_dirty_evictions, addr >> hot->word_shift);
+
+    if(hot->total_regions > 0) {
+        struct hot_region* region = find_region(hot, addr);
+        if(region) {
+            region->dirty_evictions++;
+        } else {
+            hot->unmapped_dirty_evictions++;
+        }
+    }
+}
+
+//Function to order counters from the largest count down
+static int compare_counters(const void* a, const void* b) {
+    const struct ss_counter* left = a;
+    const struct ss_counter* right = b;
+    return (left->count < right->count) - (left->count > right->count);
+}
+
+//Function to print the top counters of a Space-Saving summary as cache lines
+static void print_top_lines(FILE* out, struct hot_tracker* hot, struct space_saving* summary, char* title) {
+    struct ss_counter* sorted = malloc((summary->size + 1) * sizeof(struct ss_counter));
+    if(!sorted) {
+        return;
+    }
+    memcpy(sorted, summary->heap, summary->size * sizeof(struct ss_counter));
+    qsort(sorted, summary->size, sizeof(struct ss_counter), compare_counters);
+
+    fprintf(out, "%s\n", title);
+    fprintf(out, "%-10s %-10s %-6s %-10s %s\n", "Address", "Tag", "Set", "Count", "Error");
+    for(long i = 0; i < summary->size && i < hot->top; i++) {
+        INT_TYPE addr = sorted[i].key << hot->word_shift;
+        struct address_info info = cache_info_from_address(hot->geometry, addr);
+        fprintf(out, "%08llX   %08llX   %-6llu %-10ld %ld\n", (unsigned long long) addr,
+                (unsigned long long) info.tag, (unsigned long long) info.set, sorted[i].count, sorted[i].error);
+    }
+    fprintf(out, "\n");
+
+    free(sorted);
+}
+
+//Function to order regions from the most misses down
+static int compare_region_misses(const void* a, const void* b) {
+    const struct hot_region* left = a;
+    const struct hot_region* right = b;
+    return (left->misses < right->misses) - (left->misses > right->misses);
+}
+
+//Function to print the hot lines, sets, and regions
+void print_hot_report(FILE* out, struct hot_tracker* hot) {
+    fprintf(out, "HOT ADDRESSES:\n");
+    print_top_lines(out, hot, &hot->line_misses, "Lines with the most misses:");
+    print_top_lines(out, hot, &hot->line_dirty_evictions, "Lines with the most dirty evictions:");
+
+    //Sets are few enough to count exactly, pick the top ones with a partial selection
+    fprintf(out, "Sets with the most misses:\n");
+    fprintf(out, "%-6s %s\n", "Set", "Misses");
+    bool* printed = calloc(hot->total_sets, sizeof(bool));
+    for(int n = 0; printed && n < hot->top && n < hot->total_sets; n++) {
+        int best = -1;
+        for(int i = 0; i < hot->total_sets; i++) {
+            if(!printed[i] && (best < 0 || hot->set_misses[i] > hot->set_misses[best])) {
+                best = i;
+            }
+        }
+        printed[best] = 1;
+        fprintf(out, "%-6d %ld\n", best, hot->set_misses[best]);
+    }
+    free(printed);
+    fprintf(out, "\n");
+
+    if(hot->total_regions > 0) {
+        struct hot_region* sorted = malloc(hot->total_regions * sizeof(struct hot_region));
+        if(!sorted) {
+            return;
+        }
+        memcpy(sorted, hot->regions, hot->total_regions * sizeof(struct hot_region));
+        qsort(sorted, hot->total_regions, sizeof(struct hot_region), compare_region_misses);
+
+        fprintf(out, "Regions with the most misses:\n");
+        fprintf(out, "%-24s %-10s %-10s %-10s %s\n", "Region", "Start", "End", "Misses", "DirtyEvictions");
+        for(long i = 0; i < hot->total_regions && i < hot->top; i++) {
+            fprintf(out, "%-24s %08llX   %08llX   %-10ld %ld\n", sorted[i].name,
+                    (unsigned long long) sorted[i].start, (unsigned long long) sorted[i].end,
+                    sorted[i].misses, sorted[i].dirty_evictions);
+        }
+        fprintf(out, "%-24s %-10s %-10s %-10ld %ld\n\n", "(unmapped)", "", "", hot->unmapped_misses,
+                hot->unmapped_dirty_evictions);
+
+        free(sorted);
+    }
+}
@@ -0,0 +1,162 @@
+#include "../headers/instrument.h"
+//
+// Optional cache instrumentation: reuse distances, per-set counters, and 3C miss classification
+//
+
+//Function for initializing the instrumentation of a cache
+int init_cache_instr(struct cache_instr* instr, struct cache cache_mem) {
+    memset(instr, 0, sizeof(struct cache_instr));
+    instr->word_shift = (int) log2(cache_mem.words_per_line);
+    instr->total_lines = cache_mem.total_lines;
+    instr->total_sets = cache_mem.total_sets;
+
+    instr->sets = calloc(cache_mem.total_sets, sizeof(struct set_counters));
+    if(!instr->sets || init_lru_stack(&instr->shadow, cache_mem.total_lines * 4)) {
+        printf("Error: Could not allocate memory for the cache instrumentation\n");
+        free(instr->sets);
+        instr->sets = NULL;
+        return 1;
+    }
+
+    return 0;
+}
+
+//Function to free the memory allocated to the instrumentation of a cache
+void free_cache_instr(struct cache_instr* instr) {
+    free(instr->sets);
+    instr->sets = NULL;
+    free_lru_stack(&instr->shadow);
+}
+
+//Function to record a single cache access. load_status is the status returned by load_line on a miss
+void instr_record(struct cache_instr* instr, INT_TYPE addr, INT_TYPE set, bool hit, int load_status) {
+    long distance = lru_stack_access(&instr->shadow, addr >> instr->word_shift);
+    struct set_counters* counters = &instr->sets[set];
+
+    //Sort the reuse distance into its log2 bucket
+    if(distance == LRU_STACK_COLD) {
+        instr->cold_accesses++;
+    } else {
+        int bucket = 0;
+        for(long remaining = distance; remaining > 0 && bucket < INSTR_DISTANCE_BUCKETS - 1; remaining >>= 1) {
+            bucket++;
+        }
+        instr->distances[bucket]++;
+    }
+
+    counters->accesses++;
+    if(hit) {
+        return;
+    }
+
+    //A miss is compulsory if the block was never seen, capacity if a fully associative cache of the same
+    //size would also miss, and conflict otherwise
+    counters->misses++;
+    if(distance == LRU_STACK_COLD) {
+        instr->compulsory_misses++;
+    } else if(distance >= instr->total_lines) {
+        instr->capacity_misses++;
+    } else {
+        instr->conflict_misses++;
+        counters->conflict_misses++;
+    }
+
+    if(load_status == 1 || load_status == 2) {
+        counters->evictions++;
+    }
+    if(load_status == 2) {
+        counters->dirty_evictions++;
+    }
+}
+
+//Function to print the 3C miss classification
+void print_instr_summary(FILE* out, struct cache_instr* instr) {
+    long misses = instr->compulsory_misses + instr->capacity_misses + instr->conflict_misses;
+    float compulsory = misses == 0 ? 0.0f : (float) instr->compulsory_misses / (float) misses;
+    float capacity = misses == 0 ? 0.0f : (float) instr->capacity_misses / (float) misses;
+    float conflict = misses == 0 ? 0.0f : (float) instr->conflict_misses / (float) misses;
+
+    fprintf(out, "MISS CLASSIFICATION:\n");
+    fprintf(out, "Compulsory: %ld Capacity: %ld Conflict: %ld\n", instr->compulsory_misses,
+            instr->capacity_misses, instr->conflict_misses);
+    fprintf(out, "Compulsory: %.6f Capacity: %.6f Conflict: %.6f\n\n", compulsory, capacity, conflict);
+}
+
+//Function to get the lowest and highest distance of a reuse distance bucket
+static void bucket_bounds(int bucket, long* low, long* high) {
+    if(bucket == 0) {
+        *low = 0;
+        *high = 0;
+    } else {
+        *low = 1L << (bucket - 1);
+        *high = (1L << bucket) - 1;
+    }
+}
+
+//Function to write the instrumentation as CSV, one table after the other
+static void export_csv(FILE* out, struct cache_instr* instr) {
+    fprintf(out, "compulsory_misses,capacity_misses,conflict_misses,cold_accesses\n");
+    fprintf(out, "%ld,%ld,%ld,%ld\n\n", instr->compulsory_misses, instr->capacity_misses,
+            instr->conflict_misses, instr->cold_accesses);
+
+    fprintf(out, "distance_low,distance_high,accesses\n");
+    for(int i = 0; i < INSTR_DISTANCE_BUCKETS; i++) {
+        long low, high;
+        bucket_bounds(i, &low, &high);
+        fprintf(out, "%ld,%ld,%ld\n", low, high, instr->distances[i]);
+    }
+    fprintf(out, "\n");
+
+    fprintf(out, "set,accesses,misses,evictions,dirty_evictions,conflict_misses\n");
+    for(int i = 0; i < instr->total_sets; i++) {
+        struct set_counters counters = instr->sets[i];
+        fprintf(out, "%d,%ld,%ld,%ld,%ld,%ld\n", i, counters.accesses, counters.misses, counters.evictions,
+                counters.dirty_evictions, counters.conflict_misses);
+    }
+}
+
+//Function to write the instrumentation as a single JSON object
+static void export_json(FILE* out, struct cache_instr* instr) {
+    fprintf(out, "{\n  \"misses\": {\"compulsory\": %ld, \"capacity\": %ld, \"conflict\": %ld},\n",
+            instr->compulsory_misses, instr->capacity_misses, instr->conflict_misses);
+    fprintf(out, "  \"cold_accesses\": %ld,\n", instr->cold_accesses);
+
+    fprintf(out, "  \"reuse_distance\": [\n");
+    for(int i = 0; i < INSTR_DISTANCE_BUCKETS; i++) {
+        long low, high;
+        bucket_bounds(i, &low, &high);
+        fprintf(out, "    {\"low\": %ld, \"high\": %ld, \"accesses\": %ld}%s\n", low, high, instr->distances[i],
+                i + 1 < INSTR_DISTANCE_BUCKETS ? "," : "");
+    }
+    fprintf(out, "  ],\n");
+
+    fprintf(out, "  \"sets\": [\n");
+    for(int i = 0; i < instr->total_sets; i++) {
+        struct set_counters counters = instr->sets[i];
+        fprintf(out, "    {\"set\": %d, \"accesses\": %ld, \"misses\": %ld, \"evictions\": %ld, "
+                     "\"dirty_evictions\": %ld, \"conflict_misses\": %ld}%s\n", i, counters.accesses,
+                counters.misses, counters.evictions, counters.dirty_evictions, counters.conflict_misses,
+                i + 1 < instr->total_sets ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+//Function to export the instrumentation to a file, JSON if the path ends in .json and CSV otherwise
+int export_cache_instr(char* path, struct cache_instr* instr) {
+    FILE* out = fopen(path, "w");
+    if(!out) {
+        printf("Error: Instrumentation file could not be created / opened!\n");
+        return 1;
+    }
+
+    size_t length = strlen(path);
+    int format = length >= 5 && strcmp(path + length - 5, ".json") == 0 ? INSTR_FORMAT_JSON : INSTR_FORMAT_CSV;
+    if(format == INSTR_FORMAT_JSON) {
+        export_json(out, instr);
+    } else {
+        export_csv(out, instr);
+    }
+
+    fclose(out);
+    return 0;
+}
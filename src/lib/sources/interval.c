@@ -0,0 +1,86 @@
+#include "../headers/interval.h"
+//
+// Interval statistics streaming for phase analysis
+//
+
+//Function to store a 64-bit value in little endian order
+static void put_le64(unsigned char* out, unsigned long long value) {
+    for(int i = 0; i < 8; i++) {
+        out[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+//Function to open an interval stream and write its header
+int open_interval_stream(struct interval_stream* stream, char* path, int format, long length) {
+    memset(stream, 0, sizeof(struct interval_stream));
+    stream->length = length;
+    stream->format = format;
+    stream->remaining = length;
+    stream->start = zero_stats();
+
+    if(open_stream_writer(&stream->writer, path, STREAM_WRITER_BUFFER_SIZE)) {
+        return 1;
+    }
+
+    if(format == INTERVAL_FORMAT_BINARY) {
+        unsigned char header[16];
+        memcpy(header, INTERVAL_BINARY_MAGIC, 4);
+        header[4] = INTERVAL_BINARY_VERSION;
+        header[5] = INTERVAL_BINARY_FIELDS;
+        header[6] = 0;
+        header[7] = 0;
+        put_le64(header + 8, (unsigned long long) length);
+        stream_write(&stream->writer, header, sizeof(header));
+    } else {
+        const char* header = "interval,first_access,accesses,misses,read_misses,write_misses,"
+                             "miss_rate,read_miss_rate,write_miss_rate,evictions,dirty_evictions\n";
+        stream_write(&stream->writer, header, strlen(header));
+    }
+
+    return 0;
+}
+
+//Function to write the record of the interval ending at the given stats and start the next interval
+void interval_emit(struct interval_stream* stream, struct cache_stats stats) {
+    struct cache_stats start = stream->start;
+    long reads = stats.total_reads - start.total_reads;
+    long writes = stats.total_writes - start.total_writes;
+    long read_misses = stats.read_misses - start.read_misses;
+    long write_misses = stats.write_misses - start.write_misses;
+    long evictions = stats.total_evictions - start.total_evictions;
+    long dirty_evictions = stats.dirty_evictions - start.dirty_evictions;
+    long accesses = reads + writes;
+
+    if(stream->format == INTERVAL_FORMAT_BINARY) {
+        unsigned char record[INTERVAL_BINARY_FIELDS * 8];
+        long fields[INTERVAL_BINARY_FIELDS] = {start.total_actions, accesses, reads, writes, read_misses,
+                                               write_misses, evictions, dirty_evictions};
+        for(int i = 0; i < INTERVAL_BINARY_FIELDS; i++) {
+            put_le64(record + i * 8, (unsigned long long) fields[i]);
+        }
+        stream_write(&stream->writer, record, sizeof(record));
+    } else {
+        char line[256];
+        double miss_rate = accesses == 0 ? 0.0 : (double) (read_misses + write_misses) / (double) accesses;
+        double read_miss_rate = reads == 0 ? 0.0 : (double) read_misses / (double) reads;
+        double write_miss_rate = writes == 0 ? 0.0 : (double) write_misses / (double) writes;
+        int length = snprintf(line, sizeof(line), "%ld,%ld,%ld,%ld,%ld,%ld,%.6f,%.6f,%.6f,%ld,%ld\n",
+                              stream->index, start.total_actions, accesses, read_misses + write_misses,
+                              read_misses, write_misses, miss_rate, read_miss_rate, write_miss_rate,
+                              evictions, dirty_evictions);
+        stream_write(&stream->writer, line, (size_t) length);
+    }
+
+    stream->index++;
+    stream->start = stats;
+    stream->remaining = stream->length;
+}
+
+//Function to emit the final partial interval and close the stream
+int close_interval_stream(struct interval_stream* stream, struct cache_stats stats) {
+    if(stats.total_actions > stream->start.total_actions) {
+        interval_emit(stream, stats);
+    }
+
+    return close_stream_writer(&stream->writer);
+}
@@ -1,8 +1,73 @@
 #include "../headers/io.h"
+#include "../headers/dram.h"
+#include "../headers/mshr.h"
+#include "../headers/occupancy.h"
+#include "../headers/output.h"
+#include "../headers/partition.h"
+#ifdef CACHE_SIM_INSTRUMENT
+#include "../headers/hot.h"
+#include "../headers/instrument.h"
+#endif
 //
 // Created by Phillip Driscoll on 9/18/24.
 //
 
+#ifdef _WIN32
+//getline is not available on Windows, so the trace and map readers use this implementation
+size_t getline(char **lineptr, size_t *n, FILE *stream) {
+    char *bufptr = NULL;
+    char *p = bufptr;
+    size_t size;
+    int c;
+
+    if (lineptr == NULL) {
+        return -1;
+    }
+    if (stream == NULL) {
+        return -1;
+    }
+    if (n == NULL) {
+        return -1;
+    }
+    bufptr = *lineptr;
+    size = *n;
+
+    c = fgetc(stream);
+    if (c == EOF) {
+        return -1;
+    }
+    if (bufptr == NULL) {
+        bufptr = malloc(128);
+        if (bufptr == NULL) {
+            return -1;
+        }
+        size = 128;
+    }
+    p = bufptr;
+    while (c != EOF) {
+        if ((p - bufptr) > (size - 1)) {
+            size = size + 128;
+            bufptr = realloc(bufptr, size);
+            if (bufptr == NULL) {
+                return -1;
+            }
+            p = bufptr + (size - 128);
+        }
+        *p++ = c;
+        if (c == '\n') {
+            break;
+        }
+        c = fgetc(stream);
+    }
+
+    *p++ = '\0';
+    *lineptr = bufptr;
+    *n = size;
+
+    return p - bufptr - 1;
+}
+#endif // _WIN32
+
 //Function for setting the values of a cache struct to zero
 struct cache zero_cache() {
     struct cache primer;
@@ -14,6 +79,25 @@ struct cache zero_cache() {
     primer.size = 0;
     primer.total_sets = 0;
     primer.pc = 0;
+    primer.lines = NULL;
+    primer.instr = NULL;
+    primer.hot = NULL;
+    primer.tracker = NULL;
+    primer.partition = NULL;
+    primer.occupancy = NULL;
+    primer.translation = NULL;
+    primer.icache = NULL;
+    primer.dram = NULL;
+    primer.mshrs = NULL;
+    primer.index_function = INDEX_MODULO;
+    primer.index_bits = 0;
+    primer.index_prime = 1;
+    primer.words_per_sector = 0;
+    primer.sectors_per_line = 1;
+    primer.last_valid = 0;
+    primer.last_block = 0;
+    primer.last_line = 0;
+    primer.mru_ways = NULL;
 
     return primer;
 }
@@ -25,6 +109,11 @@ struct cache_stats zero_stats() {
     primer.dirty_evictions = 0;
     primer.total_evictions = 0;
     primer.total_loads = 0;
+    primer.sector_misses = 0;
+    primer.bytes_filled = 0;
+    primer.bytes_written_back = 0;
+    primer.total_fetches = 0;
+    primer.fetch_misses = 0;
     primer.write_misses = 0;
     primer.read_misses = 0;
     primer.total_misses = 0;
@@ -35,6 +124,16 @@ struct cache_stats zero_stats() {
     return primer;
 }
 
+//Function to check whether a number of sets is prime
+static bool is_prime(INT_TYPE n) {
+    for(INT_TYPE i = 2; i * i <= n; i++) {
+        if(n % i == 0) {
+            return 0;
+        }
+    }
+    return n >= 2;
+}
+
 //Function for initializing cache memory struct
 struct cache init_cache_mem(struct cache cache_mem) {
     struct cache curr_cache = cache_mem;
@@ -52,6 +151,8 @@ struct cache init_cache_mem(struct cache cache_mem) {
         //Set loaded and last used program counter variables
         curr_cache.lines[i].loaded = 0;
         curr_cache.lines[i].last_pc = 0;
+        curr_cache.lines[i].valid_sectors = 0;
+        curr_cache.lines[i].dirty_sectors = 0;
         curr_cache.lines[i].set = current_set;
         //Allocate memory for line words
         curr_cache.lines[i].words = calloc(cache_mem.words_per_line, WORD_SIZE);
@@ -64,6 +165,25 @@ struct cache init_cache_mem(struct cache cache_mem) {
     //Configure total number of sets in cache
     curr_cache.total_sets = current_set + 1;
 
+    //Lines are a single sector unless the cache is sectored
+    if(curr_cache.words_per_sector <= 0 || curr_cache.words_per_sector > curr_cache.words_per_line) {
+        curr_cache.words_per_sector = curr_cache.words_per_line;
+    }
+    curr_cache.sectors_per_line = curr_cache.words_per_line / curr_cache.words_per_sector;
+
+    //No line was touched yet, and the MRU way of every set starts at the first way
+    curr_cache.last_valid = 0;
+    curr_cache.mru_ways = calloc(curr_cache.total_sets, sizeof(unsigned char));
+
+    //Configure the set index function, prime indexing leaves the sets above the largest prime unused
+    curr_cache.index_bits = (int) log2(curr_cache.total_sets);
+    curr_cache.index_prime = 1;
+    for(INT_TYPE n = curr_cache.total_sets; n >= 2 && curr_cache.index_prime == 1; n--) {
+        if(is_prime(n)) {
+            curr_cache.index_prime = n;
+        }
+    }
+
     return curr_cache;
 }
 
@@ -71,13 +191,15 @@ struct cache init_cache_mem(struct cache cache_mem) {
 struct main_mem_block* init_main_mem() {
     struct main_mem_block* main_mem;
 
-    //Allocate memory for blocks
+    //Allocate memory for blocks, and the words of all blocks in one contiguous image so that main memory
+    //can be loaded and dumped as a whole
     main_mem = calloc(TOTAL_MM_BLOCKS, sizeof(struct main_mem_block));
+    INT_TYPE* image = calloc(TOTAL_MM_BLOCKS * MM_WORDS_PER_BLOCK, WORD_SIZE);
     //Initialize main memory
     for(int i = 0; i < TOTAL_MM_BLOCKS; i++) {
-        //Set block address and allocate memory for words in the block
+        //Set block address and point the block at its words in the image
         main_mem[i].address = i * MM_WORDS_PER_BLOCK;
-        main_mem[i].words = calloc(MM_WORDS_PER_BLOCK, WORD_SIZE);
+        main_mem[i].words = image + i * MM_WORDS_PER_BLOCK;
         //Set the value for each word in the block to its address
         for (int j = 0; j < MM_WORDS_PER_BLOCK; j++) {
             main_mem[i].words[j] = main_mem[i].address + j;
@@ -87,97 +209,87 @@ struct main_mem_block* init_main_mem() {
     return main_mem;
 }
 
-//Function to free the memory allocated to the cache and main memory structs
-void free_io(struct cache cache_mem, struct main_mem_block* main_mem) {
-    //Free all words in all blocks
-    for(int i = 0; i < TOTAL_MM_BLOCKS; i++) {
-        free(main_mem[i].words);
-    }
-    //Free the array of memory blocks
-    free(main_mem);
-
+//Function to free the memory allocated to the lines of a cache
+void free_cache_mem(struct cache cache_mem) {
     //Free all words in all lines
     for(int i = 0; i < cache_mem.total_lines; i++) {
         free(cache_mem.lines[i].words);
     }
     //Free the array of cache lines
     free(cache_mem.lines);
+    free(cache_mem.mru_ways);
 }
 
-//Function to print the cache and specified amount of memory to screen
-void print_cache_and_memory(struct cache cache_mem, struct cache_stats stats,
-        struct main_mem_block* main_mem) {
-    float miss_rate = ((float) stats.total_misses / (float) stats.total_actions);
-    float read_miss_rate = ((float) stats.read_misses / (float) stats.total_reads);
-    float write_miss_rate = ((float) stats.write_misses / (float) stats.total_writes);
-
-    if(isnan(miss_rate)) {
-        miss_rate = 0.0;
-    }
-    if(isnan(read_miss_rate)) {
-        read_miss_rate = 0.0;
-    }
-    if(isnan(write_miss_rate)) {
-        write_miss_rate = 0.0;
-    }
+//Function to free the memory allocated to the cache and main memory structs
+void free_io(struct cache cache_mem, struct main_mem_block* main_mem) {
+    //Free the words of all blocks, which all live in the image the first block points at
+    free(main_mem[0].words);
+    //Free the array of memory blocks
+    free(main_mem);
 
-    // Use this code to format and print your output
-    printf("STATISTICS:\n");
-    printf("Misses:\n");
-    printf("Total: %ld DataReads: %ld DataWrites: %ld\n", stats.total_misses, stats.read_misses, stats.write_misses);
-    printf("Miss rate:\n");
-    printf("Total: %.6f DataReads: %.6f DataWrites: %.6f\n", miss_rate, read_miss_rate, write_miss_rate);
-    printf("Number of Dirty Blocks Evicted from the Cache: %ld\n\n", stats.dirty_evictions);
-    printf("CACHE CONTENTS\n");
-    printf("%-6s %-3s %-8s %-8s", "Set", "V", "Tag", " Dirty");
+    free_cache_mem(cache_mem);
 
-    for(int i = 0; i < cache_mem.line_size / WORD_SIZE; i++) {
-        printf("Word%-7d", i);
+    //Free the main memory tracker if one is attached
+    if(cache_mem.tracker) {
+        free_mem_tracker(cache_mem.tracker);
     }
-    printf("\n");
-
-    for(int i = 0; i < cache_mem.total_lines; i++) {
-        struct cache_mem_block block = cache_mem.lines[i];
-        printf("%04X   %-3d %08X    %-5d", block.set, block.valid, block.tag, block.dirty);
+}
 
-        int cutoff = cache_mem.line_size / WORD_SIZE;
+//Function to empty every cache line and restart the program counter, keeping the cache geometry
+void reset_cache_mem(struct cache* cache_mem) {
+    for(int i = 0; i < cache_mem->total_lines; i++) {
+        cache_mem->lines[i].loaded = 0;
+        cache_mem->lines[i].tag = 0;
+        cache_mem->lines[i].valid = 0;
+        cache_mem->lines[i].dirty = 0;
+        cache_mem->lines[i].valid_sectors = 0;
+        cache_mem->lines[i].dirty_sectors = 0;
+        cache_mem->lines[i].last_pc = 0;
+        memset(cache_mem->lines[i].words, 0, cache_mem->words_per_line * WORD_SIZE);
+    }
+    cache_mem->pc = 0;
+    cache_mem->last_valid = 0;
+}
 
-        for(int j = 0; j < cutoff; j++) {
-            printf("%08X   ", block.words[j]);
-        }
-        printf("\n");
+//Function for initializing a main memory write tracker
+int init_mem_tracker(struct mem_tracker* tracker) {
+    tracker->written = calloc(TOTAL_MM_BLOCKS, sizeof(bool));
+    tracker->blocks = calloc(TOTAL_MM_BLOCKS, sizeof(INT_TYPE));
+    tracker->count = 0;
+    if(!tracker->written || !tracker->blocks) {
+        printf("Error: Could not allocate memory for the main memory tracker\n");
+        free_mem_tracker(tracker);
+        return 1;
     }
-    printf("\n");
 
-    printf("MAIN MEMORY:\n");
-    printf("%-11s", "Address");
+    return 0;
+}
 
-    for(int i = 0; i < MM_BLOCK_SIZE / WORD_SIZE; i++) {
-        printf("Word%-7d", i);
+//Function to restore the blocks written back since the last reset to their initial values
+void reset_main_mem(struct main_mem_block* main_mem, struct mem_tracker* tracker) {
+    for(long i = 0; i < tracker->count; i++) {
+        INT_TYPE block = tracker->blocks[i];
+        for(int j = 0; j < MM_WORDS_PER_BLOCK; j++) {
+            main_mem[block].words[j] = main_mem[block].address + j;
+        }
+        tracker->written[block] = 0;
     }
-    printf("\n");
-
-    int start_block = (int) floor((double) MAIN_MEMORY_START_PRINT / (double) MM_WORDS_PER_BLOCK);
-    int end_block = (int) floor((double) (MAIN_MEMORY_START_PRINT + MAIN_MEMORY_PRINT_SIZE) / (double) MM_WORDS_PER_BLOCK);
-    for(int i = start_block; i < end_block; i++) {
-        struct main_mem_block block = main_mem[i];
-        printf("%08X   ", block.address);
-
-        //Determining how many words to write in case the print size results in a less than perfect
-        //block being printed
-        int cutoff = MM_BLOCK_SIZE / WORD_SIZE;
+    tracker->count = 0;
+}
 
-        if(i == start_block) {
-            cutoff = cutoff + (MAIN_MEMORY_START_PRINT % MM_WORDS_PER_BLOCK);
-        } else if(i == end_block) {
-            cutoff = cutoff - ((MAIN_MEMORY_START_PRINT + MAIN_MEMORY_PRINT_SIZE) % MM_WORDS_PER_BLOCK);
-        }
+//Function to free the memory allocated to a main memory write tracker
+void free_mem_tracker(struct mem_tracker* tracker) {
+    free(tracker->written);
+    free(tracker->blocks);
+    tracker->written = NULL;
+    tracker->blocks = NULL;
+    tracker->count = 0;
+}
 
-        for(int j = 0; j < cutoff; j++) {
-            printf("%08X   ", block.words[j]);
-        }
-        printf("\n");
-    }
+//Function to print the cache and specified amount of memory to screen
+void print_cache_and_memory(struct cache cache_mem, struct cache_stats stats,
+        struct main_mem_block* main_mem) {
+    write_results(stdout, cache_mem, stats, main_mem, zero_output_config());
 }
 
 //Function to write the cache and memory outputs to a file
@@ -187,82 +299,10 @@ void write_cache_and_memory(char* output, struct cache cache_mem, struct cache_s
 
     if(!output_file) {
         printf("Error: Output file could not be created / opened!\n");
-        fclose(output_file);
         return;
     }
 
-    float miss_rate = ((float) stats.total_misses / (float) stats.total_actions);
-    float read_miss_rate = ((float) stats.read_misses / (float) stats.total_reads);
-    float write_miss_rate = ((float) stats.write_misses / (float) stats.total_writes);
-
-    if(isnan(miss_rate)) {
-        miss_rate = 0.0;
-    }
-    if(isnan(read_miss_rate)) {
-        read_miss_rate = 0.0;
-    }
-    if(isnan(write_miss_rate)) {
-        write_miss_rate = 0.0;
-    }
-
-    // Use this code to format and print your output
-    fprintf(output_file, "STATISTICS:\n");
-    fprintf(output_file, "Misses:\n");
-    fprintf(output_file, "Total: %ld DataReads: %ld DataWrites: %ld\n", stats.total_misses, stats.read_misses, stats.write_misses);
-    fprintf(output_file, "Miss rate:\n");
-    fprintf(output_file, "Total: %.6f DataReads: %.6f DataWrites: %.6f\n", miss_rate, read_miss_rate, write_miss_rate);
-    fprintf(output_file, "Number of Dirty Blocks Evicted from the Cache: %ld\n\n", stats.dirty_evictions);
-    fprintf(output_file, "CACHE CONTENTS\n");
-    fprintf(output_file, "%-6s %-3s %-8s %-8s", "Set", "V", "Tag", " Dirty");
-
-    for(int i = 0; i < cache_mem.line_size / WORD_SIZE; i++) {
-        fprintf(output_file, "Word%-7d", i);
-    }
-    fprintf(output_file, "\n");
-
-    for(int i = 0; i < cache_mem.total_lines; i++) {
-        struct cache_mem_block block = cache_mem.lines[i];
-        fprintf(output_file, "%04X   %-3d %08X    %-5d", block.set, block.valid, block.tag, block.dirty);
-
-        int cutoff = cache_mem.line_size / WORD_SIZE;
-
-        for(int j = 0; j < cutoff; j++) {
-            fprintf(output_file, "%08X   ", block.words[j]);
-        }
-        fprintf(output_file, "\n");
-    }
-    fprintf(output_file, "\n");
-
-    fprintf(output_file, "MAIN MEMORY:\n");
-    fprintf(output_file, "%-11s", "Address");
-
-    for(int i = 0; i < MM_BLOCK_SIZE / WORD_SIZE; i++) {
-        fprintf(output_file, "Word%-7d", i);
-    }
-    fprintf(output_file, "\n");
-
-    int start_block = (int) floor((double) MAIN_MEMORY_START_PRINT / (double) MM_WORDS_PER_BLOCK);
-    int end_block = (int) floor((double) (MAIN_MEMORY_START_PRINT + MAIN_MEMORY_PRINT_SIZE) / (double) MM_WORDS_PER_BLOCK);
-    for(int i = start_block; i < end_block; i++) {
-        struct main_mem_block block = main_mem[i];
-        fprintf(output_file, "%08X   ", block.address);
-
-        //Determining how many words to write in case the print size results in a less than perfect
-        //block being printed
-        int cutoff = MM_BLOCK_SIZE / WORD_SIZE;
-
-        if(i == start_block) {
-            cutoff = cutoff + (MAIN_MEMORY_START_PRINT % MM_WORDS_PER_BLOCK);
-        } else if(i == end_block) {
-            cutoff = cutoff - ((MAIN_MEMORY_START_PRINT + MAIN_MEMORY_PRINT_SIZE) % MM_WORDS_PER_BLOCK);
-        }
-
-        for(int j = 0; j < cutoff; j++) {
-            fprintf(output_file, "%08X   ", block.words[j]);
-        }
-        fprintf(output_file, "\n");
-    }
-
+    write_results(output_file, cache_mem, stats, main_mem, zero_output_config());
     fclose(output_file);
 }
 
@@ -282,8 +322,12 @@ struct address_info info_from_address(INT_TYPE addr, int total_cache_sets, int c
     //Bitshift right w + d (length of set and word)
     addr_info.tag = (INT_TYPE) (addr >> ((WORD_SIZE * 8) - tag));
     //Bitshift left length of tag to cutoff tag, then bitshift right length of tag and word to cutoff word
-    //leaving set behind
-    addr_info.set = (INT_TYPE) ((addr << tag) >> (tag + word));
+    //leaving set behind. A single set has no set bits, and the bitshifts would shift out the whole address
+    if(set != 0) {
+        addr_info.set = (INT_TYPE) ((addr << tag) >> (tag + word));
+    } else {
+        addr_info.set = 0;
+    }
 
     //If word length = 0 (direct mapping) then the bitshifts don't work and we need to manually set it to 0
     if(word != 0) {
@@ -319,18 +363,104 @@ INT_TYPE address_from_info(INT_TYPE tag, INT_TYPE set, INT_TYPE word,
     return addr;
 }
 
+//Function to get the index function selected by name, -1 if the name is unknown
+int index_function_from_name(char* name) {
+    if(strcmp(name, "mod") == 0) {
+        return INDEX_MODULO;
+    } else if(strcmp(name, "xor") == 0) {
+        return INDEX_XOR;
+    } else if(strcmp(name, "prime") == 0) {
+        return INDEX_PRIME;
+    } else if(strcmp(name, "skew") == 0) {
+        return INDEX_SKEW;
+    }
+    return -1;
+}
+
+//Function to get the name of an index function
+char* index_function_name(int index_function) {
+    switch(index_function) {
+        case INDEX_XOR:
+            return "xor";
+        case INDEX_PRIME:
+            return "prime";
+        case INDEX_SKEW:
+            return "skew";
+        default:
+            return "mod";
+    }
+}
+
+//Defining the multipliers of the skewed index hashes, way w multiplies by SKEW_MULTIPLIER plus w steps,
+//and every multiplier is odd
+#define SKEW_MULTIPLIER 0x9e3779b97f4a7c15ULL
+#define SKEW_MULTIPLIER_STEP 0x632be59bd9b4e01aULL
+
+//Function to hash a tag differently for every way of a skewed associative cache, a multiplicative hash
+//keeping the top index_bits bits of the product
+static INT_TYPE skew_hash(struct cache cache_mem, INT_TYPE tag, int way) {
+    if(cache_mem.index_bits == 0) {
+        return 0;
+    }
+    unsigned long long multiplier = SKEW_MULTIPLIER + (unsigned long long) way * SKEW_MULTIPLIER_STEP;
+    return (INT_TYPE) (((unsigned long long) tag * multiplier) >> (64 - cache_mem.index_bits));
+}
+
+//Getting tag, set, and word information from the address with the index function of the cache. Skewed
+//indexing keeps the plain index bits as the set, every way then hashes them with the tag on its own
+struct address_info cache_info_from_address(struct cache cache_mem, INT_TYPE addr) {
+    struct address_info info;
+    if(cache_mem.index_function == INDEX_PRIME) {
+        INT_TYPE line = addr / cache_mem.words_per_line;
+        info.word = addr % cache_mem.words_per_line;
+        info.set = line % cache_mem.index_prime;
+        info.tag = line / cache_mem.index_prime;
+        return info;
+    }
+
+    info = info_from_address(addr, cache_mem.total_sets, cache_mem.line_size);
+    if(cache_mem.index_function == INDEX_XOR) {
+        //Fold the two lowest index sized pieces of the tag into the set
+        info.set = (info.set ^ info.tag ^ (info.tag >> cache_mem.index_bits)) & (cache_mem.total_sets - 1);
+    }
+    return info;
+}
+
+//Get the memory address of the first word of a cache line, undoing the index function of the cache
+INT_TYPE cache_line_address(struct cache cache_mem, INT_TYPE line) {
+    INT_TYPE tag = cache_mem.lines[line].tag;
+    INT_TYPE set = cache_mem.lines[line].set;
+    if(cache_mem.index_function == INDEX_PRIME) {
+        return (tag * cache_mem.index_prime + set) * cache_mem.words_per_line;
+    } else if(cache_mem.index_function == INDEX_XOR) {
+        set = (set ^ tag ^ (tag >> cache_mem.index_bits)) & (cache_mem.total_sets - 1);
+    } else if(cache_mem.index_function == INDEX_SKEW) {
+        set = (set ^ skew_hash(cache_mem, tag, (int) (line % cache_mem.associativity))) & (cache_mem.total_sets - 1);
+    }
+    return address_from_info(tag, set, 0, cache_mem.total_sets, cache_mem.line_size);
+}
+
+//Function to get the cache line of a way which an address maps to, the way sits in the set of the address
+//unless the cache is skewed
+INT_TYPE cache_way_line(struct cache cache_mem, struct address_info info, int way) {
+    INT_TYPE set = info.set;
+    if(cache_mem.index_function == INDEX_SKEW) {
+        set = (set ^ skew_hash(cache_mem, info.tag, way)) & (cache_mem.total_sets - 1);
+    }
+    return cache_mem.associativity * set + way;
+}
+
 //Function to find a line that is loaded in cache memory
 INT_TYPE get_loaded_cm_line(struct cache cache_mem, struct address_info info) {
     INT_TYPE line = 0;
 
-    //Get the start location of the search based on the set of the address
-    INT_TYPE cm_set_start = cache_mem.associativity * info.set;
-    //Loop over just that set
-    for(INT_TYPE i = 0; i < cache_mem.associativity; i++) {
+    //Loop over just the lines the address maps to
+    for(int i = 0; i < cache_mem.associativity; i++) {
+        INT_TYPE candidate = cache_way_line(cache_mem, info, i);
         //Determine if the tags line up for a loaded cache line
-        if(cache_mem.lines[cm_set_start + i].tag == info.tag) {
+        if(cache_mem.lines[candidate].tag == info.tag) {
             //Set line number to the one loaded
-            line = cm_set_start + i;
+            line = candidate;
             break;
         }
     }
@@ -338,18 +468,27 @@ INT_TYPE get_loaded_cm_line(struct cache cache_mem, struct address_info info) {
     return line;
 }
 
+//Function to get the ways of a set the current access may fill or evict, every way unless the cache is
+//shared by partitioned workloads
+static unsigned int allocatable_ways(struct cache cache_mem, INT_TYPE set) {
+    if(cache_mem.partition) {
+        return partition_ways(cache_mem.partition, set);
+    }
+    return ~0u;
+}
+
 //Function to return the cache line number for an empty cache line in a set
-INT_TYPE get_available_cm_line(struct cache cache_mem, INT_TYPE set) {
+INT_TYPE get_available_cm_line(struct cache cache_mem, struct address_info info) {
     INT_TYPE line = 0;
 
-    //Set the search start location
-    INT_TYPE cm_set_start = cache_mem.associativity * set;
-    //Loop over set
-    for(INT_TYPE i = 0; i < cache_mem.associativity; i++) {
-        //Check if the line is loaded
-        if(cache_mem.lines[cm_set_start + i].loaded == 0) {
+    unsigned int ways = allocatable_ways(cache_mem, info.set);
+    //Loop over the lines the address maps to
+    for(int i = 0; i < cache_mem.associativity; i++) {
+        INT_TYPE candidate = cache_way_line(cache_mem, info, i);
+        //Check if the line is loaded and the current workload may fill it
+        if(cache_mem.lines[candidate].loaded == 0 && (ways >> i & 1)) {
             //If line is not loaded, return it as an available line in the set
-            line = cm_set_start + i;
+            line = candidate;
             break;
         }
     }
@@ -358,22 +497,27 @@ INT_TYPE get_available_cm_line(struct cache cache_mem, INT_TYPE set) {
 }
 
 //Function to get the least recently used cache line of a set
-INT_TYPE get_lru_cm_line(struct cache cache_mem, INT_TYPE set) {
+INT_TYPE get_lru_cm_line(struct cache cache_mem, struct address_info info) {
     INT_TYPE line = 0;
 
-    //Set the search start params and initialize the current lowest program counter to -1
-    INT_TYPE cm_set_start = cache_mem.associativity * set;
-    //Initialize the lowest program counter and its associated line to the first line in the set
-    INT_TYPE lowest_pc = cache_mem.lines[cm_set_start].last_pc;
-    line = cm_set_start;
-    //Loop over the set
-    for(INT_TYPE i = 1; i < cache_mem.associativity; i++) {
+    //Skip the ways the current workload may not evict, a partition always leaves it at least one
+    unsigned int ways = allocatable_ways(cache_mem, info.set);
+    int first = 0;
+    while(!(ways >> first & 1)) {
+        first++;
+    }
+    //Initialize the lowest program counter and its associated line to the first line the address maps to
+    line = cache_way_line(cache_mem, info, first);
+    INT_TYPE lowest_pc = cache_mem.lines[line].last_pc;
+    //Loop over the other lines the address maps to
+    for(int i = first + 1; i < cache_mem.associativity; i++) {
+        INT_TYPE candidate = cache_way_line(cache_mem, info, i);
         //Check if the line has a lower program counter than the previous lowest
-        if(cache_mem.lines[cm_set_start + i].last_pc < lowest_pc) {
+        if(cache_mem.lines[candidate].last_pc < lowest_pc && (ways >> i & 1)) {
             //If lower than the current lowest program counter,
             //set the lowest pc to this one and current line to this one
-            line = cm_set_start + i;
-            lowest_pc = cache_mem.lines[cm_set_start + i].last_pc;
+            line = candidate;
+            lowest_pc = cache_mem.lines[candidate].last_pc;
         }
     }
 
@@ -382,12 +526,10 @@ INT_TYPE get_lru_cm_line(struct cache cache_mem, INT_TYPE set) {
 
 //Function to verify if the address is currently loaded in the cache
 bool addr_in_cache(struct cache cache_mem, struct address_info info) {
-    //Set the start index
-    INT_TYPE cm_set_start = cache_mem.associativity * info.set;
-    //Loop through the set associated with that address
-    for(INT_TYPE i = 0; i < cache_mem.associativity; i++) {
+    //Loop through the lines associated with that address
+    for(int i = 0; i < cache_mem.associativity; i++) {
         //Check if tags match up
-        if(cache_mem.lines[cm_set_start + i].tag == info.tag) {
+        if(cache_mem.lines[cache_way_line(cache_mem, info, i)].tag == info.tag) {
             //If tags match, address is currently loaded
             return 1;
         }
@@ -397,13 +539,12 @@ bool addr_in_cache(struct cache cache_mem, struct address_info info) {
 }
 
 //Function to check if a set has an empty cache line available
-bool set_has_empty(struct cache cache_mem, INT_TYPE set) {
-    //Set start index
-    INT_TYPE cm_set_start = cache_mem.associativity * set;
-    //Loop through set
-    for(INT_TYPE i = 0; i < cache_mem.associativity; i++) {
-        //Check if each line in set is loaded
-        if(cache_mem.lines[cm_set_start + i].loaded == 0) {
+bool set_has_empty(struct cache cache_mem, struct address_info info) {
+    unsigned int ways = allocatable_ways(cache_mem, info.set);
+    //Loop through the lines the address maps to
+    for(int i = 0; i < cache_mem.associativity; i++) {
+        //Check if each line the current workload may fill is loaded
+        if(cache_mem.lines[cache_way_line(cache_mem, info, i)].loaded == 0 && (ways >> i & 1)) {
             //If it finds a single unloaded line, it can return as having an empty line
             return 1;
         }
@@ -412,73 +553,117 @@ bool set_has_empty(struct cache cache_mem, INT_TYPE set) {
     return 0;
 }
 
-//Function to evict line from cache back to the memory
-bool evict_line(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE line, bool keep_in_cache) {
-    //Get the main memory address associated with the first block in the cache line
-    INT_TYPE addr = address_from_info(cache_mem->lines[line].tag, cache_mem->lines[line].set, 0, cache_mem->total_sets, cache_mem->line_size);
-    int code = 0;
+//Function to get a pointer to a word of main memory, the words of all blocks are one contiguous image
+static INT_TYPE* mem_word(struct main_mem_block* main_mem, INT_TYPE addr) {
+    return &main_mem[addr / MM_WORDS_PER_BLOCK].words[addr % MM_WORDS_PER_BLOCK];
+}
+
+//Function to count the sectors set in a sector mask
+static int count_sectors(unsigned long long mask) {
+    int count = 0;
+    for(; mask != 0; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
 
-    //Get the offset from the beginning of the memory block which the first block of the cache line
-    //belongs to. Example: cache line address is associated with the 4th out of 8 words in the memory block
-    //then we must set the offset to 4 since not the entire memory block is loaded into the cache
-    INT_TYPE mm_block_offset = addr % MM_WORDS_PER_BLOCK;
-    //Get the index of the memory block in the main_mem_block* struct
-    INT_TYPE mm_block = (addr - mm_block_offset) / MM_WORDS_PER_BLOCK;
-
-    //Calculate the total number of memory blocks which the cache line holds data for
-    //Example: Cache lines hold 16 words and main memory blocks hold only 4. Total number
-    //of memory blocks to write to, in this case, is ceil(16 / 4)
-    int mem_blocks_to_write = (int) ceil((double) cache_mem->words_per_line / (double) MM_WORDS_PER_BLOCK);
-    //Index of the cache line
-    int cm_line_offset = 0;
-    //Loop through the total number of memory blocks to write to
-    for(int i = 0; i < mem_blocks_to_write; i++) {
-        //Loop through the words in the memory block until the end of the memory block is reached
-        //or until the end of the cache line is reached
-        for(INT_TYPE j = mm_block_offset; j < MM_WORDS_PER_BLOCK && cm_line_offset < cache_mem->words_per_line; j++) {
-            //Write word from cache line index to memory block index
-            main_mem[mm_block].words[j] = cache_mem->lines[line].words[cm_line_offset];
-
-            //Check if the line is being kept in the cache as well, if not then set that word in the cache
-            //back to 0
-            if(!keep_in_cache) {
-                cache_mem->lines[line].words[cm_line_offset] = 0;
+//Function to write a sector of a cache line to main memory, remembering the blocks it covers for a later
+//reset of main memory
+static void write_sector(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE line, INT_TYPE addr,
+                         int sector) {
+    int first = sector * cache_mem->words_per_sector;
+    if(cache_mem->tracker) {
+        INT_TYPE last_block = (addr + first + cache_mem->words_per_sector - 1) / MM_WORDS_PER_BLOCK;
+        for(INT_TYPE mm_block = (addr + first) / MM_WORDS_PER_BLOCK; mm_block <= last_block; mm_block++) {
+            if(!cache_mem->tracker->written[mm_block]) {
+                cache_mem->tracker->written[mm_block] = 1;
+                cache_mem->tracker->blocks[cache_mem->tracker->count++] = mm_block;
             }
+        }
+    }
+    memcpy(mem_word(main_mem, addr + first), cache_mem->lines[line].words + first,
+           cache_mem->words_per_sector * WORD_SIZE);
+}
+
+//Function to fill a sector of a cache line from main memory
+static void read_sector(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE line, INT_TYPE addr,
+                        int sector) {
+    int first = sector * cache_mem->words_per_sector;
+    memcpy(cache_mem->lines[line].words + first, mem_word(main_mem, addr + first),
+           cache_mem->words_per_sector * WORD_SIZE);
+    cache_mem->lines[line].valid_sectors |= 1ULL << sector;
+}
+
+//Function to evict line from cache back to the memory. Only the dirty sectors are written, the clean ones
+//still hold what main memory holds
+bool evict_line(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE line, bool keep_in_cache) {
+    //Get the main memory address associated with the first word in the cache line
+    INT_TYPE addr = cache_line_address(*cache_mem, line);
+    int code = 0;
 
-            //Increment the current cache line word
-            cm_line_offset++;
+    //Write every dirty sector back to main memory
+    unsigned long long dirty_sectors = cache_mem->lines[line].dirty_sectors;
+    for(int i = 0; dirty_sectors != 0; i++, dirty_sectors >>= 1) {
+        if(dirty_sectors & 1) {
+            write_sector(cache_mem, main_mem, line, addr, i);
         }
-        //Main memory block offset is automatically 0 after the first line since finishing
-        //one main memory block means resetting back to the 0 index of the next memory block
-        mm_block_offset = 0;
     }
 
     if(cache_mem->lines[line].dirty) {
         code = 1;
     }
 
-    //If the cache line is not being kept in the cache, reset all variables associated with that line
+    //If the cache line is not being kept in the cache, reset all variables associated with that line and set
+    //its words back to 0
     if(!keep_in_cache) {
+        memset(cache_mem->lines[line].words, 0, cache_mem->words_per_line * WORD_SIZE);
         cache_mem->lines[line].last_pc = -1;
         cache_mem->lines[line].tag = 0;
         cache_mem->lines[line].loaded = 0;
         cache_mem->lines[line].dirty = 0;
         cache_mem->lines[line].valid = 0;
+        cache_mem->lines[line].valid_sectors = 0;
+        cache_mem->lines[line].dirty_sectors = 0;
+        cache_mem->last_valid = 0;
     }
 
     return code;
 }
 
-//Function to load a cache line from main memory
-int load_line(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE addr) {
+//Function to send the dirty sectors of a line about to be evicted to the DRAM, one write per sector
+static void dram_write_back(struct cache* cache_mem, INT_TYPE line) {
+    INT_TYPE addr = cache_line_address(*cache_mem, line);
+    unsigned long long dirty_sectors = cache_mem->lines[line].dirty_sectors;
+    for(int i = 0; dirty_sectors != 0; i++, dirty_sectors >>= 1) {
+        if(dirty_sectors & 1) {
+            dram_access(cache_mem->dram, addr + i * cache_mem->words_per_sector,
+                        cache_mem->words_per_sector * WORD_SIZE, 1);
+        }
+    }
+}
+
+//Function to load a cache line from main memory, only the sector holding the address is filled
+int load_line(struct cache* cache_mem, struct cache_stats* stats, struct main_mem_block* main_mem,
+              INT_TYPE addr) {
     //Get tag, set, word information from the address
-    struct address_info info = info_from_address(addr, cache_mem->total_sets, cache_mem->line_size);
+    struct address_info info = cache_info_from_address(*cache_mem, addr);
     int code = 0;
 
     //Check if the cache has an empty line for the associated set
-    if(!set_has_empty(*cache_mem, info.set)) {
+    if(!set_has_empty(*cache_mem, info)) {
         //If no empty line is available, evict the least recently used line from the cache first
-        bool evict_status = evict_line(cache_mem, main_mem, get_lru_cm_line(*cache_mem, info.set), 0);
+        INT_TYPE victim = get_lru_cm_line(*cache_mem, info);
+#ifdef CACHE_SIM_INSTRUMENT
+        if(cache_mem->hot && cache_mem->lines[victim].dirty) {
+            hot_record_dirty_eviction(cache_mem->hot, cache_line_address(*cache_mem, victim));
+        }
+#endif
+        stats->bytes_written_back += (long) count_sectors(cache_mem->lines[victim].dirty_sectors)
+                                     * cache_mem->words_per_sector * WORD_SIZE;
+        if(cache_mem->dram) {
+            dram_write_back(cache_mem, victim);
+        }
+        bool evict_status = evict_line(cache_mem, main_mem, victim, 0);
 
         //If cache fails to evict, return from this function with an error
         if(evict_status == 0) {
@@ -490,68 +675,149 @@ int load_line(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE
         }
     }
 
-    //Calculate the main memory block offset (see explanation in evict_line function if confused about its purpose)
-    INT_TYPE mm_block_offset = address_from_info(info.tag, info.set, 0, cache_mem->total_sets, cache_mem->line_size) % MM_WORDS_PER_BLOCK;
-    //Calculate the main memory index of the main_mem_block struct
-    INT_TYPE mm_block = (addr - mm_block_offset) / MM_WORDS_PER_BLOCK;
-
     //Get the cache line which we are loading the data into
-    INT_TYPE cm_line = get_available_cm_line(*cache_mem, info.set);
-
-    //Get total number of memory blocks which the cache line spans (see evict_line explanation)
-    int mem_blocks_to_load = (int) ceil((double) cache_mem->words_per_line / (double) MM_WORDS_PER_BLOCK);
-    //Offset for the word in the cache line
-    int cm_line_offset = 0;
-    //Iterate over memory blocks
-    for(int i = 0; i < mem_blocks_to_load; i++) {
-        //Iterate over cache lines until the end of a memory block or cache line is reached
-        for(INT_TYPE j = mm_block_offset; j < MM_WORDS_PER_BLOCK && cm_line_offset < cache_mem->words_per_line; j++) {
-            //Load memory into cache
-            cache_mem->lines[cm_line].words[cm_line_offset] = main_mem[mm_block].words[j];
-
-            //Increase cache word offset
-            cm_line_offset++;
-        }
-        mm_block_offset = 0;
+    INT_TYPE cm_line = get_available_cm_line(*cache_mem, info);
+
+    //Count the fill, and the eviction it needed, against the set of the line
+    if(cache_mem->occupancy) {
+        record_set_fill(cache_mem->occupancy, cache_mem->lines[cm_line].set, code != 0);
+    }
+
+    //Misses in the leader sets steer the set dueling of a partitioned cache, once the line is chosen
+    if(cache_mem->partition) {
+        partition_record_miss(cache_mem->partition, info.set);
+    }
+
+    //Load the sector of the address from memory
+    cache_mem->lines[cm_line].valid_sectors = 0;
+    cache_mem->lines[cm_line].dirty_sectors = 0;
+    read_sector(cache_mem, main_mem, cm_line, addr - info.word, (int) (info.word / cache_mem->words_per_sector));
+    stats->bytes_filled += cache_mem->words_per_sector * WORD_SIZE;
+    if(cache_mem->dram) {
+        dram_access(cache_mem->dram, addr - info.word % cache_mem->words_per_sector,
+                    cache_mem->words_per_sector * WORD_SIZE, 0);
     }
 
     //Setting metadata info for the line
     cache_mem->lines[cm_line].tag = info.tag;
     cache_mem->lines[cm_line].loaded = 1;
     cache_mem->lines[cm_line].valid = 1;
+    cache_mem->last_valid = 0;
 
     return code;
 }
 
+//Function to fill the sector of an address whose line is in the cache without it, returns non-zero if the
+//sector had to be fetched. Only sectored caches have lines with missing sectors
+static bool fill_missing_sector(struct cache* cache_mem, struct cache_stats* stats, struct main_mem_block* main_mem,
+                                struct address_info info, INT_TYPE addr, INT_TYPE cm_line) {
+    if(cache_mem->sectors_per_line == 1) {
+        return 0;
+    }
+
+    int sector = (int) (info.word / cache_mem->words_per_sector);
+    if(!cache_mem->lines[cm_line].loaded || (cache_mem->lines[cm_line].valid_sectors >> sector & 1)) {
+        return 0;
+    }
+
+    read_sector(cache_mem, main_mem, cm_line, addr - info.word, sector);
+    stats->sector_misses++;
+    stats->bytes_filled += cache_mem->words_per_sector * WORD_SIZE;
+    if(cache_mem->dram) {
+        dram_access(cache_mem->dram, addr - info.word % cache_mem->words_per_sector,
+                    cache_mem->words_per_sector * WORD_SIZE, 0);
+    }
+    return 1;
+}
+
+//Function to find the line an address hits in, the same line addr_in_cache and get_loaded_cm_line find.
+//Repeated accesses to the line of the last access skip decoding the address, and the most recently used
+//way of the set is tried before the scan. Empty lines have tag 0 and another way may hold a line with tag
+//0, so only a non-zero tag can be matched on the MRU way alone
+static bool find_hit_line(struct cache* cache_mem, INT_TYPE addr, struct address_info* info, INT_TYPE* line) {
+    INT_TYPE block = addr / cache_mem->words_per_line;
+    if(cache_mem->last_valid && cache_mem->last_block == block) {
+        *info = cache_mem->last_info;
+        info->word = addr % cache_mem->words_per_line;
+        *line = cache_mem->last_line;
+        return 1;
+    }
+
+    *info = cache_info_from_address(*cache_mem, addr);
+    if(info->tag != 0) {
+        INT_TYPE mru = cache_way_line(*cache_mem, *info, cache_mem->mru_ways[info->set]);
+        if(cache_mem->lines[mru].tag == info->tag) {
+            *line = mru;
+            return 1;
+        }
+    }
+    for(int i = 0; i < cache_mem->associativity; i++) {
+        INT_TYPE candidate = cache_way_line(*cache_mem, *info, i);
+        if(cache_mem->lines[candidate].tag == info->tag) {
+            *line = candidate;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//Function to remember the line an access touched as the last line and the MRU way of its set
+static void touch_line(struct cache* cache_mem, INT_TYPE addr, struct address_info info, INT_TYPE line) {
+    cache_mem->pc++;
+    cache_mem->lines[line].last_pc = cache_mem->pc;
+
+    cache_mem->last_valid = 1;
+    cache_mem->last_block = addr / cache_mem->words_per_line;
+    cache_mem->last_line = line;
+    cache_mem->last_info = info;
+    cache_mem->mru_ways[info.set] = (unsigned char) (line % cache_mem->associativity);
+}
+
+//Function to write a new value into a word of a cache line
+static void write_line_word(struct cache* cache_mem, INT_TYPE cm_line, INT_TYPE word, INT_TYPE new_val) {
+    //Set the new value for the cache line word using the word offset
+    cache_mem->lines[cm_line].words[word] = new_val;
+    //Mark the line and the sector of the word as dirty
+    cache_mem->lines[cm_line].dirty = 1;
+    cache_mem->lines[cm_line].dirty_sectors |= 1ULL << (word / cache_mem->words_per_sector);
+}
+
 //Function to write a new value into a cache line word
 int write_back(struct cache* cache_mem, struct address_info info, INT_TYPE new_val) {
     //Get the loaded cache line
     INT_TYPE cm_line = get_loaded_cm_line(*cache_mem, info);
 
-    //Set the new value for the cache line word using the word offset
-    cache_mem->lines[cm_line].words[info.word] = new_val;
-    //Mark the line as dirty
-    cache_mem->lines[cm_line].dirty = 1;
+    write_line_word(cache_mem, cm_line, info.word, new_val);
 
     return 0;
 }
 
+//Function to time an access on the MSHRs of a non-blocking cache, a miss waits for the DRAM reads of its fill
+//on top of the miss latency. Sectors are filled on their own, so a sector is the block an MSHR tracks
+static void time_access(struct cache* cache_mem, INT_TYPE addr, bool in_cache, long long dram_cycles) {
+    long memory_cycles = cache_mem->dram ? (long) (cache_mem->dram->reads.cycles - dram_cycles) : 0;
+    mshr_access(cache_mem->mshrs, addr / cache_mem->words_per_sector, !in_cache, memory_cycles);
+}
+
 //Function to write data into the cache
 int write_to_cache(struct cache* cache_mem, struct cache_stats* stats,
                     struct main_mem_block* main_mem, INT_TYPE addr, INT_TYPE new_val) {
-    //Get tag, set, word info for address
-    struct address_info info = info_from_address(addr, cache_mem->total_sets, cache_mem->line_size);
-    //Verify whether the address is already loaded into the cache
-    bool in_cache = addr_in_cache(*cache_mem, info);
+    //DRAM read cycles so far, the ones a miss adds are the memory latency of its fill
+    long long dram_cycles = cache_mem->dram ? cache_mem->dram->reads.cycles : 0;
+
+    //Get tag, set, word info for address and verify whether the address is already loaded into the cache
+    struct address_info info;
+    INT_TYPE cm_line = 0;
+    bool in_cache = find_hit_line(cache_mem, addr, &info, &cm_line);
 
-    int status;
+    int status = 0;
     if(!in_cache) {
         //If the address is not in the cache, register a write miss
         stats->total_misses++;
         stats->write_misses++;
 
         //Load the line
-        status = load_line(cache_mem, main_mem, addr);
+        status = load_line(cache_mem, stats, main_mem, addr);
         //Verify the line was loaded and whether an eviction was necessary to load the address
         if(status == 0) {
             //Load with no eviction
@@ -568,17 +834,32 @@ int write_to_cache(struct cache* cache_mem, struct cache_stats* stats,
         } else {
             return status - 1;
         }
+        cm_line = get_loaded_cm_line(*cache_mem, info);
+    } else if(fill_missing_sector(cache_mem, stats, main_mem, info, addr, cm_line)) {
+        //The line is in the cache without the sector of the address, a write miss on that sector only
+        stats->total_misses++;
+        stats->write_misses++;
+        in_cache = 0;
     }
 
-    //Write the new data to the address
-    status = write_back(cache_mem, info, new_val);
-    if(status != 0) {
-        return status;
+#ifdef CACHE_SIM_INSTRUMENT
+    if(cache_mem->instr) {
+        instr_record(cache_mem->instr, addr, info.set, in_cache, status);
+    }
+    if(cache_mem->hot && !in_cache) {
+        hot_record_miss(cache_mem->hot, addr, info.set);
+    }
+#endif
+
+    if(cache_mem->mshrs) {
+        time_access(cache_mem, addr, in_cache, dram_cycles);
     }
 
+    //Write the new data to the address
+    write_line_word(cache_mem, cm_line, info.word, new_val);
+
     //Increment program counter and set the last program counter of the line to this pc
-    cache_mem->pc++;
-    cache_mem->lines[get_loaded_cm_line(*cache_mem, info)].last_pc = cache_mem->pc;
+    touch_line(cache_mem, addr, info, cm_line);
 
     //Increase total number of actions and total number of writes
     stats->total_actions++;
@@ -590,18 +871,22 @@ int write_to_cache(struct cache* cache_mem, struct cache_stats* stats,
 //Function to register a cache read
 int read_from_cache(struct cache* cache_mem, struct cache_stats* stats,
                      struct main_mem_block* main_mem, INT_TYPE addr) {
-    //Get tag, set, word information
-    struct address_info info = info_from_address(addr, cache_mem->total_sets, cache_mem->line_size);
-    //Check if the address is in the cache
-    bool in_cache = addr_in_cache(*cache_mem, info);
+    //DRAM read cycles so far, the ones a miss adds are the memory latency of its fill
+    long long dram_cycles = cache_mem->dram ? cache_mem->dram->reads.cycles : 0;
 
+    //Get tag, set, word information and check if the address is in the cache
+    struct address_info info;
+    INT_TYPE cm_line = 0;
+    bool in_cache = find_hit_line(cache_mem, addr, &info, &cm_line);
+
+    int status = 0;
     if(!in_cache) {
         //Address is not in the cache, register a cache miss
         stats->total_misses++;
         stats->read_misses++;
 
         //Load the cache line
-        int status = load_line(cache_mem, main_mem, addr);
+        status = load_line(cache_mem, stats, main_mem, addr);
         //Check line status
         if(status == 0) {
             //Load w/ no eviction
@@ -618,11 +903,29 @@ int read_from_cache(struct cache* cache_mem, struct cache_stats* stats,
         } else {
             return status - 1;
         }
+        cm_line = get_loaded_cm_line(*cache_mem, info);
+    } else if(fill_missing_sector(cache_mem, stats, main_mem, info, addr, cm_line)) {
+        //The line is in the cache without the sector of the address, a read miss on that sector only
+        stats->total_misses++;
+        stats->read_misses++;
+        in_cache = 0;
+    }
+
+#ifdef CACHE_SIM_INSTRUMENT
+    if(cache_mem->instr) {
+        instr_record(cache_mem->instr, addr, info.set, in_cache, status);
+    }
+    if(cache_mem->hot && !in_cache) {
+        hot_record_miss(cache_mem->hot, addr, info.set);
+    }
+#endif
+
+    if(cache_mem->mshrs) {
+        time_access(cache_mem, addr, in_cache, dram_cycles);
     }
 
     //Increment program counter and set last program counter of the line to the current pc
-    cache_mem->pc++;
-    cache_mem->lines[get_loaded_cm_line(*cache_mem, info)].last_pc = cache_mem->pc;
+    touch_line(cache_mem, addr, info, cm_line);
 
     //Increase total number of actions and total number of reads
     stats->total_actions++;
@@ -631,6 +934,21 @@ int read_from_cache(struct cache* cache_mem, struct cache_stats* stats,
     return 0;
 }
 
+//Function to register an instruction fetch, a read which is counted apart from the data reads
+int fetch_from_cache(struct cache* cache_mem, struct cache_stats* stats,
+                     struct main_mem_block* main_mem, INT_TYPE addr) {
+    long reads = stats->total_reads;
+    long read_misses = stats->read_misses;
+    int status = read_from_cache(cache_mem, stats, main_mem, addr);
+
+    stats->total_fetches += stats->total_reads - reads;
+    stats->fetch_misses += stats->read_misses - read_misses;
+    stats->total_reads = reads;
+    stats->read_misses = read_misses;
+
+    return status;
+}
+
 //Function to write the results of the cache simulator to a file
 void write_cache_to_memory(struct cache* cache_mem, struct main_mem_block* main_mem) {
     //Increment through all cache lines
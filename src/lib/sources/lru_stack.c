@@ -0,0 +1,225 @@
+#include "../headers/lru_stack.h"
+//
+// LRU stack distance tracking for fully associative cache models
+//
+
+//Function to hash a block address into the table
+static long lru_stack_hash(INT_TYPE block, long table_size) {
+    unsigned long long x = (unsigned long long) block;
+    x *= 0x9E3779B97F4A7C15ULL;
+    return (long) ((x >> 32) & (unsigned long long) (table_size - 1));
+}
+
+//Function to add a value to a Fenwick tree position
+static void fenwick_add(int* tree, long slots, long index, int value) {
+    for(long i = index + 1; i <= slots; i += i & -i) {
+        tree[i] += value;
+    }
+}
+
+//Function to count the occupied slots at or below a position of a Fenwick tree
+static long fenwick_prefix(int* tree, long index) {
+    long total = 0;
+    for(long i = index + 1; i > 0; i -= i & -i) {
+        total += tree[i];
+    }
+    return total;
+}
+
+//Function to find the table index of a block, or -1 if it is not tracked
+static long lru_stack_find(struct lru_stack* stack, INT_TYPE block) {
+    long i = lru_stack_hash(block, stack->table_size);
+    while(stack->used[i]) {
+        if(stack->keys[i] == block) {
+            return i;
+        }
+        i = (i + 1) & (stack->table_size - 1);
+    }
+    return -1;
+}
+
+//Function to insert a block with the given timestamp into the table
+static void lru_stack_insert(struct lru_stack* stack, INT_TYPE block, long stamp) {
+    long i = lru_stack_hash(block, stack->table_size);
+    while(stack->used[i]) {
+        i = (i + 1) & (stack->table_size - 1);
+    }
+    stack->used[i] = 1;
+    stack->keys[i] = block;
+    stack->stamps[i] = stamp;
+}
+
+//Function to allocate the arrays of a stack for the given capacity
+static int lru_stack_allocate(struct lru_stack* stack, long capacity) {
+    stack->capacity = capacity;
+    stack->table_size = 16;
+    while(stack->table_size < capacity * 2) {
+        stack->table_size *= 2;
+    }
+    stack->slots = capacity * 2;
+
+    stack->keys = calloc(stack->table_size, sizeof(INT_TYPE));
+    stack->stamps = calloc(stack->table_size, sizeof(long));
+    stack->used = calloc(stack->table_size, sizeof(bool));
+    stack->owners = calloc(stack->slots, sizeof(INT_TYPE));
+    stack->occupied = calloc(stack->slots, sizeof(bool));
+    stack->tree = calloc(stack->slots + 1, sizeof(int));
+
+    if(!stack->keys || !stack->stamps || !stack->used || !stack->owners || !stack->occupied || !stack->tree) {
+        free_lru_stack(stack);
+        return 1;
+    }
+
+    return 0;
+}
+
+//Function for initializing an LRU stack which starts out able to track capacity blocks
+int init_lru_stack(struct lru_stack* stack, long capacity) {
+    memset(stack, 0, sizeof(struct lru_stack));
+    if(capacity < 8) {
+        capacity = 8;
+    }
+
+    return lru_stack_allocate(stack, capacity);
+}
+
+//Function to free the memory allocated to an LRU stack
+void free_lru_stack(struct lru_stack* stack) {
+    free(stack->keys);
+    free(stack->stamps);
+    free(stack->used);
+    free(stack->owners);
+    free(stack->occupied);
+    free(stack->tree);
+    memset(stack, 0, sizeof(struct lru_stack));
+}
+
+//Function to forget every tracked block while keeping the allocated memory
+void reset_lru_stack(struct lru_stack* stack) {
+    memset(stack->used, 0, stack->table_size * sizeof(bool));
+    memset(stack->occupied, 0, stack->slots * sizeof(bool));
+    memset(stack->tree, 0, (stack->slots + 1) * sizeof(int));
+    stack->live = 0;
+    stack->next_stamp = 0;
+}
+
+//Function to renumber the live timestamps from zero, growing the stack to new_capacity at the same time.
+//Relative order of the blocks is kept, so distances are unchanged
+static int lru_stack_rebuild(struct lru_stack* stack, long new_capacity) {
+    //Collect the live blocks from the oldest to the newest access
+    INT_TYPE* order = malloc((stack->live + 1) * sizeof(INT_TYPE));
+    if(!order) {
+        return 1;
+    }
+    long count = 0;
+    for(long i = 0; i < stack->next_stamp; i++) {
+        if(stack->occupied[i]) {
+            order[count++] = stack->owners[i];
+        }
+    }
+
+    if(new_capacity != stack->capacity) {
+        struct lru_stack grown;
+        memset(&grown, 0, sizeof(struct lru_stack));
+        if(lru_stack_allocate(&grown, new_capacity)) {
+            free(order);
+            return 1;
+        }
+        free_lru_stack(stack);
+        *stack = grown;
+    } else {
+        reset_lru_stack(stack);
+    }
+
+    //Reinsert the blocks with consecutive timestamps and build the Fenwick tree in linear time
+    for(long i = 0; i < count; i++) {
+        lru_stack_insert(stack, order[i], i);
+        stack->owners[i] = order[i];
+        stack->occupied[i] = 1;
+        stack->tree[i + 1] = 1;
+    }
+    for(long i = 1; i <= stack->slots; i++) {
+        long parent = i + (i & -i);
+        if(parent <= stack->slots) {
+            stack->tree[parent] += stack->tree[i];
+        }
+    }
+    stack->live = count;
+    stack->next_stamp = count;
+
+    free(order);
+    return 0;
+}
+
+//Function to register an access to a block, returns the number of distinct blocks accessed since the last
+//access to the same block, or LRU_STACK_COLD if the block has not been seen before
+long lru_stack_access(struct lru_stack* stack, INT_TYPE block) {
+    long distance = LRU_STACK_COLD;
+    long index = lru_stack_find(stack, block);
+
+    if(index >= 0) {
+        //Everything stamped after the previous access of this block sits above it in the stack
+        long stamp = stack->stamps[index];
+        distance = stack->live - fenwick_prefix(stack->tree, stamp);
+
+        stack->occupied[stamp] = 0;
+        fenwick_add(stack->tree, stack->slots, stamp, -1);
+        stack->live--;
+    } else if(stack->live == stack->capacity) {
+        //Out of room for a new block, double the capacity
+        if(lru_stack_rebuild(stack, stack->capacity * 2)) {
+            return distance;
+        }
+    }
+
+    //Out of timestamps, renumber the live blocks
+    if(stack->next_stamp == stack->slots) {
+        if(lru_stack_rebuild(stack, stack->capacity)) {
+            return distance;
+        }
+        index = lru_stack_find(stack, block);
+    }
+
+    long stamp = stack->next_stamp++;
+    if(index >= 0) {
+        stack->stamps[index] = stamp;
+    } else {
+        lru_stack_insert(stack, block, stamp);
+    }
+    stack->owners[stamp] = block;
+    stack->occupied[stamp] = 1;
+    fenwick_add(stack->tree, stack->slots, stamp, 1);
+    stack->live++;
+
+    return distance;
+}
+
+//Function to stop tracking a block, returns whether the block was tracked
+bool lru_stack_remove(struct lru_stack* stack, INT_TYPE block) {
+    long index = lru_stack_find(stack, block);
+    if(index < 0) {
+        return 0;
+    }
+
+    long stamp = stack->stamps[index];
+    stack->occupied[stamp] = 0;
+    fenwick_add(stack->tree, stack->slots, stamp, -1);
+    stack->live--;
+
+    //Backward shift deletion keeps the linear probing chains intact without tombstones
+    long hole = index;
+    long i = (index + 1) & (stack->table_size - 1);
+    while(stack->used[i]) {
+        long home = lru_stack_hash(stack->keys[i], stack->table_size);
+        //Move the entry into the hole if its home position does not lie between the hole and itself
+        if(((i - home) & (stack->table_size - 1)) >= ((i - hole) & (stack->table_size - 1))) {
+            stack->keys[hole] = stack->keys[i];
+            stack->stamps[hole] = stack->stamps[i];
+            hole = i;
+        }
+        i = (i + 1) & (stack->table_size - 1);
+    }
+    stack->used[hole] = 0;
+
+    return 1;
+}
@@ -0,0 +1,106 @@
+#include "../headers/mem_image.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+//
+// Loading main memory from a binary image and dumping the whole of main memory as one
+//
+
+//Function to initialize main memory from an image file, the file is mapped and copied straight into the
+//contiguous words of main memory
+int load_mem_image(struct main_mem_block* main_mem, char* path) {
+    size_t memory_size = (size_t) TOTAL_MM_BLOCKS * MM_WORDS_PER_BLOCK * WORD_SIZE;
+
+#ifdef _WIN32
+    FILE* in = fopen(path, "rb");
+    if(!in) {
+        printf("Error: Memory image could not be read!\n");
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    size_t size = (size_t) ftell(in);
+    fseek(in, 0, SEEK_SET);
+    if(size == 0 || size > memory_size || size % WORD_SIZE != 0) {
+        printf("Error: Memory image must be a whole number of words and at most %zu bytes\n", memory_size);
+        fclose(in);
+        return 1;
+    }
+    bool failure = fread(main_mem[0].words, 1, size, in) != size;
+    fclose(in);
+    if(failure) {
+        printf("Error: Memory image could not be read!\n");
+        return 1;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0) {
+        printf("Error: Memory image could not be read!\n");
+        if(fd >= 0) {
+            close(fd);
+        }
+        return 1;
+    }
+    size_t size = (size_t) info.st_size;
+    if(size == 0 || size > memory_size || size % WORD_SIZE != 0) {
+        printf("Error: Memory image must be a whole number of words and at most %zu bytes\n", memory_size);
+        close(fd);
+        return 1;
+    }
+
+    void* image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(image == MAP_FAILED) {
+        printf("Error: Memory image could not be mapped!\n");
+        return 1;
+    }
+    memcpy(main_mem[0].words, image, size);
+    munmap(image, size);
+#endif
+
+    return 0;
+}
+
+//Function to write the whole of main memory to an image file, the file is sized up front and mapped so
+//the words are copied into the page cache without going through a write buffer
+int dump_mem_image(struct main_mem_block* main_mem, char* path) {
+    size_t memory_size = (size_t) TOTAL_MM_BLOCKS * MM_WORDS_PER_BLOCK * WORD_SIZE;
+
+#ifdef _WIN32
+    FILE* out = fopen(path, "wb");
+    if(!out) {
+        printf("Error: Memory dump file could not be created / opened!\n");
+        return 1;
+    }
+    bool failure = fwrite(main_mem[0].words, 1, memory_size, out) != memory_size;
+    if(fclose(out) != 0 || failure) {
+        printf("Error: Could not write the memory dump to %s\n", path);
+        return 1;
+    }
+#else
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        printf("Error: Memory dump file could not be created / opened!\n");
+        return 1;
+    }
+    if(ftruncate(fd, (off_t) memory_size) != 0) {
+        printf("Error: Could not write the memory dump to %s\n", path);
+        close(fd);
+        return 1;
+    }
+
+    void* image = mmap(NULL, memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(image == MAP_FAILED) {
+        printf("Error: Memory dump file could not be mapped!\n");
+        return 1;
+    }
+    memcpy(image, main_mem[0].words, memory_size);
+    munmap(image, memory_size);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "../headers/mshr.h"
+//
+// Non-blocking cache timing: miss status holding registers tracking the misses in flight, with the memory
+// level parallelism and the stalls on a full set of registers
+//
+
+//Function for initializing the MSHRs of a non-blocking cache, all of them free at cycle 0
+int init_mshr_file(struct mshr_file* mshrs, int total, int miss_latency) {
+    memset(mshrs, 0, sizeof(struct mshr_file));
+    if(total < 1 || total > MAX_MSHRS) {
+        printf("Error: A non-blocking cache needs 1 to %d MSHRs, got %d\n", MAX_MSHRS, total);
+        return 1;
+    }
+    mshrs->total = total;
+    mshrs->miss_latency = miss_latency;
+
+    mshrs->busy = calloc(total, sizeof(bool));
+    mshrs->blocks = calloc(total, sizeof(INT_TYPE));
+    mshrs->ready = calloc(total, sizeof(unsigned long long));
+    mshrs->occupancy = calloc(total + 1, sizeof(unsigned long long));
+    if(!mshrs->busy || !mshrs->blocks || !mshrs->ready || !mshrs->occupancy) {
+        printf("Error: Could not allocate memory for the MSHRs\n");
+        free_mshr_file(mshrs);
+        return 1;
+    }
+    return 0;
+}
+
+//Function to free the memory allocated to the MSHRs
+void free_mshr_file(struct mshr_file* mshrs) {
+    free(mshrs->busy);
+    free(mshrs->blocks);
+    free(mshrs->ready);
+    free(mshrs->occupancy);
+    mshrs->busy = NULL;
+    mshrs->blocks = NULL;
+    mshrs->ready = NULL;
+    mshrs->occupancy = NULL;
+}
+
+//Function to count the registers taken during a stretch of cycles
+static void count_occupancy(struct mshr_file* mshrs, unsigned long long until) {
+    if(until > mshrs->counted) {
+        mshrs->occupancy[mshrs->used] += until - mshrs->counted;
+        mshrs->outstanding += (until - mshrs->counted) * (unsigned long long) mshrs->used;
+        mshrs->counted = until;
+    }
+}
+
+//Function to move time forward to a cycle, freeing the registers whose fills arrive on the way in the order
+//they arrive
+static void advance_mshrs(struct mshr_file* mshrs, unsigned long long until) {
+    while(mshrs->used > 0) {
+        int first = -1;
+        for(int i = 0; i < mshrs->total; i++) {
+            if(mshrs->busy[i] && (first < 0 || mshrs->ready[i] < mshrs->ready[first])) {
+                first = i;
+            }
+        }
+        if(first < 0 || mshrs->ready[first] > until) {
+            break;
+        }
+        count_occupancy(mshrs, mshrs->ready[first]);
+        mshrs->busy[first] = 0;
+        mshrs->used--;
+    }
+    count_occupancy(mshrs, until);
+    if(until > mshrs->clock) {
+        mshrs->clock = until;
+    }
+}
+
+//Function to time an access of a block. A miss takes a register for the miss latency plus the cycles the
+//memory took to serve it, stalling first if every register is taken, and any access to a block in flight
+//is a secondary miss merged into its register
+void mshr_access(struct mshr_file* mshrs, INT_TYPE block, bool miss, long memory_cycles) {
+    advance_mshrs(mshrs, mshrs->clock);
+    mshrs->accesses++;
+
+    for(int i = 0; i < mshrs->total; i++) {
+        if(mshrs->busy[i] && mshrs->blocks[i] == block) {
+            mshrs->secondary_misses++;
+            mshrs->clock += MSHR_ISSUE_CYCLES;
+            return;
+        }
+    }
+
+    if(miss) {
+        //Wait for the first fill to free a register, every register is taken here
+        if(mshrs->used == mshrs->total) {
+            unsigned long long first = mshrs->ready[0];
+            for(int i = 1; i < mshrs->total; i++) {
+                first = mshrs->ready[i] < first ? mshrs->ready[i] : first;
+            }
+            mshrs->stalls++;
+            mshrs->stall_cycles += first - mshrs->clock;
+            advance_mshrs(mshrs, first);
+        }
+
+        int free_register = 0;
+        while(mshrs->busy[free_register]) {
+            free_register++;
+        }
+        mshrs->busy[free_register] = 1;
+        mshrs->blocks[free_register] = block;
+        mshrs->ready[free_register] = mshrs->clock + (unsigned long long) mshrs->miss_latency
+                                      + (unsigned long long) memory_cycles;
+        mshrs->used++;
+        mshrs->peak = mshrs->used > mshrs->peak ? mshrs->used : mshrs->peak;
+        mshrs->primary_misses++;
+    }
+    mshrs->clock += MSHR_ISSUE_CYCLES;
+}
+
+//Function to let every miss still in flight complete, so that the run ends with its last fill
+void drain_mshr_file(struct mshr_file* mshrs) {
+    unsigned long long last = mshrs->clock;
+    for(int i = 0; i < mshrs->total; i++) {
+        if(mshrs->busy[i]) {
+            last = mshrs->ready[i] > last ? mshrs->ready[i] : last;
+        }
+    }
+    advance_mshrs(mshrs, last);
+}
+
+//Function to print the misses, the stalls on full registers, the memory level parallelism, which is the
+//average number of misses in flight over the cycles with at least one, and the register occupancy
+void print_mshr_report(FILE* out, struct mshr_file* mshrs) {
+    drain_mshr_file(mshrs);
+    unsigned long long cycles = mshrs->counted;
+    unsigned long long busy = cycles - mshrs->occupancy[0];
+
+    fprintf(out, "NON-BLOCKING CACHE:\n");
+    fprintf(out, "MSHRs: %d, miss latency: %d cycles plus the memory latency\n", mshrs->total,
+            mshrs->miss_latency);
+    fprintf(out, "Cycles: %llu, accesses: %ld, primary misses: %ld, secondary misses merged: %ld\n", cycles,
+            mshrs->accesses, mshrs->primary_misses, mshrs->secondary_misses);
+    fprintf(out, "Stalls on full MSHRs: %ld, stall cycles: %llu (%.6f of all cycles)\n", mshrs->stalls,
+            mshrs->stall_cycles, cycles == 0 ? 0.0 : (double) mshrs->stall_cycles / (double) cycles);
+    fprintf(out, "MLP: %.4f, average MSHR occupancy: %.4f, peak occupancy: %d\n",
+            busy == 0 ? 0.0 : (double) mshrs->outstanding / (double) busy,
+            cycles == 0 ? 0.0 : (double) mshrs->outstanding / (double) cycles, mshrs->peak);
+
+    fprintf(out, "\n%-6s %-14s %s\n", "MSHRs", "Cycles", "Fraction");
+    for(int i = 0; i <= mshrs->total; i++) {
+        if(mshrs->occupancy[i] > 0) {
+            fprintf(out, "%-6d %-14llu %.6f\n", i, mshrs->occupancy[i],
+                    (double) mshrs->occupancy[i] / (double) cycles);
+        }
+    }
+}
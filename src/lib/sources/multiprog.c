@@ -0,0 +1,216 @@
+#include "../headers/multiprog.h"
+//
+// Multi-programmed workloads interleaved on one shared cache
+//
+
+//Function for initializing the workloads, every trace is opened for reading
+int init_multiprog(struct multiprog* mp, struct cache cache_mem, char** traces, int total_workloads, long quantum) {
+    memset(mp, 0, sizeof(struct multiprog));
+    mp->total_workloads = total_workloads;
+    mp->quantum = quantum;
+
+    mp->workloads = calloc(total_workloads, sizeof(struct workload));
+    mp->owners = malloc(cache_mem.total_lines);
+    if(!mp->workloads || !mp->owners) {
+        printf("Error: Could not allocate memory for the workloads\n");
+        free_multiprog(mp);
+        return 1;
+    }
+    memset(mp->owners, NO_WORKLOAD, cache_mem.total_lines);
+
+    for(int i = 0; i < total_workloads; i++) {
+        mp->workloads[i].trace_name = traces[i];
+        mp->workloads[i].stats = zero_stats();
+        int status = open_trace_reader(&mp->workloads[i].reader, traces[i]);
+        if(status != 0) {
+            free_multiprog(mp);
+            return status;
+        }
+    }
+
+    return 0;
+}
+
+//Function to free the memory allocated to the workloads
+void free_multiprog(struct multiprog* mp) {
+    for(int i = 0; mp->workloads && i < mp->total_workloads; i++) {
+        close_trace_reader(&mp->workloads[i].reader);
+    }
+    free(mp->workloads);
+    free(mp->owners);
+    mp->workloads = NULL;
+    mp->owners = NULL;
+}
+
+//Function to run a single access of a workload, a miss into a full set is checked first for the line it is
+//going to evict so that evictions across workloads can be counted
+static int workload_access(struct multiprog* mp, int index, struct cache* cache_mem,
+                           struct main_mem_block* main_mem, struct trace_record record) {
+    if(cache_mem->partition) {
+        cache_mem->partition->current = index;
+    }
+
+    struct address_info info = cache_info_from_address(*cache_mem, record.addr);
+    if(!addr_in_cache(*cache_mem, info) && !set_has_empty(*cache_mem, info)) {
+        int owner = mp->owners[get_lru_cm_line(*cache_mem, info)];
+        if(owner != index && owner != NO_WORKLOAD) {
+            mp->workloads[owner].lines_lost++;
+            mp->workloads[index].lines_taken++;
+        }
+    }
+
+    int status = simulate_record(cache_mem, &mp->workloads[index].stats, main_mem, record);
+    mp->owners[get_loaded_cm_line(*cache_mem, info)] = (unsigned char) index;
+    return status;
+}
+
+//Function to run the workloads in round-robin order, quantum records at a time, until every trace ends.
+//Returns 4 if a trace is malformed like process_trace
+int run_multiprog(struct multiprog* mp, struct cache* cache_mem, struct main_mem_block* main_mem) {
+    mp->partition = cache_mem->partition;
+
+    int remaining = mp->total_workloads;
+    int last = -1;
+    while(remaining > 0) {
+        for(int i = 0; i < mp->total_workloads; i++) {
+            struct workload* workload = &mp->workloads[i];
+            for(long j = 0; j < mp->quantum && !workload->done; j++) {
+                struct trace_record record;
+                int result = read_trace_record(&workload->reader, &record);
+                if(result < 0) {
+                    printf("Error: Workload %d trace %s is malformed\n", i, workload->trace_name);
+                    return 4;
+                }
+                if(result == 0) {
+                    workload->done = 1;
+                    remaining--;
+                    break;
+                }
+
+                //Count a context switch whenever another workload gets the cache
+                if(last != i) {
+                    if(last >= 0) {
+                        mp->context_switches++;
+                    }
+                    last = i;
+                }
+                if(workload_access(mp, i, cache_mem, main_mem, record)) {
+                    return 4;
+                }
+            }
+        }
+    }
+
+    write_cache_to_memory(cache_mem, main_mem);
+    return 0;
+}
+
+//Function to run every workload alone on a fresh unpartitioned cache of the same geometry, giving the
+//baseline the interference is measured against
+int run_solo(struct multiprog* mp, struct cache geometry) {
+    geometry.partition = NULL;
+    geometry.tracker = NULL;
+    geometry.occupancy = NULL;
+
+    for(int i = 0; i < mp->total_workloads; i++) {
+        struct workload* workload = &mp->workloads[i];
+        struct trace_reader reader;
+        memset(&reader, 0, sizeof(struct trace_reader));
+        int status = open_trace_reader(&reader, workload->trace_name);
+        if(status != 0) {
+            return status;
+        }
+
+        struct main_mem_block* main_mem = init_main_mem();
+        struct cache cache_mem = init_cache_mem(geometry);
+        workload->solo_stats = zero_stats();
+
+        struct trace_record record;
+        int result;
+        while((result = read_trace_record(&reader, &record)) > 0) {
+            simulate_record(&cache_mem, &workload->solo_stats, main_mem, record);
+        }
+        close_trace_reader(&reader);
+        free_io(cache_mem, main_mem);
+        if(result < 0) {
+            return 4;
+        }
+        workload->has_solo = 1;
+    }
+
+    return 0;
+}
+
+//Function to add up the statistics of every workload, which are the statistics of the shared cache
+struct cache_stats multiprog_total_stats(struct multiprog* mp) {
+    struct cache_stats total = zero_stats();
+    for(int i = 0; i < mp->total_workloads; i++) {
+        struct cache_stats stats = mp->workloads[i].stats;
+        total.total_actions += stats.total_actions;
+        total.total_reads += stats.total_reads;
+        total.total_writes += stats.total_writes;
+        total.total_misses += stats.total_misses;
+        total.read_misses += stats.read_misses;
+        total.write_misses += stats.write_misses;
+        total.total_evictions += stats.total_evictions;
+        total.dirty_evictions += stats.dirty_evictions;
+        total.total_loads += stats.total_loads;
+        total.sector_misses += stats.sector_misses;
+        total.bytes_filled += stats.bytes_filled;
+        total.bytes_written_back += stats.bytes_written_back;
+        total.total_fetches += stats.total_fetches;
+        total.fetch_misses += stats.fetch_misses;
+    }
+    return total;
+}
+
+//Function to count the ways in a way mask
+static int count_ways(unsigned int mask) {
+    int count = 0;
+    for(; mask != 0; mask >>= 1) {
+        count += mask & 1;
+    }
+    return count;
+}
+
+//Function to print the statistics of every workload and the interference between them
+void print_multiprog_report(FILE* out, struct multiprog* mp) {
+    bool solo = mp->total_workloads > 0 && mp->workloads[0].has_solo;
+
+    fprintf(out, "MULTI-PROGRAMMED WORKLOADS:\n");
+    fprintf(out, "%-5s %-10s %-10s %-9s %-10s %-10s %-10s %-5s", "Wkld", "Accesses", "Misses", "MissRate",
+            "Evictions", "LinesLost", "LinesTaken", "Ways");
+    if(solo) {
+        fprintf(out, " %-10s %-9s %-9s", "SoloMiss", "SoloRate", "MissRatio");
+    }
+    fprintf(out, " %s\n", "Trace");
+
+    for(int i = 0; i < mp->total_workloads; i++) {
+        struct workload* workload = &mp->workloads[i];
+        struct cache_stats stats = workload->stats;
+        int ways = mp->partition ? count_ways(mp->partition->masks[i]) : 0;
+        fprintf(out, "%-5d %-10ld %-10ld %-9.6f %-10ld %-10ld %-10ld ", i, stats.total_actions,
+                stats.total_misses,
+                stats.total_actions == 0 ? 0.0 : (double) stats.total_misses / (double) stats.total_actions,
+                stats.total_evictions, workload->lines_lost, workload->lines_taken);
+        if(ways > 0) {
+            fprintf(out, "%-5d", ways);
+        } else {
+            fprintf(out, "%-5s", "all");
+        }
+        if(solo) {
+            struct cache_stats alone = workload->solo_stats;
+            fprintf(out, " %-10ld %-9.6f %-9.3f", alone.total_misses,
+                    alone.total_actions == 0 ? 0.0 : (double) alone.total_misses / (double) alone.total_actions,
+                    alone.total_misses == 0 ? 0.0 : (double) stats.total_misses / (double) alone.total_misses);
+        }
+        fprintf(out, " %s\n", workload->trace_name);
+    }
+
+    fprintf(out, "\nRound-robin quantum: %ld records, context switches: %ld\n", mp->quantum, mp->context_switches);
+    if(mp->partition && mp->partition->qos) {
+        fprintf(out, "Set dueling: partitioned leader misses: %ld, shared leader misses: %ld, followers %s\n",
+                mp->partition->partitioned_leader_misses, mp->partition->shared_leader_misses,
+                partition_followers_partitioned(mp->partition) ? "partitioned" : "shared");
+    }
+}
@@ -0,0 +1,114 @@
+#include "../headers/occupancy.h"
+//
+// Per-set fill, eviction, and occupancy statistics, used to compare set index functions
+//
+
+//Function for initializing the per-set counters of a cache
+int init_set_occupancy(struct set_occupancy* occupancy, struct cache cache_mem) {
+    occupancy->total_sets = cache_mem.total_sets;
+    occupancy->fills = calloc(cache_mem.total_sets, sizeof(long));
+    occupancy->evictions = calloc(cache_mem.total_sets, sizeof(long));
+    if(!occupancy->fills || !occupancy->evictions) {
+        printf("Error: Could not allocate memory for the set occupancy counters\n");
+        free_set_occupancy(occupancy);
+        return 1;
+    }
+    return 0;
+}
+
+//Function to free the memory allocated to the per-set counters
+void free_set_occupancy(struct set_occupancy* occupancy) {
+    free(occupancy->fills);
+    free(occupancy->evictions);
+    occupancy->fills = NULL;
+    occupancy->evictions = NULL;
+}
+
+//Function to record a line filled into a set, and whether a line of the set had to be evicted for it
+void record_set_fill(struct set_occupancy* occupancy, INT_TYPE set, bool evicted) {
+    occupancy->fills[set]++;
+    if(evicted) {
+        occupancy->evictions[set]++;
+    }
+}
+
+//Function to print the smallest, mean, and largest value of a per-set counter, and its coefficient of
+//variation which is 0 when every set carries the same load
+static void print_spread(FILE* out, char* title, long* counts, int total_sets) {
+    long smallest = counts[0];
+    long largest = counts[0];
+    double sum = 0;
+    for(int i = 0; i < total_sets; i++) {
+        smallest = counts[i] < smallest ? counts[i] : smallest;
+        largest = counts[i] > largest ? counts[i] : largest;
+        sum += (double) counts[i];
+    }
+    double mean = sum / total_sets;
+    double variance = 0;
+    for(int i = 0; i < total_sets; i++) {
+        variance += ((double) counts[i] - mean) * ((double) counts[i] - mean);
+    }
+    variance /= total_sets;
+
+    fprintf(out, "%s per set: min %ld, mean %.2f, max %ld, coefficient of variation %.4f\n", title, smallest, mean,
+            largest, mean == 0 ? 0.0 : sqrt(variance) / mean);
+}
+
+//Function to print how evenly the fills and evictions spread over the sets, and how full the sets are
+void print_set_occupancy(FILE* out, struct set_occupancy* occupancy, struct cache cache_mem) {
+    int total_sets = occupancy->total_sets;
+    int* valid = calloc(total_sets, sizeof(int));
+    long* histogram = calloc(cache_mem.associativity + 1, sizeof(long));
+    if(!valid || !histogram) {
+        free(valid);
+        free(histogram);
+        return;
+    }
+
+    int used = 0;
+    for(int i = 0; i < total_sets; i++) {
+        used += occupancy->fills[i] > 0;
+    }
+    for(int i = 0; i < cache_mem.total_lines; i++) {
+        valid[cache_mem.lines[i].set] += cache_mem.lines[i].loaded;
+    }
+    for(int i = 0; i < total_sets; i++) {
+        histogram[valid[i]]++;
+    }
+
+    fprintf(out, "SET OCCUPANCY (%s indexing):\n", index_function_name(cache_mem.index_function));
+    fprintf(out, "Sets filled at least once: %d of %d", used, total_sets);
+    if(cache_mem.index_function == INDEX_PRIME) {
+        fprintf(out, " (prime indexing uses %llu)", (unsigned long long) cache_mem.index_prime);
+    }
+    fprintf(out, "\n");
+    print_spread(out, "Fills", occupancy->fills, total_sets);
+    print_spread(out, "Evictions", occupancy->evictions, total_sets);
+
+    fprintf(out, "\nValid lines per set at the end:\n%-6s %s\n", "Lines", "Sets");
+    for(int i = 0; i <= cache_mem.associativity; i++) {
+        fprintf(out, "%-6d %ld\n", i, histogram[i]);
+    }
+
+    //Pick the busiest sets by repeatedly taking the most filled set not listed yet
+    fprintf(out, "\nBusiest sets:\n%-6s %-10s %-10s %s\n", "Set", "Fills", "Evictions", "Valid");
+    bool* listed = calloc(total_sets, sizeof(bool));
+    for(int n = 0; listed && n < OCCUPANCY_TOP_SETS && n < total_sets; n++) {
+        int busiest = -1;
+        for(int i = 0; i < total_sets; i++) {
+            if(!listed[i] && (busiest < 0 || occupancy->fills[i] > occupancy->fills[busiest])) {
+                busiest = i;
+            }
+        }
+        if(occupancy->fills[busiest] == 0) {
+            break;
+        }
+        listed[busiest] = 1;
+        fprintf(out, "%-6d %-10ld %-10ld %d\n", busiest, occupancy->fills[busiest], occupancy->evictions[busiest],
+                valid[busiest]);
+    }
+
+    free(listed);
+    free(valid);
+    free(histogram);
+}
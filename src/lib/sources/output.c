@@ -0,0 +1,423 @@
+#include <stdarg.h>
+#include "../headers/output.h"
+//
+// Buffered result formatter for the statistics, cache contents, and main memory window
+//
+
+//Two uppercase hex digits for every byte value, so a word is encoded with one lookup per byte
+static const char HEX_PAIRS[513] =
+        "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F202122232425262728292A2B2C2D2E2F"
+        "303132333435363738393A3B3C3D3E3F404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+        "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F808182838485868788898A8B8C8D8E8F"
+        "909192939495969798999A9B9C9D9E9FA0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+        "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDFE0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+        "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+//Function for setting the output settings to the defaults, the text format with the fixed memory window
+struct output_config zero_output_config() {
+    struct output_config primer;
+
+    primer.format = OUTPUT_TEXT;
+    primer.dump = 1;
+    primer.traffic = 0;
+    primer.mem_start = MAIN_MEMORY_START_PRINT;
+    primer.mem_size = MAIN_MEMORY_PRINT_SIZE;
+
+    return primer;
+}
+
+//Function to verify the memory window lies inside main memory, returns non-zero if it does not
+int check_output_config(struct output_config config) {
+    long total_words = (long) TOTAL_MM_BLOCKS * MM_WORDS_PER_BLOCK;
+
+    if(config.mem_size < 0 || (long) config.mem_start >= total_words || (long) config.mem_start + config.mem_size > total_words) {
+        printf("Error: Memory window must lie inside main memory (0 to %lX)\n", total_words);
+        return 1;
+    }
+    return 0;
+}
+
+//Function to make room for at least size more bytes in the buffer
+static bool reserve_output(struct output_buffer* buffer, size_t size) {
+    if(buffer->failed) {
+        return 0;
+    }
+    if(buffer->used + size <= buffer->capacity) {
+        return 1;
+    }
+
+    size_t capacity = buffer->capacity == 0 ? 4096 : buffer->capacity;
+    while(capacity < buffer->used + size) {
+        capacity *= 2;
+    }
+    char* data = realloc(buffer->data, capacity);
+    if(!data) {
+        buffer->failed = 1;
+        return 0;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+
+    return 1;
+}
+
+//Function to append a string to the buffer
+static void put_string(struct output_buffer* buffer, const char* text) {
+    size_t length = strlen(text);
+    if(reserve_output(buffer, length)) {
+        memcpy(buffer->data + buffer->used, text, length);
+        buffer->used += length;
+    }
+}
+
+//Function to append printf style formatted text, only used outside of the per line loops
+static void put_format(struct output_buffer* buffer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    if(length < 0 || !reserve_output(buffer, (size_t) length + 1)) {
+        return;
+    }
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->used, (size_t) length + 1, format, args);
+    va_end(args);
+    buffer->used += length;
+}
+
+//Function to append a value as uppercase hex padded with zeros to at least width digits, like %0*X
+static void put_hex(struct output_buffer* buffer, unsigned long long value, int width) {
+    int digits = 1;
+    for(unsigned long long rest = value >> 4; rest != 0; rest >>= 4) {
+        digits++;
+    }
+    if(digits < width) {
+        digits = width;
+    }
+    if(!reserve_output(buffer, (size_t) digits)) {
+        return;
+    }
+
+    //Fill from the right, two digits per table lookup
+    char* out = buffer->data + buffer->used + digits;
+    int remaining = digits;
+    while(remaining >= 2) {
+        out -= 2;
+        memcpy(out, &HEX_PAIRS[(value & 0xFF) * 2], 2);
+        value >>= 8;
+        remaining -= 2;
+    }
+    if(remaining == 1) {
+        *(out - 1) = HEX_PAIRS[(value & 0xF) * 2 + 1];
+    }
+    buffer->used += digits;
+}
+
+//Function to append a non-negative integer left justified in width characters, like %-*d
+static void put_left_int(struct output_buffer* buffer, long value, int width) {
+    char digits[24];
+    int length = 0;
+    do {
+        digits[length++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while(value > 0);
+
+    int total = length > width ? length : width;
+    if(!reserve_output(buffer, (size_t) total)) {
+        return;
+    }
+    char* out = buffer->data + buffer->used;
+    for(int i = 0; i < length; i++) {
+        out[i] = digits[length - 1 - i];
+    }
+    memset(out + length, ' ', (size_t) (total - length));
+    buffer->used += total;
+}
+
+//Function to append a single character
+static void put_char(struct output_buffer* buffer, char c) {
+    if(reserve_output(buffer, 1)) {
+        buffer->data[buffer->used++] = c;
+    }
+}
+
+//Function to calculate the miss rates, zero when there was nothing to miss
+static void miss_rates(struct cache_stats stats, float* miss_rate, float* read_miss_rate, float* write_miss_rate) {
+    *miss_rate = ((float) stats.total_misses / (float) stats.total_actions);
+    *read_miss_rate = ((float) stats.read_misses / (float) stats.total_reads);
+    *write_miss_rate = ((float) stats.write_misses / (float) stats.total_writes);
+
+    if(isnan(*miss_rate)) {
+        *miss_rate = 0.0;
+    }
+    if(isnan(*read_miss_rate)) {
+        *read_miss_rate = 0.0;
+    }
+    if(isnan(*write_miss_rate)) {
+        *write_miss_rate = 0.0;
+    }
+}
+
+//Function to get the first and one past the last main memory block of the memory window
+static void window_blocks(struct output_config config, int* start_block, int* end_block) {
+    *start_block = (int) (config.mem_start / MM_WORDS_PER_BLOCK);
+    *end_block = (int) (((long) config.mem_start + config.mem_size + MM_WORDS_PER_BLOCK - 1) / MM_WORDS_PER_BLOCK);
+    if(*end_block > TOTAL_MM_BLOCKS) {
+        *end_block = TOTAL_MM_BLOCKS;
+    }
+}
+
+//Function to format the results in the original text layout
+static void format_text(struct output_buffer* buffer, struct cache cache_mem, struct cache_stats stats,
+                        struct main_mem_block* main_mem, struct output_config config) {
+    float miss_rate, read_miss_rate, write_miss_rate;
+    miss_rates(stats, &miss_rate, &read_miss_rate, &write_miss_rate);
+
+    put_string(buffer, "STATISTICS:\n");
+    put_string(buffer, "Misses:\n");
+    put_format(buffer, "Total: %ld DataReads: %ld DataWrites: %ld\n", stats.total_misses, stats.read_misses, stats.write_misses);
+    put_string(buffer, "Miss rate:\n");
+    put_format(buffer, "Total: %.6f DataReads: %.6f DataWrites: %.6f\n", miss_rate, read_miss_rate, write_miss_rate);
+    if(stats.total_fetches > 0) {
+        put_format(buffer, "Instruction fetches: %ld Misses: %ld Miss rate: %.6f\n", stats.total_fetches,
+                   stats.fetch_misses, (float) stats.fetch_misses / (float) stats.total_fetches);
+    }
+    put_format(buffer, "Number of Dirty Blocks Evicted from the Cache: %ld\n", stats.dirty_evictions);
+    if(config.traffic) {
+        put_format(buffer, "Sector Misses: %ld\n", stats.sector_misses);
+        put_format(buffer, "Bytes Filled: %ld Bytes Written Back: %ld\n", stats.bytes_filled, stats.bytes_written_back);
+    }
+    put_char(buffer, '\n');
+    if(!config.dump) {
+        return;
+    }
+
+    put_string(buffer, "CACHE CONTENTS\n");
+    put_format(buffer, "%-6s %-3s %-8s %-8s", "Set", "V", "Tag", " Dirty");
+    for(int i = 0; i < cache_mem.words_per_line; i++) {
+        put_string(buffer, "Word");
+        put_left_int(buffer, i, 7);
+    }
+    put_char(buffer, '\n');
+
+    for(int i = 0; i < cache_mem.total_lines; i++) {
+        struct cache_mem_block block = cache_mem.lines[i];
+        put_hex(buffer, block.set, 4);
+        put_string(buffer, "   ");
+        put_left_int(buffer, block.valid, 3);
+        put_char(buffer, ' ');
+        put_hex(buffer, block.tag, 8);
+        put_string(buffer, "    ");
+        put_left_int(buffer, block.dirty, 5);
+
+        for(int j = 0; j < cache_mem.words_per_line; j++) {
+            put_hex(buffer, block.words[j], 8);
+            put_string(buffer, "   ");
+        }
+        put_char(buffer, '\n');
+    }
+    put_char(buffer, '\n');
+
+    put_string(buffer, "MAIN MEMORY:\n");
+    put_format(buffer, "%-11s", "Address");
+    for(int i = 0; i < MM_WORDS_PER_BLOCK; i++) {
+        put_string(buffer, "Word");
+        put_left_int(buffer, i, 7);
+    }
+    put_char(buffer, '\n');
+
+    int start_block, end_block;
+    window_blocks(config, &start_block, &end_block);
+    for(int i = start_block; i < end_block; i++) {
+        struct main_mem_block block = main_mem[i];
+        put_hex(buffer, block.address, 8);
+        put_string(buffer, "   ");
+
+        for(int j = 0; j < MM_WORDS_PER_BLOCK; j++) {
+            put_hex(buffer, block.words[j], 8);
+            put_string(buffer, "   ");
+        }
+        put_char(buffer, '\n');
+    }
+}
+
+//Function to format the results as CSV tables separated by blank lines
+static void format_csv(struct output_buffer* buffer, struct cache cache_mem, struct cache_stats stats,
+                       struct main_mem_block* main_mem, struct output_config config) {
+    float miss_rate, read_miss_rate, write_miss_rate;
+    miss_rates(stats, &miss_rate, &read_miss_rate, &write_miss_rate);
+
+    put_string(buffer, "statistic,value\n");
+    put_format(buffer, "accesses,%ld\nreads,%ld\nwrites,%ld\n", stats.total_actions, stats.total_reads, stats.total_writes);
+    put_format(buffer, "total_misses,%ld\nread_misses,%ld\nwrite_misses,%ld\n", stats.total_misses, stats.read_misses,
+               stats.write_misses);
+    put_format(buffer, "miss_rate,%.6f\nread_miss_rate,%.6f\nwrite_miss_rate,%.6f\n", miss_rate, read_miss_rate,
+               write_miss_rate);
+    put_format(buffer, "evictions,%ld\ndirty_evictions,%ld\n", stats.total_evictions, stats.dirty_evictions);
+    if(stats.total_fetches > 0) {
+        put_format(buffer, "fetches,%ld\nfetch_misses,%ld\n", stats.total_fetches, stats.fetch_misses);
+    }
+    if(config.traffic) {
+        put_format(buffer, "sector_misses,%ld\nbytes_filled,%ld\nbytes_written_back,%ld\n", stats.sector_misses,
+                   stats.bytes_filled, stats.bytes_written_back);
+    }
+    if(!config.dump) {
+        return;
+    }
+
+    put_string(buffer, "\nset,valid,tag,dirty");
+    for(int i = 0; i < cache_mem.words_per_line; i++) {
+        put_string(buffer, ",word");
+        put_left_int(buffer, i, 0);
+    }
+    put_char(buffer, '\n');
+    for(int i = 0; i < cache_mem.total_lines; i++) {
+        struct cache_mem_block block = cache_mem.lines[i];
+        put_left_int(buffer, block.set, 0);
+        put_char(buffer, ',');
+        put_left_int(buffer, block.valid, 0);
+        put_char(buffer, ',');
+        put_hex(buffer, block.tag, 8);
+        put_char(buffer, ',');
+        put_left_int(buffer, block.dirty, 0);
+        for(int j = 0; j < cache_mem.words_per_line; j++) {
+            put_char(buffer, ',');
+            put_hex(buffer, block.words[j], 8);
+        }
+        put_char(buffer, '\n');
+    }
+
+    put_string(buffer, "\naddress");
+    for(int i = 0; i < MM_WORDS_PER_BLOCK; i++) {
+        put_string(buffer, ",word");
+        put_left_int(buffer, i, 0);
+    }
+    put_char(buffer, '\n');
+
+    int start_block, end_block;
+    window_blocks(config, &start_block, &end_block);
+    for(int i = start_block; i < end_block; i++) {
+        put_hex(buffer, main_mem[i].address, 8);
+        for(int j = 0; j < MM_WORDS_PER_BLOCK; j++) {
+            put_char(buffer, ',');
+            put_hex(buffer, main_mem[i].words[j], 8);
+        }
+        put_char(buffer, '\n');
+    }
+}
+
+//Function to append a JSON array of hex words
+static void put_json_words(struct output_buffer* buffer, INT_TYPE* words, int count) {
+    put_string(buffer, "\"words\": [");
+    for(int j = 0; j < count; j++) {
+        put_string(buffer, j == 0 ? "\"" : ", \"");
+        put_hex(buffer, words[j], 8);
+        put_char(buffer, '"');
+    }
+    put_char(buffer, ']');
+}
+
+//Function to format the results as a single JSON object
+static void format_json(struct output_buffer* buffer, struct cache cache_mem, struct cache_stats stats,
+                        struct main_mem_block* main_mem, struct output_config config) {
+    float miss_rate, read_miss_rate, write_miss_rate;
+    miss_rates(stats, &miss_rate, &read_miss_rate, &write_miss_rate);
+
+    put_string(buffer, "{\n  \"statistics\": {");
+    put_format(buffer, "\"accesses\": %ld, \"reads\": %ld, \"writes\": %ld, ", stats.total_actions, stats.total_reads,
+               stats.total_writes);
+    put_format(buffer, "\"total_misses\": %ld, \"read_misses\": %ld, \"write_misses\": %ld, ", stats.total_misses,
+               stats.read_misses, stats.write_misses);
+    put_format(buffer, "\"miss_rate\": %.6f, \"read_miss_rate\": %.6f, \"write_miss_rate\": %.6f, ", miss_rate,
+               read_miss_rate, write_miss_rate);
+    put_format(buffer, "\"evictions\": %ld, \"dirty_evictions\": %ld", stats.total_evictions, stats.dirty_evictions);
+    if(stats.total_fetches > 0) {
+        put_format(buffer, ", \"fetches\": %ld, \"fetch_misses\": %ld", stats.total_fetches, stats.fetch_misses);
+    }
+    if(config.traffic) {
+        put_format(buffer, ", \"sector_misses\": %ld, \"bytes_filled\": %ld, \"bytes_written_back\": %ld",
+                   stats.sector_misses, stats.bytes_filled, stats.bytes_written_back);
+    }
+    put_char(buffer, '}');
+    if(!config.dump) {
+        put_string(buffer, "\n}\n");
+        return;
+    }
+
+    put_string(buffer, ",\n  \"cache\": [\n");
+    for(int i = 0; i < cache_mem.total_lines; i++) {
+        struct cache_mem_block block = cache_mem.lines[i];
+        put_string(buffer, "    {\"set\": ");
+        put_left_int(buffer, block.set, 0);
+        put_string(buffer, ", \"valid\": ");
+        put_left_int(buffer, block.valid, 0);
+        put_string(buffer, ", \"tag\": \"");
+        put_hex(buffer, block.tag, 8);
+        put_string(buffer, "\", \"dirty\": ");
+        put_left_int(buffer, block.dirty, 0);
+        put_string(buffer, ", ");
+        put_json_words(buffer, block.words, cache_mem.words_per_line);
+        put_string(buffer, i + 1 < cache_mem.total_lines ? "},\n" : "}\n");
+    }
+
+    put_string(buffer, "  ],\n  \"memory\": [\n");
+    int start_block, end_block;
+    window_blocks(config, &start_block, &end_block);
+    for(int i = start_block; i < end_block; i++) {
+        put_string(buffer, "    {\"address\": \"");
+        put_hex(buffer, main_mem[i].address, 8);
+        put_string(buffer, "\", ");
+        put_json_words(buffer, main_mem[i].words, MM_WORDS_PER_BLOCK);
+        put_string(buffer, i + 1 < end_block ? "},\n" : "}\n");
+    }
+    put_string(buffer, "  ]\n}\n");
+}
+
+//Function to format the results into a newly allocated buffer, which the caller frees
+char* format_results(struct cache cache_mem, struct cache_stats stats, struct main_mem_block* main_mem,
+                     struct output_config config, size_t* length) {
+    struct output_buffer buffer;
+    memset(&buffer, 0, sizeof(struct output_buffer));
+
+    //Size the buffer up front for the dump so the formatting loops never reallocate
+    int start_block, end_block;
+    window_blocks(config, &start_block, &end_block);
+    size_t estimate = 4096;
+    if(config.dump) {
+        estimate += (size_t) cache_mem.total_lines * (64 + (size_t) cache_mem.words_per_line * 12)
+                  + (size_t) (end_block - start_block) * (32 + MM_WORDS_PER_BLOCK * 12);
+    }
+    reserve_output(&buffer, estimate);
+
+    if(config.format == OUTPUT_CSV) {
+        format_csv(&buffer, cache_mem, stats, main_mem, config);
+    } else if(config.format == OUTPUT_JSON) {
+        format_json(&buffer, cache_mem, stats, main_mem, config);
+    } else {
+        format_text(&buffer, cache_mem, stats, main_mem, config);
+    }
+
+    if(buffer.failed) {
+        free(buffer.data);
+        return NULL;
+    }
+    *length = buffer.used;
+    return buffer.data;
+}
+
+//Function to format the results and write them to a stream with a single write
+int write_results(FILE* out, struct cache cache_mem, struct cache_stats stats, struct main_mem_block* main_mem,
+                  struct output_config config) {
+    size_t length;
+    char* data = format_results(cache_mem, stats, main_mem, config, &length);
+    if(!data) {
+        printf("Error: Could not allocate memory for the results\n");
+        return 1;
+    }
+
+    size_t written = fwrite(data, 1, length, out);
+    free(data);
+
+    return written != length;
+}
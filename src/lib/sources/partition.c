@@ -0,0 +1,79 @@
+#include "../headers/partition.h"
+//
+// Way partitioning of a shared cache between workloads, with optional set dueling QoS
+//
+
+//Function for initializing a way partition, every workload gets its number of ways in order starting at way
+//0 and the ways nobody was given are shared by all workloads
+int init_way_partition(struct way_partition* partition, struct cache cache_mem, int* ways, int total_workloads,
+                       bool qos) {
+    memset(partition, 0, sizeof(struct way_partition));
+    partition->total_workloads = total_workloads;
+    partition->all_ways = cache_mem.associativity >= 32 ? ~0u : (1u << cache_mem.associativity) - 1;
+
+    int first_way = 0;
+    for(int i = 0; i < total_workloads; i++) {
+        if(ways[i] <= 0 || first_way + ways[i] > cache_mem.associativity) {
+            printf("Error: The partition needs at least one way per workload and at most %d ways in total\n",
+                   cache_mem.associativity);
+            return 1;
+        }
+        partition->masks[i] = ((1u << ways[i]) - 1) << first_way;
+        first_way += ways[i];
+    }
+    unsigned int shared = partition->all_ways & ~((1u << first_way) - 1);
+    for(int i = 0; i < total_workloads; i++) {
+        partition->masks[i] |= shared;
+    }
+
+    //Every dueling period needs a leader set of each policy and at least one follower
+    if(qos) {
+        if(cache_mem.total_sets < 4) {
+            printf("Error: Set dueling needs a cache with at least 4 sets\n");
+            return 1;
+        }
+        partition->qos = 1;
+        partition->period = cache_mem.total_sets / 2 < PARTITION_DUEL_PERIOD ? cache_mem.total_sets / 2
+                                                                              : PARTITION_DUEL_PERIOD;
+        partition->psel = (PARTITION_PSEL_MAX + 1) / 2;
+    }
+
+    return 0;
+}
+
+//Function to check whether the follower sets currently use the partition, which is the case while the
+//partitioned leader sets miss no more than the shared ones
+bool partition_followers_partitioned(struct way_partition* partition) {
+    return partition->psel <= (PARTITION_PSEL_MAX + 1) / 2;
+}
+
+//Function to get the ways of a set the current workload may fill or evict
+unsigned int partition_ways(struct way_partition* partition, INT_TYPE set) {
+    if(partition->qos) {
+        INT_TYPE slot = set % partition->period;
+        if(slot == 1 || (slot != 0 && !partition_followers_partitioned(partition))) {
+            return partition->all_ways;
+        }
+    }
+    return partition->masks[partition->current];
+}
+
+//Function to record a miss in a set, misses in the leader sets steer the policy of the followers
+void partition_record_miss(struct way_partition* partition, INT_TYPE set) {
+    if(!partition->qos) {
+        return;
+    }
+
+    INT_TYPE slot = set % partition->period;
+    if(slot == 0) {
+        partition->partitioned_leader_misses++;
+        if(partition->psel < PARTITION_PSEL_MAX) {
+            partition->psel++;
+        }
+    } else if(slot == 1) {
+        partition->shared_leader_misses++;
+        if(partition->psel > 0) {
+            partition->psel--;
+        }
+    }
+}
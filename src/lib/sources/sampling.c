@@ -0,0 +1,229 @@
+#include "../headers/sampling.h"
+//
+// Statistical sampling (set sampling and time sampling) for the cache simulator
+//
+
+//Function for setting the values of a sampling config to the disabled state
+struct sample_config zero_sample_config() {
+    struct sample_config primer;
+
+    primer.mode = SAMPLE_NONE;
+    primer.set_ratio = 0;
+    primer.period = 0;
+    primer.window = 0;
+    primer.warmup = -1;
+
+    return primer;
+}
+
+//Function to make sure the unit array can hold the given unit index
+static int reserve_units(struct sampler* sampler, long unit) {
+    if(unit < sampler->capacity_units) {
+        return 0;
+    }
+
+    //Grow geometrically so long traces only reallocate a handful of times
+    long new_capacity = sampler->capacity_units == 0 ? 64 : sampler->capacity_units;
+    while(new_capacity <= unit) {
+        new_capacity *= 2;
+    }
+
+    struct sample_unit* units = realloc(sampler->units, new_capacity * sizeof(struct sample_unit));
+    if(!units) {
+        return 1;
+    }
+    memset(units + sampler->capacity_units, 0, (new_capacity - sampler->capacity_units) * sizeof(struct sample_unit));
+
+    sampler->units = units;
+    sampler->capacity_units = new_capacity;
+
+    return 0;
+}
+
+//Function for initializing a sampler, returns non-zero if the config does not fit the cache
+int init_sampler(struct sampler* sampler, struct sample_config config, struct cache cache_mem) {
+    memset(sampler, 0, sizeof(struct sampler));
+    sampler->config = config;
+    sampler->total_sets = cache_mem.total_sets;
+    sampler->cache_block_size = cache_mem.line_size;
+    sampler->warm_stats = zero_stats();
+
+    if(config.mode == SAMPLE_SETS) {
+        //Need at least one set to sample
+        if(config.set_ratio < 1 || config.set_ratio > cache_mem.total_sets) {
+            printf("Error: Set sampling ratio must be between 1 and the number of sets (%d)\n", cache_mem.total_sets);
+            return 1;
+        }
+
+        //One unit per sampled set, every set_ratio-th set starting at set 0
+        sampler->total_units = (cache_mem.total_sets + config.set_ratio - 1) / config.set_ratio;
+        return reserve_units(sampler, sampler->total_units - 1);
+    } else if(config.mode == SAMPLE_TIME) {
+        if(config.period < 1 || config.window < 1 || config.window > config.period) {
+            printf("Error: Sample window must be between 1 and the sample period\n");
+            return 1;
+        }
+        if(config.warmup > config.period - config.window) {
+            printf("Error: Sample warmup must fit in the sample period minus the sample window\n");
+            return 1;
+        }
+
+        return reserve_units(sampler, 0);
+    }
+
+    return 0;
+}
+
+//Function to free the memory allocated to a sampler
+void free_sampler(struct sampler* sampler) {
+    free(sampler->units);
+    sampler->units = NULL;
+    sampler->capacity_units = 0;
+}
+
+//Function to decide whether an access is skipped, only warms the cache, or is measured
+int sampler_classify(struct sampler* sampler, int read_write, INT_TYPE addr) {
+    long position = sampler->position++;
+
+    //Every access of the trace is counted so the rates can be taken over the exact totals
+    if(read_write == CACHE_WRITE) {
+        sampler->seen_writes++;
+    } else {
+        sampler->seen_reads++;
+    }
+
+    if(sampler->config.mode == SAMPLE_SETS) {
+        //Only accesses which map to a sampled set are simulated at all
+        struct address_info info = info_from_address(addr, sampler->total_sets, sampler->cache_block_size);
+        if(info.set % sampler->config.set_ratio != 0) {
+            return SAMPLE_SKIP;
+        }
+
+        sampler->current_unit = info.set / sampler->config.set_ratio;
+        return SAMPLE_MEASURE;
+    } else if(sampler->config.mode == SAMPLE_TIME) {
+        //The measured window sits at the end of each period with the warmup right before it
+        long offset = position % sampler->config.period;
+        long window_start = sampler->config.period - sampler->config.window;
+
+        if(offset >= window_start) {
+            sampler->current_unit = position / sampler->config.period;
+            if(reserve_units(sampler, sampler->current_unit)) {
+                return SAMPLE_WARM;
+            }
+            if(sampler->current_unit >= sampler->total_units) {
+                sampler->total_units = sampler->current_unit + 1;
+            }
+            return SAMPLE_MEASURE;
+        }
+        if(sampler->config.warmup < 0 || offset >= window_start - sampler->config.warmup) {
+            return SAMPLE_WARM;
+        }
+
+        return SAMPLE_SKIP;
+    }
+
+    return SAMPLE_MEASURE;
+}
+
+//Function to attribute the stats produced by one measured access to the current unit
+void sampler_record(struct sampler* sampler, struct cache_stats before, struct cache_stats after) {
+    struct sample_unit* unit = &sampler->units[sampler->current_unit];
+
+    unit->reads += after.total_reads - before.total_reads;
+    unit->writes += after.total_writes - before.total_writes;
+    unit->read_misses += after.read_misses - before.read_misses;
+    unit->write_misses += after.write_misses - before.write_misses;
+    unit->evictions += after.total_evictions - before.total_evictions;
+    unit->dirty_evictions += after.dirty_evictions - before.dirty_evictions;
+}
+
+//Function to estimate the miss rate over the whole trace and the half width of its 95% confidence interval.
+//The total number of misses is expanded from the sampled units and divided by the exactly known number of
+//accesses of that kind. Kind 0 is all accesses, 1 is reads, and 2 is writes
+static void rate_estimate(struct sampler* sampler, double population_units, int kind,
+                          double* rate, double* half_width) {
+    long sampled_units = sampler->total_units;
+    double accesses = kind == 1 ? sampler->seen_reads : kind == 2 ? sampler->seen_writes
+                                : sampler->seen_reads + sampler->seen_writes;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+
+    for(long i = 0; i < sampled_units; i++) {
+        struct sample_unit unit = sampler->units[i];
+        double misses = kind == 1 ? unit.read_misses : kind == 2 ? unit.write_misses : unit.read_misses + unit.write_misses;
+        sum += misses;
+        sum_squares += misses * misses;
+    }
+
+    *rate = 0.0;
+    *half_width = 0.0;
+    if(accesses == 0.0 || sampled_units == 0) {
+        return;
+    }
+
+    double n = (double) sampled_units;
+    *rate = population_units * (sum / n) / accesses;
+    if(sampled_units < 2) {
+        return;
+    }
+
+    //Sample variance of the per unit misses
+    double variance = (sum_squares - sum * sum / n) / (n - 1.0);
+    //Finite population correction, sampling every unit leaves no error
+    double correction = population_units > n ? 1.0 - n / population_units : 0.0;
+
+    *half_width = SAMPLE_Z_95 * population_units * sqrt(correction * variance / n) / accesses;
+}
+
+//Function to print the sampled estimates and their confidence intervals
+void print_sample_report(FILE* out, struct sampler* sampler) {
+    long sampled_units = sampler->total_units;
+    double population_units;
+    struct sample_unit totals;
+    memset(&totals, 0, sizeof(struct sample_unit));
+
+    for(long i = 0; i < sampled_units; i++) {
+        totals.reads += sampler->units[i].reads;
+        totals.writes += sampler->units[i].writes;
+        totals.read_misses += sampler->units[i].read_misses;
+        totals.write_misses += sampler->units[i].write_misses;
+        totals.evictions += sampler->units[i].evictions;
+        totals.dirty_evictions += sampler->units[i].dirty_evictions;
+    }
+    long measured = totals.reads + totals.writes;
+
+    fprintf(out, "SAMPLING ESTIMATES:\n");
+    if(sampler->config.mode == SAMPLE_SETS) {
+        //Every set is a unit
+        population_units = (double) sampler->total_sets;
+        fprintf(out, "Mode: set sampling (%ld of %d sets)\n", sampled_units, sampler->total_sets);
+    } else {
+        //Every window sized slice of the trace is a unit
+        population_units = (double) sampler->position / (double) sampler->config.window;
+        char warmup[32] = "all";
+        if(sampler->config.warmup >= 0) {
+            snprintf(warmup, sizeof(warmup), "%ld", sampler->config.warmup);
+        }
+        fprintf(out, "Mode: time sampling (%ld of every %ld accesses, warmup %s)\n", sampler->config.window,
+                sampler->config.period, warmup);
+    }
+    double scale = sampled_units == 0 ? 0.0 : population_units / (double) sampled_units;
+    fprintf(out, "Measured accesses: %ld of %ld, scale %.6f\n", measured, sampler->position, scale);
+
+    double rate, read_rate, write_rate;
+    double half, read_half, write_half;
+    rate_estimate(sampler, population_units, 0, &rate, &half);
+    rate_estimate(sampler, population_units, 1, &read_rate, &read_half);
+    rate_estimate(sampler, population_units, 2, &write_rate, &write_half);
+
+    fprintf(out, "Estimated misses:\n");
+    fprintf(out, "Total: %ld DataReads: %ld DataWrites: %ld\n",
+            lround((double) (totals.read_misses + totals.write_misses) * scale),
+            lround((double) totals.read_misses * scale), lround((double) totals.write_misses * scale));
+    fprintf(out, "Estimated miss rate (95%% confidence interval):\n");
+    fprintf(out, "Total: %.6f +/- %.6f DataReads: %.6f +/- %.6f DataWrites: %.6f +/- %.6f\n",
+            rate, half, read_rate, read_half, write_rate, write_half);
+    fprintf(out, "Estimated Number of Dirty Blocks Evicted from the Cache: %ld\n\n",
+            lround((double) totals.dirty_evictions * scale));
+}
@@ -0,0 +1,223 @@
+#include "../headers/server.h"
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+//
+// Long-running simulator server that keeps cache and main memory resident behind a Unix domain socket
+//
+
+#ifndef _WIN32
+//Defining the result of a simulation command sent before any CONFIG
+#define SERVER_NO_CONFIG -2
+
+//Function to simulate every record of a reader, returns the number of records or -1 if one is malformed
+static long simulate_reader(struct sim_session* session, struct trace_reader* reader) {
+    struct trace_record record;
+    long count = 0;
+    int result;
+
+    while((result = read_trace_record(reader, &record)) > 0) {
+        simulate_record(&session->cache_mem, &session->stats, session->main_mem, record);
+        count++;
+    }
+
+    return result < 0 ? -1 : count;
+}
+
+//Function to simulate the trace lines sent after a RECORDS command, returns the number of records, -1 if
+//one is malformed, or SERVER_NO_CONFIG. The remaining lines up to the end marker are still read so the
+//connection stays usable
+static long simulate_records(struct sim_session* session, FILE* in, char** line, size_t* len) {
+    long count = 0;
+    long read;
+    bool failure = 0;
+    bool configured = session->cache_mem.lines != NULL;
+
+    while((read = getline(line, len, in)) != -1) {
+        if(strncmp(*line, SERVER_RECORDS_END, strlen(SERVER_RECORDS_END)) == 0) {
+            if(!configured) {
+                return SERVER_NO_CONFIG;
+            }
+            return failure ? -1 : count;
+        }
+        if(failure || !configured) {
+            continue;
+        }
+
+        struct trace_record record;
+        if(parse_trace_line(*line, read, (int) count + 1, &record)) {
+            failure = 1;
+            continue;
+        }
+        simulate_record(&session->cache_mem, &session->stats, session->main_mem, record);
+        count++;
+    }
+
+    //The client hung up in the middle of the records
+    return -1;
+}
+
+//Function to answer a single command, returns 1 when the connection should be closed and 2 when the
+//server should stop
+static int handle_command(struct sim_session* session, char* command, FILE* in, FILE* out,
+                          char** line, size_t* len) {
+    //Strip the line ending
+    command[strcspn(command, "\r\n")] = '\0';
+
+    if(strncmp(command, "CONFIG ", 7) == 0) {
+        struct session_config config = zero_session_config();
+        if(sscanf(command + 7, "%d %d %d", &config.capacity, &config.block_size, &config.associativity) != 3
+                || configure_sim_session(session, config)) {
+            fprintf(out, "ERR invalid cache config\n");
+        } else {
+            fprintf(out, "OK sets %d lines %d\n", session->cache_mem.total_sets, session->cache_mem.total_lines);
+        }
+    } else if(strcmp(command, "RESET") == 0) {
+        reset_sim_session(session);
+        fprintf(out, "OK\n");
+    } else if(strncmp(command, "TRACE ", 6) == 0 || strcmp(command, "RECORDS") == 0) {
+        long count;
+        struct trace_reader reader;
+        if(command[0] == 'R') {
+            count = simulate_records(session, in, line, len);
+        } else if(!session->cache_mem.lines) {
+            count = SERVER_NO_CONFIG;
+        } else if(open_trace_reader(&reader, command + 6) != 0) {
+            fprintf(out, "ERR trace could not be opened\n");
+            return 0;
+        } else {
+            count = simulate_reader(session, &reader);
+            close_trace_reader(&reader);
+        }
+
+        if(count == SERVER_NO_CONFIG) {
+            fprintf(out, "ERR no cache config, send CONFIG first\n");
+        } else if(count < 0) {
+            fprintf(out, "ERR malformed trace record\n");
+        } else {
+            fprintf(out, "OK %ld\n", count);
+        }
+    } else if(strcmp(command, "FLUSH") == 0) {
+        flush_sim_session(session);
+        fprintf(out, "OK\n");
+    } else if(strcmp(command, "STATS") == 0) {
+        struct cache_stats stats = sim_session_stats(session);
+        fprintf(out, "OK accesses %ld reads %ld writes %ld misses %ld read_misses %ld write_misses %ld "
+                     "evictions %ld dirty_evictions %ld loads %ld\n", stats.total_actions, stats.total_reads,
+                stats.total_writes, stats.total_misses, stats.read_misses, stats.write_misses,
+                stats.total_evictions, stats.dirty_evictions, stats.total_loads);
+    } else if(strcmp(command, "QUIT") == 0) {
+        fprintf(out, "OK\n");
+        return 1;
+    } else if(strcmp(command, "SHUTDOWN") == 0) {
+        fprintf(out, "OK\n");
+        return 2;
+    } else {
+        fprintf(out, "ERR unknown command\n");
+    }
+
+    return 0;
+}
+
+//Function to serve one client connection until it hangs up, returns 2 if the server should stop
+static int serve_client(struct sim_session* session, int client) {
+    FILE* in = fdopen(client, "r");
+    FILE* out = fdopen(dup(client), "w");
+    if(!in || !out) {
+        printf("Error: Could not open the client connection\n");
+        if(in) {
+            fclose(in);
+        } else {
+            close(client);
+        }
+        if(out) {
+            fclose(out);
+        }
+        return 0;
+    }
+
+    char* command = NULL;
+    size_t command_len = 0;
+    char* line = NULL;
+    size_t line_len = 0;
+    int result = 0;
+
+    while(result == 0 && getline(&command, &command_len, in) != -1) {
+        result = handle_command(session, command, in, out, &line, &line_len);
+        //Answer right away, the client waits for every reply
+        fflush(out);
+    }
+
+    free(command);
+    free(line);
+    fclose(in);
+    fclose(out);
+    return result;
+}
+
+//Function to run the server until a client sends SHUTDOWN, clients are served one after the other
+int run_server(char* socket_path) {
+    struct sockaddr_un address;
+    if(strlen(socket_path) >= sizeof(address.sun_path)) {
+        printf("Error: Socket path is too long\n");
+        return 1;
+    }
+    //Only a socket file left behind by an earlier server is replaced, any other file at the path is kept
+    struct stat existing;
+    if(lstat(socket_path, &existing) == 0 && !S_ISSOCK(existing.st_mode)) {
+        printf("Error: %s already exists and is not a socket\n", socket_path);
+        return 1;
+    }
+
+    struct sim_session session;
+    if(init_sim_session(&session)) {
+        return 1;
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&address, 0, sizeof(struct sockaddr_un));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    //A socket file left behind by an earlier server would make bind fail, the path holds no other file
+    unlink(socket_path);
+    if(server < 0 || bind(server, (struct sockaddr*) &address, sizeof(struct sockaddr_un)) != 0
+            || listen(server, 16) != 0) {
+        printf("Error: Could not listen on %s\n", socket_path);
+        if(server >= 0) {
+            close(server);
+        }
+        free_sim_session(&session);
+        return 1;
+    }
+
+    //A client hanging up before reading its reply must not stop the server
+    signal(SIGPIPE, SIG_IGN);
+    printf("Listening on %s\n", socket_path);
+    fflush(stdout);
+
+    int result = 0;
+    while(result != 2) {
+        int client = accept(server, NULL, NULL);
+        if(client < 0) {
+            continue;
+        }
+        result = serve_client(&session, client);
+    }
+
+    close(server);
+    unlink(socket_path);
+    free_sim_session(&session);
+    return 0;
+}
+#else
+//Function to report that the server is not available, Windows builds have no Unix domain sockets
+int run_server(char* socket_path) {
+    printf("Error: Server mode is not available on Windows\n");
+    return 1;
+}
+#endif
@@ -0,0 +1,140 @@
+#include "../headers/session.h"
+//
+// Embeddable simulator sessions: a cache and its main memory driven with batches of records, without any
+// file I/O or global state so that one process can run several sessions side by side
+//
+
+//Function to get the default session config, which has no cache yet
+struct session_config zero_session_config() {
+    struct session_config primer;
+
+    primer.capacity = 0;
+    primer.block_size = 0;
+    primer.associativity = 0;
+    primer.index_function = INDEX_MODULO;
+    primer.sector_size = 0;
+
+    return primer;
+}
+
+//Function for initializing a session, main memory is allocated once and lives as long as the session
+int init_sim_session(struct sim_session* session) {
+    session->cache_mem = zero_cache();
+    session->stats = zero_stats();
+    session->main_mem = init_main_mem();
+    if(init_mem_tracker(&session->tracker)) {
+        free_io(session->cache_mem, session->main_mem);
+        return 1;
+    }
+
+    return 0;
+}
+
+//Function to free the memory allocated to a session
+void free_sim_session(struct sim_session* session) {
+    free_io(session->cache_mem, session->main_mem);
+    free_mem_tracker(&session->tracker);
+    session->cache_mem = zero_cache();
+    session->main_mem = NULL;
+}
+
+//Function to allocate and initialize a session, returns NULL if it cannot be allocated
+struct sim_session* create_sim_session() {
+    struct sim_session* session = malloc(sizeof(struct sim_session));
+    if(!session) {
+        printf("Error: Could not allocate memory for the session\n");
+        return NULL;
+    }
+    if(init_sim_session(session)) {
+        free(session);
+        return NULL;
+    }
+    return session;
+}
+
+//Function to free a session allocated by create_sim_session
+void destroy_sim_session(struct sim_session* session) {
+    if(session) {
+        free_sim_session(session);
+        free(session);
+    }
+}
+
+//Function to validate a cache config the same way the command line does, returns non-zero if it is invalid
+int check_session_config(struct session_config config) {
+    if(config.capacity < 4 || config.capacity > 64 || (config.capacity & (config.capacity - 1)) != 0) {
+        return 1;
+    }
+    if(config.block_size < 4 || config.block_size > 512 || (config.block_size & (config.block_size - 1)) != 0) {
+        return 1;
+    }
+    if(config.associativity < 1 || config.associativity > 16
+            || (config.associativity & (config.associativity - 1)) != 0) {
+        return 1;
+    }
+    if(config.index_function < INDEX_MODULO || config.index_function > INDEX_SKEW) {
+        return 1;
+    }
+    if(config.sector_size != 0 && (config.sector_size < WORD_SIZE || config.sector_size > config.block_size
+            || (config.sector_size & (config.sector_size - 1)) != 0
+            || config.block_size / config.sector_size > MAX_SECTORS)) {
+        return 1;
+    }
+    return 0;
+}
+
+//Function to replace the cache of a session with a new one, which also resets the session
+int configure_sim_session(struct sim_session* session, struct session_config config) {
+    if(check_session_config(config)) {
+        return 1;
+    }
+
+    //Only the cache lines are rebuilt, main memory stays allocated
+    free_cache_mem(session->cache_mem);
+
+    struct cache cache_mem = zero_cache();
+    cache_mem.size = config.capacity * 1024;
+    cache_mem.line_size = config.block_size;
+    cache_mem.associativity = config.associativity;
+    cache_mem.total_lines = cache_mem.size / cache_mem.line_size;
+    cache_mem.words_per_line = cache_mem.line_size / WORD_SIZE;
+    cache_mem.index_function = config.index_function;
+    cache_mem.words_per_sector = config.sector_size / WORD_SIZE;
+    session->cache_mem = init_cache_mem(cache_mem);
+    session->cache_mem.tracker = &session->tracker;
+
+    reset_sim_session(session);
+    return 0;
+}
+
+//Function to bring a session back to the state of a fresh run without reallocating anything
+void reset_sim_session(struct sim_session* session) {
+    if(session->cache_mem.lines) {
+        reset_cache_mem(&session->cache_mem);
+    }
+    reset_main_mem(session->main_mem, &session->tracker);
+    session->stats = zero_stats();
+}
+
+//Function to write the cache contents of a session back to its main memory, keeping them in the cache
+void flush_sim_session(struct sim_session* session) {
+    if(session->cache_mem.lines) {
+        write_cache_to_memory(&session->cache_mem, session->main_mem);
+    }
+}
+
+//Function to simulate a batch of records, returns the number of records simulated or -1 if the session has
+//no cache config yet
+long simulate_batch(struct sim_session* session, struct trace_record* records, long count) {
+    if(!session->cache_mem.lines) {
+        return -1;
+    }
+
+    simulate_trace_records(&session->cache_mem, &session->stats, session->main_mem, records, count);
+    return count;
+}
+
+//Function to get a snapshot of the statistics of a session since its last reset
+struct cache_stats sim_session_stats(struct sim_session* session) {
+    return session->stats;
+}
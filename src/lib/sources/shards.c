@@ -0,0 +1,186 @@
+#include "../headers/shards.h"
+//
+// Single pass miss ratio curve estimation using SHARDS spatial sampling
+//
+
+//Function for setting the values of a SHARDS config to the disabled state
+struct shards_config zero_shards_config() {
+    struct shards_config primer;
+
+    primer.enabled = 0;
+    primer.rate = 0.01;
+    primer.max_samples = 8192;
+    primer.max_capacity = 1024;
+
+    return primer;
+}
+
+//Function to hash a block address into the SHARDS sampling space
+static unsigned int shards_hash(INT_TYPE block) {
+    unsigned long long x = (unsigned long long) block;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return (unsigned int) (x & (SHARDS_MODULUS - 1));
+}
+
+//Function for initializing a SHARDS run for the block size of the cache
+int init_shards(struct shards* shards, struct shards_config config, struct cache cache_mem) {
+    memset(shards, 0, sizeof(struct shards));
+    shards->config = config;
+    shards->line_size = cache_mem.line_size;
+    shards->word_shift = (int) log2(cache_mem.words_per_line);
+
+    if(config.rate <= 0.0 || config.rate > 1.0) {
+        printf("Error: SHARDS sampling rate must be greater than 0 and at most 1\n");
+        return 1;
+    }
+    if(config.max_capacity * 1024 < cache_mem.line_size) {
+        printf("Error: Miss ratio curve capacity must hold at least one cache line\n");
+        return 1;
+    }
+    shards->threshold = (unsigned int) (config.rate * SHARDS_MODULUS);
+    if(shards->threshold == 0) {
+        shards->threshold = 1;
+    }
+
+    //Spread the largest reported capacity over the histogram bins
+    long max_lines = (long) config.max_capacity * 1024 / cache_mem.line_size;
+    shards->bin_lines = max_lines / SHARDS_BINS;
+    if(shards->bin_lines < 1) {
+        shards->bin_lines = 1;
+    }
+
+    shards->histogram = calloc(SHARDS_BINS, sizeof(double));
+    shards->heap = calloc(config.max_samples + 1, sizeof(struct shards_sample));
+    if(!shards->histogram || !shards->heap || init_lru_stack(&shards->stack, config.max_samples + 1)) {
+        printf("Error: Could not allocate memory for the miss ratio curve\n");
+        free_shards(shards);
+        return 1;
+    }
+
+    return 0;
+}
+
+//Function to free the memory allocated to a SHARDS run
+void free_shards(struct shards* shards) {
+    free(shards->histogram);
+    free(shards->heap);
+    free_lru_stack(&shards->stack);
+    shards->histogram = NULL;
+    shards->heap = NULL;
+}
+
+//Function to add a sampled block to the max heap
+static void shards_heap_push(struct shards* shards, unsigned int hash, INT_TYPE block) {
+    long i = shards->heap_size++;
+    while(i > 0 && shards->heap[(i - 1) / 2].hash < hash) {
+        shards->heap[i] = shards->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    shards->heap[i].hash = hash;
+    shards->heap[i].block = block;
+}
+
+//Function to take the sampled block with the largest hash off the max heap
+static struct shards_sample shards_heap_pop(struct shards* shards) {
+    struct shards_sample top = shards->heap[0];
+    struct shards_sample last = shards->heap[--shards->heap_size];
+
+    long i = 0;
+    while(i * 2 + 1 < shards->heap_size) {
+        long child = i * 2 + 1;
+        if(child + 1 < shards->heap_size && shards->heap[child + 1].hash > shards->heap[child].hash) {
+            child++;
+        }
+        if(shards->heap[child].hash <= last.hash) {
+            break;
+        }
+        shards->heap[i] = shards->heap[child];
+        i = child;
+    }
+    shards->heap[i] = last;
+
+    return top;
+}
+
+//Function to register an access with the SHARDS run
+void shards_access(struct shards* shards, INT_TYPE addr) {
+    INT_TYPE block = addr >> shards->word_shift;
+    shards->total_accesses++;
+
+    //Most accesses stop here, only blocks whose hash falls under the threshold are tracked
+    unsigned int hash = shards_hash(block);
+    if(hash >= shards->threshold) {
+        return;
+    }
+
+    double weight = (double) SHARDS_MODULUS / (double) shards->threshold;
+    long distance = lru_stack_access(&shards->stack, block);
+
+    if(distance == LRU_STACK_COLD) {
+        shards->cold += weight;
+        shards_heap_push(shards, hash, block);
+
+        //Keep the number of tracked blocks constant by lowering the threshold below the largest hash
+        if(shards->heap_size > shards->config.max_samples) {
+            unsigned int new_threshold = shards->heap[0].hash;
+            while(shards->heap_size > 0 && shards->heap[0].hash >= new_threshold) {
+                struct shards_sample evicted = shards_heap_pop(shards);
+                lru_stack_remove(&shards->stack, evicted.block);
+            }
+            shards->threshold = new_threshold;
+        }
+        return;
+    }
+
+    //Scale the distance between sampled blocks back up to a distance in cache lines
+    long bin = (long) ((double) distance * weight) / shards->bin_lines;
+    if(bin < SHARDS_BINS) {
+        shards->histogram[bin] += weight;
+    } else {
+        shards->overflow += weight;
+    }
+}
+
+//Function to estimate the miss rate of a fully associative LRU cache holding capacity_lines lines
+double shards_miss_rate(struct shards* shards, long capacity_lines) {
+    if(shards->total_accesses == 0) {
+        return 0.0;
+    }
+
+    double misses = shards->cold + shards->overflow;
+    for(long bin = capacity_lines / shards->bin_lines; bin < SHARDS_BINS; bin++) {
+        misses += shards->histogram[bin];
+    }
+
+    //The misses are scaled up from the sampled blocks, while every access is counted exactly. Dividing by
+    //that exact count is what crediting the missing weight to the smallest distance would give, since the
+    //smallest distance is a hit at every capacity
+    double rate = misses / (double) shards->total_accesses;
+
+    if(rate > 1.0) {
+        rate = 1.0;
+    }
+    return rate;
+}
+
+//Function to print the estimated miss ratio curve
+void print_shards_report(FILE* out, struct shards* shards, int cache_size) {
+    fprintf(out, "MISS RATIO CURVE:\n");
+    fprintf(out, "Fully associative LRU, block size %d, SHARDS rate %.6f, tracked blocks %ld\n",
+            shards->line_size, (double) shards->threshold / (double) SHARDS_MODULUS, shards->stack.live);
+    fprintf(out, "%-13s %-10s %s\n", "Capacity(KB)", "Lines", "MissRate");
+
+    for(long capacity = 1; capacity <= shards->config.max_capacity; capacity *= 2) {
+        long lines = capacity * 1024 / shards->line_size;
+        if(lines < 1) {
+            continue;
+        }
+        fprintf(out, "%-13ld %-10ld %.6f%s\n", capacity, lines, shards_miss_rate(shards, lines),
+                capacity * 1024 == cache_size ? "  <- configured" : "");
+    }
+    fprintf(out, "\n");
+}
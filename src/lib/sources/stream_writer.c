@@ -0,0 +1,131 @@
+#include "../headers/stream_writer.h"
+//
+// Double buffered output stream which hands full buffers to a background writer thread
+//
+
+//Function run by the writer thread, writes every handed off buffer until the stream is closed
+static void* stream_writer_thread(void* arg) {
+    struct stream_writer* writer = arg;
+
+    pthread_mutex_lock(&writer->lock);
+    while(1) {
+        while(!writer->pending && !writer->closing) {
+            pthread_cond_wait(&writer->cond, &writer->lock);
+        }
+        if(!writer->pending) {
+            break;
+        }
+
+        //The buffer not being filled is the one to write, do the I/O without holding the lock
+        char* buffer = writer->buffers[1 - writer->active];
+        size_t size = writer->pending_size;
+        pthread_mutex_unlock(&writer->lock);
+        bool failed = fwrite(buffer, 1, size, writer->file) != size;
+        pthread_mutex_lock(&writer->lock);
+
+        writer->failed = writer->failed || failed;
+        writer->pending = 0;
+        pthread_cond_broadcast(&writer->cond);
+    }
+    pthread_mutex_unlock(&writer->lock);
+
+    return NULL;
+}
+
+//Function to open a file for double buffered writing
+int open_stream_writer(struct stream_writer* writer, char* path, size_t buffer_size) {
+    memset(writer, 0, sizeof(struct stream_writer));
+
+    writer->file = fopen(path, "wb");
+    if(!writer->file) {
+        printf("Error: Stream output file could not be created / opened!\n");
+        return 1;
+    }
+
+    writer->buffer_size = buffer_size;
+    writer->buffers[0] = malloc(buffer_size);
+    writer->buffers[1] = malloc(buffer_size);
+    if(!writer->buffers[0] || !writer->buffers[1]) {
+        printf("Error: Could not allocate memory for the stream output buffers\n");
+        free(writer->buffers[0]);
+        free(writer->buffers[1]);
+        fclose(writer->file);
+        return 1;
+    }
+
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+    if(pthread_create(&writer->thread, NULL, stream_writer_thread, writer) != 0) {
+        printf("Error: Could not start the stream writer thread\n");
+        pthread_mutex_destroy(&writer->lock);
+        pthread_cond_destroy(&writer->cond);
+        free(writer->buffers[0]);
+        free(writer->buffers[1]);
+        fclose(writer->file);
+        return 1;
+    }
+
+    return 0;
+}
+
+//Function to hand the active buffer to the writer thread and switch to the other one
+static void stream_writer_handoff(struct stream_writer* writer) {
+    pthread_mutex_lock(&writer->lock);
+    //Only wait if the writer thread is still busy with the previous buffer
+    while(writer->pending) {
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    }
+    writer->pending_size = writer->used;
+    writer->active = 1 - writer->active;
+    writer->used = 0;
+    writer->pending = 1;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+//Function to append data to the stream
+void stream_write(struct stream_writer* writer, const void* data, size_t size) {
+    const char* bytes = data;
+
+    while(size > 0) {
+        size_t space = writer->buffer_size - writer->used;
+        size_t chunk = size < space ? size : space;
+
+        memcpy(writer->buffers[writer->active] + writer->used, bytes, chunk);
+        writer->used += chunk;
+        bytes += chunk;
+        size -= chunk;
+
+        if(writer->used == writer->buffer_size) {
+            stream_writer_handoff(writer);
+        }
+    }
+}
+
+//Function to flush the remaining data, stop the writer thread, and close the file
+int close_stream_writer(struct stream_writer* writer) {
+    if(writer->used > 0) {
+        stream_writer_handoff(writer);
+    }
+
+    pthread_mutex_lock(&writer->lock);
+    writer->closing = 1;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->cond);
+    free(writer->buffers[0]);
+    free(writer->buffers[1]);
+    //The file is closed even after a failed write, so that it is never left open
+    bool failed = fclose(writer->file) != 0;
+    failed |= writer->failed;
+    writer->file = NULL;
+
+    if(failed) {
+        printf("Error: Could not write the stream output file!\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,275 @@
+#include "../headers/tlb.h"
+//
+// Virtual to physical address translation with a multi-level TLB and page walks through the cache
+//
+
+//Function for initializing a TLB level, the number of sets must be a power of two
+static int init_tlb_level(struct tlb_level* level, int entries, int ways) {
+    memset(level, 0, sizeof(struct tlb_level));
+    if(ways <= 0 || entries < ways || entries % ways != 0 || ((entries / ways) & (entries / ways - 1)) != 0) {
+        printf("Error: A TLB level needs a power of two number of sets, got %d entries of %d ways\n", entries, ways);
+        return 1;
+    }
+    level->entries = entries;
+    level->ways = ways;
+    level->total_sets = entries / ways;
+
+    level->tags = calloc(entries, sizeof(unsigned long long));
+    level->frames = calloc(entries, sizeof(long));
+    level->last_use = calloc(entries, sizeof(unsigned long long));
+    if(!level->tags || !level->frames || !level->last_use) {
+        printf("Error: Could not allocate memory for the TLB\n");
+        return 1;
+    }
+    return 0;
+}
+
+//Function for initializing the translation stage of a cache. Virtual addresses span the same range as
+//main memory, and the page table nodes of that range are kept in the top frames of main memory
+int init_translation(struct translation* translation, struct cache cache_mem, int page_size, int alloc,
+                     int* entries, int* ways, int total_levels) {
+    memset(translation, 0, sizeof(struct translation));
+    translation->page_size = page_size;
+    translation->page_shift = (int) log2(page_size / WORD_SIZE);
+    translation->walk_levels = page_size == PAGE_SIZE_HUGE ? WALK_LEVELS_HUGE : WALK_LEVELS_SMALL;
+    translation->alloc = alloc;
+    translation->total_levels = total_levels;
+    translation->walk_stats = zero_stats();
+    translation->total_pages = MM_SIZE / page_size;
+
+    for(int i = 0; i < total_levels; i++) {
+        if(init_tlb_level(&translation->levels[i], entries[i], ways[i])) {
+            free_translation(translation);
+            return 1;
+        }
+    }
+
+    //Every walk level has a node for each run of virtual pages its entries cover
+    for(int i = 0; i < translation->walk_levels; i++) {
+        int shift = 9 * (translation->walk_levels - i);
+        long nodes = ((translation->total_pages - 1) >> shift) + 1;
+        translation->node_frames[i] = malloc(nodes * sizeof(long));
+        if(!translation->node_frames[i]) {
+            printf("Error: Could not allocate memory for the page table\n");
+            free_translation(translation);
+            return 1;
+        }
+        memset(translation->node_frames[i], 0xff, nodes * sizeof(long));
+        translation->total_nodes += nodes;
+    }
+
+    //The page table takes whole pages at the top of main memory, the data frames are the pages below it
+    long table_bytes = translation->total_nodes * PAGE_SIZE_SMALL;
+    long table_pages = (table_bytes + page_size - 1) / page_size;
+    translation->total_frames = translation->total_pages - table_pages;
+    translation->node_base = (INT_TYPE) (translation->total_frames * (page_size / WORD_SIZE));
+
+    translation->page_frames = malloc(translation->total_pages * sizeof(long));
+    translation->free_frames = malloc(translation->total_frames * sizeof(long));
+    translation->total_sets = cache_mem.total_sets;
+    translation->virtual_sets = calloc(cache_mem.total_sets, sizeof(long));
+    translation->physical_sets = calloc(cache_mem.total_sets, sizeof(long));
+    if(!translation->page_frames || !translation->free_frames || !translation->virtual_sets
+            || !translation->physical_sets) {
+        printf("Error: Could not allocate memory for the page table\n");
+        free_translation(translation);
+        return 1;
+    }
+    memset(translation->page_frames, 0xff, translation->total_pages * sizeof(long));
+
+    //Hand the frames out in address order, or shuffled like the free list of a long running system
+    for(long i = 0; i < translation->total_frames; i++) {
+        translation->free_frames[i] = i;
+    }
+    if(alloc == PAGE_ALLOC_RANDOM) {
+        unsigned long long state = PAGE_ALLOC_SEED;
+        for(long i = translation->total_frames - 1; i > 0; i--) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            long j = (long) (state % (unsigned long long) (i + 1));
+            long frame = translation->free_frames[i];
+            translation->free_frames[i] = translation->free_frames[j];
+            translation->free_frames[j] = frame;
+        }
+    }
+
+    return 0;
+}
+
+//Function to free the memory allocated to the translation stage
+void free_translation(struct translation* translation) {
+    for(int i = 0; i < TLB_MAX_LEVELS; i++) {
+        free(translation->levels[i].tags);
+        free(translation->levels[i].frames);
+        free(translation->levels[i].last_use);
+        translation->levels[i].tags = NULL;
+        translation->levels[i].frames = NULL;
+        translation->levels[i].last_use = NULL;
+    }
+    for(int i = 0; i < WALK_LEVELS_SMALL; i++) {
+        free(translation->node_frames[i]);
+        translation->node_frames[i] = NULL;
+    }
+    free(translation->page_frames);
+    free(translation->free_frames);
+    free(translation->virtual_sets);
+    free(translation->physical_sets);
+    translation->page_frames = NULL;
+    translation->free_frames = NULL;
+    translation->virtual_sets = NULL;
+    translation->physical_sets = NULL;
+}
+
+//Function to look a virtual page up in a TLB level, returns the frame or -1 on a miss
+static long tlb_lookup(struct tlb_level* level, unsigned long long vpn, unsigned long long clock) {
+    int first = (int) (vpn & (unsigned long long) (level->total_sets - 1)) * level->ways;
+    for(int i = first; i < first + level->ways; i++) {
+        if(level->tags[i] == vpn + 1) {
+            level->last_use[i] = clock;
+            level->hits++;
+            return level->frames[i];
+        }
+    }
+    level->misses++;
+    return -1;
+}
+
+//Function to insert a translation into a TLB level, replacing an empty or else the least recently used entry
+static void tlb_fill(struct tlb_level* level, unsigned long long vpn, long frame, unsigned long long clock) {
+    int first = (int) (vpn & (unsigned long long) (level->total_sets - 1)) * level->ways;
+    int victim = first;
+    for(int i = first; i < first + level->ways; i++) {
+        if(level->tags[i] == 0) {
+            victim = i;
+            break;
+        }
+        if(level->last_use[i] < level->last_use[victim]) {
+            victim = i;
+        }
+    }
+    level->tags[victim] = vpn + 1;
+    level->frames[victim] = frame;
+    level->last_use[victim] = clock;
+}
+
+//Function to walk the page table of a virtual page, reading the entry of every level through the cache, and
+//map the page to the next free frame on its first touch. Returns the frame or -1 if no frame is left
+static long walk_page_table(struct translation* translation, struct cache* cache_mem, struct main_mem_block* main_mem,
+                            unsigned long long vpn) {
+    translation->walks++;
+    for(int i = 0; i < translation->walk_levels; i++) {
+        //Nodes take the page table frames in the order walks first reach them
+        int shift = 9 * (translation->walk_levels - 1 - i);
+        long node = (long) (vpn >> (shift + 9));
+        if(translation->node_frames[i][node] < 0) {
+            translation->node_frames[i][node] = translation->next_node++;
+        }
+
+        INT_TYPE entry = (INT_TYPE) ((vpn >> shift) & (PTES_PER_NODE - 1));
+        INT_TYPE pte = translation->node_base + (INT_TYPE) translation->node_frames[i][node]
+                       * (PAGE_SIZE_SMALL / WORD_SIZE) + entry * (PTE_SIZE / WORD_SIZE);
+        read_from_cache(cache_mem, &translation->walk_stats, main_mem, pte);
+    }
+
+    if(translation->page_frames[vpn] < 0) {
+        if(translation->next_frame == translation->total_frames) {
+            return -1;
+        }
+        translation->page_frames[vpn] = translation->free_frames[translation->next_frame++];
+    }
+    return translation->page_frames[vpn];
+}
+
+//Function to translate a virtual word address into a physical one. The TLB levels are searched in order and
+//a hit fills the levels above it, a miss in every level walks the page table and fills them all. Returns
+//non-zero after printing the reason if the address cannot be mapped
+int translate_address(struct cache* cache_mem, struct main_mem_block* main_mem, INT_TYPE addr, INT_TYPE* result) {
+    struct translation* translation = cache_mem->translation;
+    unsigned long long vpn = (unsigned long long) addr >> translation->page_shift;
+    if(vpn >= (unsigned long long) translation->total_pages) {
+        printf("Error: Virtual address %x is outside the address space\n", (unsigned int) addr);
+        return 1;
+    }
+
+    translation->translations++;
+    translation->clock++;
+    long frame = -1;
+    int level = 0;
+    for(; level < translation->total_levels && frame < 0; level++) {
+        frame = tlb_lookup(&translation->levels[level], vpn, translation->clock);
+    }
+    if(frame < 0) {
+        frame = walk_page_table(translation, cache_mem, main_mem, vpn);
+        if(frame < 0) {
+            printf("Error: Translation ran out of physical frames after %ld pages\n", translation->total_frames);
+            return 1;
+        }
+    } else {
+        level--;
+    }
+    for(int i = 0; i < level; i++) {
+        tlb_fill(&translation->levels[i], vpn, frame, translation->clock);
+    }
+
+    *result = (INT_TYPE) (((unsigned long long) frame << translation->page_shift)
+                          | (addr & ((1ULL << translation->page_shift) - 1)));
+
+    //Count which set the access lands in with and without translation
+    INT_TYPE virtual_set = cache_info_from_address(*cache_mem, addr).set;
+    INT_TYPE physical_set = cache_info_from_address(*cache_mem, *result).set;
+    translation->virtual_sets[virtual_set]++;
+    translation->physical_sets[physical_set]++;
+    if(virtual_set != physical_set) {
+        translation->moved++;
+    }
+    return 0;
+}
+
+//Function to print the number of sets used and the coefficient of variation of the accesses per set
+static void print_set_spread(FILE* out, char* title, long* counts, int total_sets) {
+    int used = 0;
+    double sum = 0;
+    for(int i = 0; i < total_sets; i++) {
+        used += counts[i] > 0;
+        sum += (double) counts[i];
+    }
+    double mean = sum / total_sets;
+    double variance = 0;
+    for(int i = 0; i < total_sets; i++) {
+        variance += ((double) counts[i] - mean) * ((double) counts[i] - mean);
+    }
+    variance /= total_sets;
+
+    fprintf(out, "%s: %d of %d sets used, coefficient of variation %.4f\n", title, used, total_sets,
+            mean == 0 ? 0.0 : sqrt(variance) / mean);
+}
+
+//Function to print the TLB hit rates, the page walk traffic, and the set distribution with and without
+//translation
+void print_translation_report(FILE* out, struct translation* translation) {
+    fprintf(out, "TRANSLATION:\n");
+    fprintf(out, "Page size: %d bytes, page walk levels: %d, frame allocation: %s\n", translation->page_size,
+            translation->walk_levels, translation->alloc == PAGE_ALLOC_RANDOM ? "random" : "linear");
+    fprintf(out, "%-6s %-8s %-5s %-10s %-10s %s\n", "Level", "Entries", "Ways", "Hits", "Misses", "MissRate");
+    for(int i = 0; i < translation->total_levels; i++) {
+        struct tlb_level* level = &translation->levels[i];
+        long lookups = level->hits + level->misses;
+        fprintf(out, "L%-5d %-8d %-5d %-10ld %-10ld %.6f\n", i + 1, level->entries, level->ways, level->hits,
+                level->misses, lookups == 0 ? 0.0 : (double) level->misses / (double) lookups);
+    }
+
+    struct cache_stats walk = translation->walk_stats;
+    fprintf(out, "\nTranslations: %ld, page walks: %ld (%.6f per access)\n", translation->translations,
+            translation->walks,
+            translation->translations == 0 ? 0.0 : (double) translation->walks / (double) translation->translations);
+    fprintf(out, "Page table reads: %ld, cache misses: %ld, miss rate: %.6f\n", walk.total_reads, walk.total_misses,
+            walk.total_reads == 0 ? 0.0 : (double) walk.total_misses / (double) walk.total_reads);
+    fprintf(out, "Pages mapped: %ld of %ld frames, page table nodes: %ld\n", translation->next_frame,
+            translation->total_frames, translation->next_node);
+
+    fprintf(out, "\nAccesses in a different set than their virtual address: %ld (%.6f)\n", translation->moved,
+            translation->translations == 0 ? 0.0 : (double) translation->moved / (double) translation->translations);
+    print_set_spread(out, "Virtual indexing", translation->virtual_sets, translation->total_sets);
+    print_set_spread(out, "Physical indexing", translation->physical_sets, translation->total_sets);
+}
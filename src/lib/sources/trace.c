@@ -0,0 +1,445 @@
+#include "../headers/trace.h"
+#include "../headers/decompress.h"
+#include "../headers/gen.h"
+#include "../headers/tlb.h"
+//
+// Trace records, the trace line parser, and fully parsed in-memory traces
+//
+
+//Function to parse a single trace line into a record, returns non-zero and prints the reason if the
+//line is malformed. Reads and instruction fetches are "<op> <addr>" and writes "1 <addr> <value>", all of
+//them optionally followed by the size of the access in bytes and the PC. Every field is hex, the size too
+int parse_trace_line(char* line, long read, int line_num, struct trace_record* record) {
+    int read_write = -1;
+    //Longs so that we can verify that a 32-bit address was actually pulled from the file
+    unsigned long long addr = -1;
+    unsigned long long val = -1;
+    unsigned long long size = 0;
+    unsigned long long pc = 0;
+
+    //Verify that the line only contains hex characters, spaces, and new lines
+    for(int i = 0; i < read; i++) {
+        if(!isxdigit(line[i]) && line[i] != ' ' && line[i] != '\n') {
+            printf("Error: Malformed input file: Unrecognizable instruction on line %d position %d\n", line_num, i + 1);
+            return 1;
+        }
+    }
+
+    //Read instruction type
+    sscanf(line, "%x", &read_write);
+
+    if(read_write == CACHE_READ || read_write == CACHE_FETCH) {
+        //Line is a read or an instruction fetch, get the address and the optional fields
+        sscanf(line, "%*x %llx %llx %llx", &addr, &size, &pc);
+
+        //Verify address was retrieved
+        if(addr == -1) {
+            printf("Error: Malformed address: Could not read address on line %d\n", line_num);
+            return 1;
+        }
+    } else if(read_write == CACHE_WRITE) {
+        //Line is a write, get the address, new value, and the optional fields
+        sscanf(line, "%*x %llx %llx %llx %llx", &addr, &val, &size, &pc);
+
+        //Verify the address and value retrieved from the line
+        if(addr == -1 || val == -1) {
+            printf("Error: Malformed address or value: Could not read address or value on line %d, %llu %llu\n", line_num, addr, val);
+            return 1;
+        }
+    } else {
+        //Not a read, write, or instruction fetch
+        printf("Error: Unrecognized instruction: Invalid instruction on line %d\n", line_num);
+        return 1;
+    }
+    if(size > TRACE_MAX_SIZE) {
+        printf("Error: Malformed size: Access size on line %d is larger than %x bytes\n", line_num, TRACE_MAX_SIZE);
+        return 1;
+    }
+
+    record->op = (unsigned char) read_write;
+    record->addr = (INT_TYPE) addr;
+    record->val = (INT_TYPE) val;
+    record->size = (unsigned short) size;
+    record->pc = (INT_TYPE) pc;
+
+    return 0;
+}
+
+//Function to store a 64-bit value in little endian order
+static void put_le64(unsigned char* out, unsigned long long value) {
+    for(int i = 0; i < 8; i++) {
+        out[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+//Function to load a little endian 64-bit value
+static unsigned long long get_le64(unsigned char* in) {
+    unsigned long long value = 0;
+    for(int i = 7; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+//Function to read a trace file through a decompressor on a helper thread, the file is replaced by the
+//decompressed stream. Returns non-zero if it cannot be decompressed
+static int open_decompressed(struct trace_reader* reader, unsigned char* magic, size_t magic_size) {
+    reader->decompressor = malloc(sizeof(struct decompressor));
+    FILE* stream = NULL;
+    if(!reader->decompressor || start_decompressor(reader->decompressor, reader->file, magic, magic_size, &stream)) {
+        free(reader->decompressor);
+        reader->decompressor = NULL;
+        return 1;
+    }
+    reader->file = stream;
+    return 0;
+}
+
+//Function to open a trace file, binary traces are told apart from text traces by their header. Compressed
+//trace files are decompressed while they are read and then told apart the same way
+int open_trace_reader(struct trace_reader* reader, char* input_file) {
+    memset(reader, 0, sizeof(struct trace_reader));
+
+    reader->file = fopen(input_file, "rb");
+    if(!reader->file) {
+        printf("Error: Input file could not be read!\n");
+        return 3;
+    }
+
+    //Neither text nor binary traces start with the first byte of a gzip or zstd magic
+    int first = getc(reader->file);
+    if(first == 0x1f || first == 0x28) {
+        unsigned char magic[4] = {(unsigned char) first};
+        size_t magic_size = 1 + fread(magic + 1, 1, 3, reader->file);
+        if(compression_format(magic, magic_size) == COMPRESS_NONE) {
+            fseek(reader->file, 1, SEEK_SET);
+        } else if(open_decompressed(reader, magic, magic_size)) {
+            close_trace_reader(reader);
+            return 3;
+        } else {
+            first = getc(reader->file);
+        }
+    }
+
+    //A text trace never starts with the first magic character, so only peek at one byte in that case
+    if(first != TRACE_BINARY_MAGIC[0]) {
+        if(first != EOF) {
+            ungetc(first, reader->file);
+        }
+#ifdef _WIN32
+        //Reopen in text mode so that line endings are translated like they always were
+        if(!reader->decompressor) {
+            reader->file = freopen(input_file, "r", reader->file);
+        }
+        if(!reader->file) {
+            printf("Error: Input file could not be read!\n");
+            return 3;
+        }
+#endif
+        reader->format = TRACE_FORMAT_TEXT;
+        return 0;
+    }
+
+    unsigned char header[8];
+    header[0] = (unsigned char) first;
+    if(fread(header + 1, 1, 7, reader->file) != 7 || memcmp(header, TRACE_BINARY_MAGIC, 4) != 0) {
+        printf("Error: Malformed binary trace: Unrecognized header\n");
+        close_trace_reader(reader);
+        return 4;
+    }
+    unsigned int version = header[4] | header[5] << 8 | header[6] << 16 | (unsigned int) header[7] << 24;
+    if(version != TRACE_BINARY_VERSION) {
+        printf("Error: Malformed binary trace: Unsupported version %u\n", version);
+        close_trace_reader(reader);
+        return 4;
+    }
+    reader->format = TRACE_FORMAT_BINARY;
+
+    return 0;
+}
+
+//Function to read the records of a generator through the same interface as a trace file
+void open_generator_reader(struct trace_reader* reader, struct generator* gen) {
+    memset(reader, 0, sizeof(struct trace_reader));
+    reader->gen = gen;
+}
+
+//Function to end a trace at the end of its file, returns -1 if the file was compressed and turned out to be
+//corrupt or truncated, 0 otherwise
+static int end_trace(struct trace_reader* reader) {
+    if(!reader->decompressor) {
+        return 0;
+    }
+    int status = finish_decompressor(reader->decompressor);
+    free(reader->decompressor);
+    reader->decompressor = NULL;
+    return status ? -1 : 0;
+}
+
+//Function to read the next record, returns 1 for a record, 0 at the end of the trace, and -1 after
+//printing the reason if the trace is malformed
+int read_trace_record(struct trace_reader* reader, struct trace_record* record) {
+    reader->record_num++;
+    if(reader->gen) {
+        return gen_next(reader->gen, record);
+    }
+
+    if(reader->format == TRACE_FORMAT_TEXT) {
+        long read = getline(&reader->line, &reader->len, reader->file);
+        if(read == -1) {
+            return end_trace(reader);
+        }
+        return parse_trace_line(reader->line, read, (int) reader->record_num, record) ? -1 : 1;
+    }
+
+    int op = getc(reader->file);
+    if(op == EOF) {
+        return end_trace(reader);
+    }
+    bool extended = (op & TRACE_OP_EXTENDED) != 0;
+    op &= ~TRACE_OP_EXTENDED;
+    if(op != CACHE_READ && op != CACHE_WRITE && op != CACHE_FETCH) {
+        printf("Error: Unrecognized instruction: Invalid instruction in record %ld\n", reader->record_num);
+        return -1;
+    }
+
+    unsigned char fields[32];
+    size_t size = op == CACHE_WRITE ? 16 : 8;
+    size_t total = extended ? size + 16 : size;
+    if(fread(fields, 1, total, reader->file) != total) {
+        printf("Error: Malformed binary trace: Record %ld is truncated\n", reader->record_num);
+        return -1;
+    }
+    record->op = (unsigned char) op;
+    record->addr = (INT_TYPE) get_le64(fields);
+    record->val = op == CACHE_WRITE ? (INT_TYPE) get_le64(fields + 8) : (INT_TYPE) -1;
+    record->size = 0;
+    record->pc = 0;
+    if(extended) {
+        unsigned long long access_size = get_le64(fields + size);
+        if(access_size > TRACE_MAX_SIZE) {
+            printf("Error: Malformed size: Access size in record %ld is larger than %x bytes\n",
+                   reader->record_num, TRACE_MAX_SIZE);
+            return -1;
+        }
+        record->size = (unsigned short) access_size;
+        record->pc = (INT_TYPE) get_le64(fields + size + 8);
+    }
+
+    return 1;
+}
+
+//Function to close a trace reader, a generator is left to its owner
+void close_trace_reader(struct trace_reader* reader) {
+    if(reader->file) {
+        fclose(reader->file);
+    }
+    //The decompressed stream is closed first, so that a helper thread still writing to it stops
+    end_trace(reader);
+    free(reader->line);
+    reader->file = NULL;
+    reader->line = NULL;
+}
+
+//Function to write the header of a trace file, text traces have none
+int write_trace_header(FILE* out, int format) {
+    if(format == TRACE_FORMAT_TEXT) {
+        return 0;
+    }
+
+    unsigned char header[8];
+    memcpy(header, TRACE_BINARY_MAGIC, 4);
+    for(int i = 0; i < 4; i++) {
+        header[4 + i] = (unsigned char) (TRACE_BINARY_VERSION >> (8 * i));
+    }
+    return fwrite(header, 1, 8, out) != 8;
+}
+
+//Function to write a single record to a trace file, the size and PC are only written when one is set
+int write_trace_record(FILE* out, int format, struct trace_record record) {
+    bool extended = record.size != 0 || record.pc != 0;
+    if(format == TRACE_FORMAT_TEXT) {
+        int status;
+        if(record.op == CACHE_WRITE) {
+            status = fprintf(out, "%x %llx %llx", record.op, (unsigned long long) record.addr,
+                             (unsigned long long) record.val) < 0;
+        } else {
+            status = fprintf(out, "%x %llx", record.op, (unsigned long long) record.addr) < 0;
+        }
+        if(extended && !status) {
+            status = fprintf(out, " %x %llx", record.size, (unsigned long long) record.pc) < 0;
+        }
+        return status || fputc('\n', out) == EOF;
+    }
+
+    unsigned char buffer[33];
+    size_t size = record.op == CACHE_WRITE ? 17 : 9;
+    buffer[0] = extended ? record.op | TRACE_OP_EXTENDED : record.op;
+    put_le64(buffer + 1, record.addr);
+    if(record.op == CACHE_WRITE) {
+        put_le64(buffer + 9, record.val);
+    }
+    if(extended) {
+        put_le64(buffer + size, record.size);
+        put_le64(buffer + size + 8, record.pc);
+        size += 16;
+    }
+    return fwrite(buffer, 1, size, out) != size;
+}
+
+//Function to read a whole trace file into memory, returns the same codes as process_trace
+int load_trace(char* input_file, struct trace* trace) {
+    memset(trace, 0, sizeof(struct trace));
+
+    struct trace_reader reader;
+    int status = open_trace_reader(&reader, input_file);
+    if(status != 0) {
+        return status;
+    }
+
+    struct trace_record record;
+    int result;
+    while((result = read_trace_record(&reader, &record)) > 0) {
+        //Grow the record array geometrically
+        if(trace->length == trace->capacity) {
+            long capacity = trace->capacity == 0 ? 4096 : trace->capacity * 2;
+            struct trace_record* records = realloc(trace->records, capacity * sizeof(struct trace_record));
+            if(!records) {
+                printf("Error: Could not allocate memory for the trace\n");
+                status = 4;
+                break;
+            }
+            trace->records = records;
+            trace->capacity = capacity;
+        }
+        trace->records[trace->length++] = record;
+    }
+    if(result < 0) {
+        status = 4;
+    }
+
+    close_trace_reader(&reader);
+
+    if(status != 0) {
+        free_trace(trace);
+    }
+    return status;
+}
+
+//Function to free the memory allocated to a trace
+void free_trace(struct trace* trace) {
+    free(trace->records);
+    memset(trace, 0, sizeof(struct trace));
+}
+
+//Function to run a single cache access, translating its address first if the cache has a translation stage.
+//A write of more than one word writes the value to all of them. Returns 5 if the address cannot be translated
+static int simulate_access(struct cache* cache_mem, struct cache_stats* stats, struct main_mem_block* main_mem,
+                           struct trace_record record, INT_TYPE words) {
+    if(cache_mem->translation && translate_address(cache_mem, main_mem, record.addr, &record.addr)) {
+        return 5;
+    }
+
+    if(record.op == CACHE_READ) {
+        return read_from_cache(cache_mem, stats, main_mem, record.addr);
+    } else if(record.op == CACHE_FETCH) {
+        return fetch_from_cache(cache_mem, stats, main_mem, record.addr);
+    }
+    int status = write_to_cache(cache_mem, stats, main_mem, record.addr, record.val);
+    for(INT_TYPE i = 1; i < words; i++) {
+        write_back(cache_mem, cache_info_from_address(*cache_mem, record.addr + i), record.val);
+    }
+    return status;
+}
+
+//Function to run a single record through the cache, instruction fetches go to the instruction cache of a
+//split cache. An access of more than one word is split at the sector boundaries, which are the line
+//boundaries unless the cache is sectored, into one cache access per piece. Returns 5 if an address cannot
+//be translated
+int simulate_record(struct cache* cache_mem, struct cache_stats* stats, struct main_mem_block* main_mem,
+                    struct trace_record record) {
+    if(record.op == CACHE_FETCH && cache_mem->icache) {
+        stats = &cache_mem->icache->stats;
+        cache_mem = &cache_mem->icache->cache_mem;
+    }
+    if(record.size <= WORD_SIZE) {
+        return simulate_access(cache_mem, stats, main_mem, record, 1);
+    }
+
+    INT_TYPE end = record.addr + (record.size + WORD_SIZE - 1) / WORD_SIZE;
+    INT_TYPE sector = (INT_TYPE) cache_mem->words_per_sector;
+    while(record.addr < end) {
+        INT_TYPE piece_end = (record.addr / sector + 1) * sector;
+        piece_end = piece_end < end ? piece_end : end;
+        int status = simulate_access(cache_mem, stats, main_mem, record, piece_end - record.addr);
+        if(status != 0) {
+            return status;
+        }
+        record.addr = piece_end;
+    }
+    return 0;
+}
+
+//Function to get the length of the run of records at the start of an array that are single word reads and
+//writes hitting the line of the last access, stopping at an access to a sector the line does not hold
+static long line_run_length(struct cache* cache_mem, struct trace_record* records, long count) {
+    struct cache_mem_block* line = &cache_mem->lines[cache_mem->last_line];
+    long run = 0;
+    for(; run < count; run++) {
+        struct trace_record record = records[run];
+        if(record.op == CACHE_FETCH || record.size > WORD_SIZE
+                || record.addr / cache_mem->words_per_line != cache_mem->last_block) {
+            break;
+        }
+        int sector = (int) (record.addr % cache_mem->words_per_line / cache_mem->words_per_sector);
+        if(cache_mem->sectors_per_line > 1 && line->loaded && !(line->valid_sectors >> sector & 1)) {
+            break;
+        }
+    }
+    return run;
+}
+
+//Function to run a decoded trace through the cache. Every run of reads and writes to the line of the access
+//before them is a run of hits on that line, so the run is applied as one update of the statistics and the
+//program counter, leaving the same statistics, line contents, and LRU state as one access per record. Runs
+//are not collapsed when a translation stage, instrumentation, or MSHRs have to see every access. Returns the status
+//of the first record that fails, as simulate_record does
+int simulate_trace_records(struct cache* cache_mem, struct cache_stats* stats, struct main_mem_block* main_mem,
+                           struct trace_record* records, long count) {
+    bool collapse = !cache_mem->translation && !cache_mem->instr && !cache_mem->hot && !cache_mem->mshrs;
+    long i = 0;
+    while(i < count) {
+        int status = simulate_record(cache_mem, stats, main_mem, records[i]);
+        if(status != 0) {
+            return status;
+        }
+        i++;
+        if(!collapse || !cache_mem->last_valid) {
+            continue;
+        }
+
+        long run = line_run_length(cache_mem, records + i, count - i);
+        if(run == 0) {
+            continue;
+        }
+        //Writes store their values in trace order, so the last write of a word wins
+        INT_TYPE cm_line = cache_mem->last_line;
+        long writes = 0;
+        for(long j = i; j < i + run; j++) {
+            if(records[j].op == CACHE_WRITE) {
+                INT_TYPE word = records[j].addr % cache_mem->words_per_line;
+                cache_mem->lines[cm_line].words[word] = records[j].val;
+                cache_mem->lines[cm_line].dirty = 1;
+                cache_mem->lines[cm_line].dirty_sectors |= 1ULL << (word / cache_mem->words_per_sector);
+                writes++;
+            }
+        }
+        cache_mem->pc += (int) run;
+        cache_mem->lines[cm_line].last_pc = cache_mem->pc;
+        stats->total_actions += run;
+        stats->total_writes += writes;
+        stats->total_reads += run - writes;
+        i += run;
+    }
+    return 0;
+}
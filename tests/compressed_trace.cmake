@@ -0,0 +1,21 @@
+#Runs a trace and its compressed copy through cache_sim, failing unless both give the same statistics.
+#Prints a skip notice instead when cache_sim was built without the library for the format
+foreach(input "${TRACE}" "${TRACE}.${FORMAT}")
+    get_filename_component(name "${input}" NAME)
+    execute_process(COMMAND "${CACHE_SIM}" -c 8 -b 16 -a 4 -i "${input}" --no-dump -o "${OUT}/${name}.txt"
+                    RESULT_VARIABLE status OUTPUT_VARIABLE printed)
+    if(printed MATCHES "rebuild with")
+        message("Skipped, cache_sim was built without reading ${FORMAT}")
+        return()
+    endif()
+    if(NOT status EQUAL 0 OR printed MATCHES "Error")
+        message(FATAL_ERROR "cache_sim failed on ${name}:\n${printed}")
+    endif()
+endforeach()
+
+get_filename_component(name "${TRACE}" NAME)
+file(READ "${OUT}/${name}.txt" plain)
+file(READ "${OUT}/${name}.${FORMAT}.txt" compressed)
+if(NOT plain STREQUAL compressed)
+    message(FATAL_ERROR "${name}.${FORMAT} gives other statistics than ${name}")
+endif()